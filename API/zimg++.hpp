@@ -13,13 +13,52 @@ struct ZimgError {
 	}
 };
 
+class ZimgArena {
+	zimg_arena *m_arena;
+public:
+	ZimgArena(void *buffer, size_t size)
+	{
+		if (!(m_arena = zimg_arena_create(buffer, size)))
+			throw ZimgError{};
+	}
+
+	ZimgArena(const ZimgArena &) = delete;
+
+	ZimgArena &operator=(const ZimgArena &) = delete;
+
+	~ZimgArena()
+	{
+		zimg_arena_delete(m_arena);
+	}
+
+	void *alloc(size_t size)
+	{
+		void *ptr;
+
+		if (!(ptr = zimg_arena_alloc(m_arena, size)))
+			throw ZimgError{};
+
+		return ptr;
+	}
+
+	size_t used()
+	{
+		return zimg_arena_used(m_arena);
+	}
+
+	void reset()
+	{
+		zimg_arena_reset(m_arena);
+	}
+};
+
 class ZimgColorspaceContext {
 	zimg_colorspace_context *m_ctx;
 public:
 	ZimgColorspaceContext(int matrix_in, int transfer_in, int primaries_in,
-	                      int matrix_out, int transfer_out, int primaries_out)
+	                      int matrix_out, int transfer_out, int primaries_out, const zimg_create_options *options = nullptr)
 	{
-		if (!(m_ctx = zimg_colorspace_create(matrix_in, transfer_in, primaries_in, matrix_out, transfer_out, primaries_out)))
+		if (!(m_ctx = zimg_colorspace_create2(matrix_in, transfer_in, primaries_in, matrix_out, transfer_out, primaries_out, options)))
 			throw ZimgError{};
 	}
 
@@ -47,14 +86,20 @@ public:
 		if (zimg_colorspace_process_tile(m_ctx, src, dst, tmp, pixel_type))
 			throw ZimgError{};
 	}
+
+	void process_tiles(const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp, int width, int height)
+	{
+		if (zimg_colorspace_process_tiles(m_ctx, src, dst, tmp, width, height))
+			throw ZimgError{};
+	}
 };
 
 class ZimgDepthContext {
 	zimg_depth_context *m_ctx;
 public:
-	ZimgDepthContext(int dither_type)
+	ZimgDepthContext(int dither_type, const zimg_create_options *options = nullptr)
 	{
-		if (!(m_ctx = zimg_depth_create(dither_type)))
+		if (!(m_ctx = zimg_depth_create2(dither_type, options)))
 			throw ZimgError{};
 	}
 
@@ -82,15 +127,21 @@ public:
 		if (zimg_depth_process(m_ctx, src, dst, tmp))
 			throw ZimgError{};
 	}
+
+	void process_tiles(const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp, int width, int height, unsigned seed = 0)
+	{
+		if (zimg_depth_process_tiles(m_ctx, src, dst, tmp, width, height, seed))
+			throw ZimgError{};
+	}
 };
 
 class ZimgResizeContext {
 	zimg_resize_context *m_ctx;
 public:
 	ZimgResizeContext(int filter_type, int horizontal, int src_dim, int dst_dim,
-	                  double shift, double width, double filter_param_a, double filter_param_b)
+	                  double shift, double width, double filter_param_a, double filter_param_b, const zimg_create_options *options = nullptr)
 	{
-		if (!(m_ctx = zimg_resize_create(filter_type, horizontal, src_dim, dst_dim, shift, width, filter_param_a, filter_param_b)))
+		if (!(m_ctx = zimg_resize_create2(filter_type, horizontal, src_dim, dst_dim, shift, width, filter_param_a, filter_param_b, options)))
 			throw ZimgError{};
 	}
 
@@ -119,6 +170,89 @@ public:
 		if (zimg_resize_process_tile(m_ctx, src, dst))
 			throw ZimgError{};
 	}
+
+	void process_tiles(const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int width, int height)
+	{
+		if (zimg_resize_process_tiles(m_ctx, src, dst, width, height))
+			throw ZimgError{};
+	}
+};
+
+class ZimgUnresizeContext {
+	zimg_unresize_context *m_ctx;
+public:
+	ZimgUnresizeContext(int filter_type, int horizontal, int src_dim, int dst_dim,
+	                    double shift, double filter_param_a, double filter_param_b, const zimg_create_options *options = nullptr)
+	{
+		if (!(m_ctx = zimg_unresize_create2(filter_type, horizontal, src_dim, dst_dim, shift, filter_param_a, filter_param_b, options)))
+			throw ZimgError{};
+	}
+
+	ZimgUnresizeContext(const ZimgUnresizeContext &) = delete;
+
+	ZimgUnresizeContext &operator=(const ZimgUnresizeContext &) = delete;
+
+	~ZimgUnresizeContext()
+	{
+		zimg_unresize_delete(m_ctx);
+	}
+
+	size_t tmp_size(int pixel_type)
+	{
+		return zimg_unresize_tmp_size(m_ctx, pixel_type);
+	}
+
+	void dependent_rows(int dst_top, int dst_bottom, int *src_top, int *src_bottom)
+	{
+		zimg_unresize_dependent_rows(m_ctx, dst_top, dst_bottom, src_top, src_bottom);
+	}
+
+	void process(const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp)
+	{
+		if (zimg_unresize_process(m_ctx, src, dst, tmp))
+			throw ZimgError{};
+	}
+
+	void process_strip(const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int dst_top, int dst_bottom, void *tmp)
+	{
+		if (zimg_unresize_process_strip(m_ctx, src, dst, dst_top, dst_bottom, tmp))
+			throw ZimgError{};
+	}
+
+	void process_strip_back(const zimg_image_tile_t *dst, int dst_top, int dst_bottom)
+	{
+		if (zimg_unresize_process_strip_back(m_ctx, dst, dst_top, dst_bottom))
+			throw ZimgError{};
+	}
+
+	void set_partitions(int count)
+	{
+		if (zimg_unresize_set_partitions(m_ctx, count))
+			throw ZimgError{};
+	}
+
+	void partition_rows(int k, int *dst_top, int *dst_bottom)
+	{
+		zimg_unresize_partition_rows(m_ctx, k, dst_top, dst_bottom);
+	}
+
+	void process_partition(const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int k)
+	{
+		if (zimg_unresize_process_partition(m_ctx, src, dst, k))
+			throw ZimgError{};
+	}
+
+	void process_partition_reduce(const zimg_image_tile_t *dst)
+	{
+		if (zimg_unresize_process_partition_reduce(m_ctx, dst))
+			throw ZimgError{};
+	}
+
+	void process_partition_fixup(const zimg_image_tile_t *dst, int k)
+	{
+		if (zimg_unresize_process_partition_fixup(m_ctx, dst, k))
+			throw ZimgError{};
+	}
 };
 
 #endif // ZIMGPLUSPLUS_H_
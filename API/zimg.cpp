@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cinttypes>
@@ -6,6 +7,7 @@
 #include <cstring>
 #include <memory>
 #include <utility>
+#include "Common/align.h"
 #include "Common/cpuinfo.h"
 #include "Common/except.h"
 #include "Common/osdep.h"
@@ -13,9 +15,13 @@
 #include "Common/tile.h"
 #include "Colorspace/colorspace.h"
 #include "Colorspace/colorspace_param.h"
+#include "Colorspace/operation.h"
+#include "Colorspace/packed.h"
 #include "Depth/depth.h"
 #include "Resize/filter.h"
 #include "Resize/resize.h"
+#include "Unresize/bilinear.h"
+#include "Unresize/unresize.h"
 #include "zimg.h"
 
 using namespace zimg;
@@ -50,6 +56,15 @@ CPUClass get_cpu_class(int cpu)
 	}
 }
 
+CPUClass get_cpu_option(const zimg_create_options *options)
+{
+	// The cpu field was added in API version 3.
+	if (!options || options->version < 3 || options->cpu == ZIMG_CPU_GLOBAL)
+		return g_cpu_type;
+	else
+		return get_cpu_class(options->cpu);
+}
+
 PixelType get_pixel_type(int pixel_type)
 {
 	switch (pixel_type) {
@@ -128,6 +143,22 @@ colorspace::ColorPrimaries get_color_primaries(int primaries)
 	}
 }
 
+colorspace::PackedFormat get_packed_format(int format)
+{
+	switch (format) {
+	case ZIMG_PACKED_RGB24:
+		return colorspace::PackedFormat::RGB24;
+	case ZIMG_PACKED_RGBA:
+		return colorspace::PackedFormat::RGBA;
+	case ZIMG_PACKED_UYVY:
+		return colorspace::PackedFormat::UYVY;
+	case ZIMG_PACKED_NV12:
+		return colorspace::PackedFormat::NV12;
+	default:
+		throw ZimgIllegalArgument{ "unknown packed format" };
+	}
+}
+
 depth::DitherType get_dither_type(int dither)
 {
 	switch (dither) {
@@ -139,6 +170,14 @@ depth::DitherType get_dither_type(int dither)
 		return depth::DitherType::DITHER_RANDOM;
 	case ZIMG_DITHER_ERROR_DIFFUSION:
 		return depth::DitherType::DITHER_ERROR_DIFFUSION;
+	case ZIMG_DITHER_BLUE_NOISE:
+		return depth::DitherType::DITHER_BLUE_NOISE;
+	case ZIMG_DITHER_SIERRA_LITE:
+		return depth::DitherType::DITHER_SIERRA_LITE;
+	case ZIMG_DITHER_ERROR_DIFFUSION_ROW:
+		return depth::DitherType::DITHER_ERROR_DIFFUSION_ROW;
+	case ZIMG_DITHER_ERROR_DIFFUSION_SERPENTINE:
+		return depth::DitherType::DITHER_ERROR_DIFFUSION_SERPENTINE;
 	default:
 		throw ZimgIllegalArgument{ "unknown dither type" };
 	}
@@ -184,7 +223,7 @@ void handle_exception(const ZimgException &e)
 		std::strncpy(g_last_error_msg, e.what(), sizeof(g_last_error_msg));
 		g_last_error_msg[sizeof(g_last_error_msg) - 1] = '\0';
 
-		throw e;
+		throw;
 	} catch (const ZimgUnknownError &) {
 		g_last_error = ZIMG_ERROR_UNKNOWN;
 	} catch (const ZimgLogicError &) {
@@ -206,6 +245,288 @@ void handle_bad_alloc()
 	g_last_error = ZIMG_ERROR_OUT_OF_MEMORY;
 }
 
+/**
+ * Get the part of the source tile required to produce the given output rectangle.
+ * The rectangle of source pixels it covers is stored in the last four arguments.
+ */
+ImageTile<const void> get_resize_src_tile(const resize::Resize &resize, const zimg_image_tile_t *src, PlaneDescriptor *src_desc,
+                                          int dst_top, int dst_left, int dst_bottom, int dst_right,
+                                          int *src_top, int *src_left, int *src_bottom, int *src_right)
+{
+	ImageTile<const void> src_tile;
+
+	get_image_tile(src, &src_tile, src_desc);
+
+	resize.dependent_rect(dst_top, dst_left, dst_bottom, dst_right, src_top, src_left, src_bottom, src_right);
+	assert(src->plane_offset_i <= *src_top && src->plane_offset_j <= *src_left);
+
+	return src_tile.sub_tile(*src_top - src->plane_offset_i, *src_left - src->plane_offset_j);
+}
+
+void resize_process_tile(const resize::Resize &resize, const zimg_image_tile_t *src, const zimg_image_tile_t *dst)
+{
+	assert(src && src->buffer);
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(src->plane_offset_i >= 0 && src->plane_offset_j >= 0);
+	assert(dst->plane_offset_i >= 0 && dst->plane_offset_j >= 0);
+
+	PlaneDescriptor src_desc;
+	PlaneDescriptor dst_desc;
+
+	ImageTile<const void> src_tile;
+	ImageTile<void> dst_tile;
+
+	int src_top, src_left, src_bottom, src_right;
+
+	src_tile = get_resize_src_tile(resize, src, &src_desc, dst->plane_offset_i, dst->plane_offset_j,
+	                               dst->plane_offset_i + TILE_HEIGHT, dst->plane_offset_j + TILE_WIDTH,
+	                               &src_top, &src_left, &src_bottom, &src_right);
+	get_image_tile(dst, &dst_tile, &dst_desc);
+
+	resize.process(src_tile, dst_tile, dst->plane_offset_i, dst->plane_offset_j);
+}
+
+/**
+ * Check if an output tile lies within the plane and its input rectangle can be read in place,
+ * including the padding read past the end of each scanline.
+ */
+bool resize_tile_in_place(const resize::Resize &resize, int src_width, int src_height, int dst_width, int dst_height, int i, int j)
+{
+	int top, left, bottom, right;
+
+	if (i + TILE_HEIGHT > dst_height || j + TILE_WIDTH > dst_width)
+		return false;
+
+	resize.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &top, &left, &bottom, &right);
+	return bottom <= src_height && right + TILE_WIDTH <= src_width;
+}
+
+/**
+ * Get the stride in bytes of the copy of an input rectangle, including padding for reads past the end of each scanline.
+ */
+int resize_staged_stride(int left, int right, int pxsize)
+{
+	return ceil_n((right - left + TILE_WIDTH) * pxsize, ALIGNMENT);
+}
+
+size_t resize_batch_tmp_size(const resize::Resize &resize, int src_width, int src_height, int dst_width, int dst_height, PixelType type)
+{
+	int pxsize = pixel_size(type);
+	size_t size = 0;
+
+	for (int i = 0; i < dst_height; i += TILE_HEIGHT) {
+		for (int j = 0; j < dst_width; j += TILE_WIDTH) {
+			int top, left, bottom, right;
+
+			resize.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &top, &left, &bottom, &right);
+
+			if (bottom > src_height || right + TILE_WIDTH > src_width)
+				size = std::max(size, (size_t)resize_staged_stride(left, right, pxsize) * (bottom - top));
+		}
+	}
+
+	return size + (size_t)TILE_WIDTH * TILE_HEIGHT * pxsize;
+}
+
+/**
+ * Process an output tile at the edge of a plane. Input past the edge is staged in tmp with zero padding,
+ * and output past the edge is staged in tmp and copied back.
+ */
+void resize_process_edge_tile(const resize::Resize &resize, const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, void *tmp)
+{
+	int src_width = src.descriptor()->width;
+	int src_height = src.descriptor()->height;
+	int dst_width = dst.descriptor()->width;
+	int dst_height = dst.descriptor()->height;
+	int pxsize = src.bytes_per_pixel();
+
+	int top, left, bottom, right;
+	char *tmp_ptr = static_cast<char *>(tmp);
+
+	resize.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &top, &left, &bottom, &right);
+
+	ImageTile<const void> src_tile = src.sub_tile(top, left);
+
+	if (bottom > src_height || right + TILE_WIDTH > src_width) {
+		int stride = resize_staged_stride(left, right, pxsize);
+		ImageTile<void> staged{ tmp_ptr, src.descriptor(), stride };
+
+		// Pixels past the edge of the plane are read with zero weight, so they must not be left uninitialized.
+		std::fill_n(tmp_ptr, (size_t)stride * (bottom - top), 0);
+		copy_image_tile_partial(src_tile, staged, std::min(right, src_width) - left, std::min(bottom, src_height) - top);
+
+		src_tile = staged;
+		tmp_ptr += (size_t)stride * (bottom - top);
+	}
+
+	if (i + TILE_HEIGHT > dst_height || j + TILE_WIDTH > dst_width) {
+		ImageTile<void> staged{ tmp_ptr, dst.descriptor(), TILE_WIDTH * pxsize };
+
+		resize.process(src_tile, staged, i, j);
+		copy_image_tile_partial(ImageTile<const void>{ staged }, dst.sub_tile(i, j), std::min(dst_width - j, TILE_WIDTH), std::min(dst_height - i, TILE_HEIGHT));
+	} else {
+		resize.process(src_tile, dst.sub_tile(i, j), i, j);
+	}
+}
+
+/**
+ * Process an entire plane. The largest rectangle of tiles that can be processed in place is processed
+ * in a single call, and the remaining tiles one at a time.
+ */
+void resize_process_plane(const resize::Resize &resize, const ImageTile<const void> &src, const ImageTile<void> &dst, void *tmp)
+{
+	int src_width = src.descriptor()->width;
+	int src_height = src.descriptor()->height;
+	int dst_width = dst.descriptor()->width;
+	int dst_height = dst.descriptor()->height;
+
+	int interior_width = 0;
+	int interior_height = 0;
+
+	// The input rows of an output tile depend only on its row, and the input columns only on its column.
+	while (resize_tile_in_place(resize, src_width, src_height, dst_width, dst_height, interior_height, 0))
+		interior_height += TILE_HEIGHT;
+	while (interior_height && resize_tile_in_place(resize, src_width, src_height, dst_width, dst_height, 0, interior_width))
+		interior_width += TILE_WIDTH;
+
+	if (interior_width && interior_height) {
+		int top, left, bottom, right;
+
+		resize.dependent_rect(0, 0, interior_height, interior_width, &top, &left, &bottom, &right);
+		resize.process_plane(src.sub_tile(top, left), dst, 0, 0, interior_height, interior_width);
+	}
+
+	for (int i = 0; i < dst_height; i += TILE_HEIGHT) {
+		for (int j = 0; j < dst_width; j += TILE_WIDTH) {
+			if (i < interior_height && j < interior_width)
+				continue;
+
+			resize_process_edge_tile(resize, src, dst, i, j, tmp);
+		}
+	}
+}
+
+/**
+ * Two-pass resampling of a chroma plane producing one output tile at a time.
+ * The horizontal pass is kept in a buffer covering the rows needed by the vertical pass.
+ */
+class ChromaResize {
+	resize::Resize m_resize_h;
+	resize::Resize m_resize_v;
+	bool m_skip_h;
+	bool m_skip_v;
+	int m_tmp_rows;
+public:
+	ChromaResize() = default;
+
+	ChromaResize(const resize::Filter &f, int src_width, int src_height, int dst_width, int dst_height, double shift_w, double shift_h, CPUClass cpu) :
+		m_skip_h{ src_width == dst_width && shift_w == 0.0 },
+		m_skip_v{ src_height == dst_height && shift_h == 0.0 },
+		m_tmp_rows{}
+	{
+		if (!m_skip_h)
+			m_resize_h = resize::Resize{ f, true, src_width, dst_width, shift_w, (double)src_width, cpu };
+		if (!m_skip_v)
+			m_resize_v = resize::Resize{ f, false, src_height, dst_height, shift_h, (double)src_height, cpu };
+
+		if (!m_skip_h && !m_skip_v) {
+			for (int i = 0; i < dst_height; i += TILE_HEIGHT) {
+				int top, left, bottom, right;
+
+				m_resize_v.dependent_rect(i, 0, i + TILE_HEIGHT, TILE_WIDTH, &top, &left, &bottom, &right);
+				m_tmp_rows = std::max(m_tmp_rows, std::max(bottom - top, TILE_HEIGHT));
+			}
+		}
+	}
+
+	bool pixel_supported(PixelType type) const
+	{
+		return (m_skip_h || m_resize_h.pixel_supported(type)) && (m_skip_v || m_resize_v.pixel_supported(type));
+	}
+
+	size_t tmp_size(int bytes_per_pixel) const
+	{
+		return (size_t)m_tmp_rows * TILE_WIDTH * bytes_per_pixel;
+	}
+
+	void dependent_rect(int dst_top, int dst_left, int dst_bottom, int dst_right, int *src_top, int *src_left, int *src_bottom, int *src_right) const
+	{
+		int top = dst_top;
+		int left = dst_left;
+		int bottom = dst_bottom;
+		int right = dst_right;
+
+		if (!m_skip_v)
+			m_resize_v.dependent_rect(dst_top, dst_left, dst_bottom, dst_right, &top, &left, &bottom, &right);
+		if (!m_skip_h) {
+			// The horizontal pass is run on whole tiles.
+			if (!m_skip_v)
+				bottom = std::max(bottom, top + TILE_HEIGHT);
+
+			m_resize_h.dependent_rect(top, dst_left, bottom, dst_right, &top, &left, &bottom, &right);
+		}
+
+		*src_top = top;
+		*src_left = left;
+		*src_bottom = bottom;
+		*src_right = right;
+	}
+
+	void process(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, void *tmp) const
+	{
+		if (m_skip_h && m_skip_v) {
+			copy_image_tile(src, dst);
+		} else if (m_skip_v) {
+			m_resize_h.process(src, dst, i, j);
+		} else if (m_skip_h) {
+			m_resize_v.process(src, dst, i, j);
+		} else {
+			PlaneDescriptor tmp_desc{ src.descriptor()->format };
+			ImageTile<void> tmp_tile{ tmp, &tmp_desc, TILE_WIDTH * tmp_desc.bytes_per_pixel };
+			int top, left, bottom, right;
+
+			m_resize_v.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &top, &left, &bottom, &right);
+
+			// The last tile overlaps the previous one instead of extending past the required rows.
+			for (int r = 0; r < bottom - top; r += TILE_HEIGHT) {
+				int row = std::max(std::min(r, bottom - top - TILE_HEIGHT), 0);
+				m_resize_h.process(src.sub_tile(row, 0), tmp_tile.sub_tile(row, 0), top + row, j);
+			}
+			m_resize_v.process(tmp_tile, dst, i, j);
+		}
+	}
+};
+
+/**
+ * Horizontal distance in units of luma samples from the center of a group of subsampled pixels to its chroma sample.
+ */
+double chroma_distance_h(int chroma_loc, int subsample)
+{
+	double factor = 1 << subsample;
+
+	switch (chroma_loc) {
+	case ZIMG_CHROMA_LOC_MPEG1:
+		return 0.0;
+	case ZIMG_CHROMA_LOC_MPEG2:
+		return -(factor - 1.0) / 2.0;
+	default:
+		throw ZimgIllegalArgument{ "unknown chroma location" };
+	}
+}
+
+/**
+ * Get the full resolution rectangle required to produce a subsampled chroma tile and the luma pixels it covers.
+ */
+void downsample_region(const ChromaResize &resize, int subsample_w, int subsample_h, int i, int j, int *top, int *left, int *bottom, int *right)
+{
+	resize.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, top, left, bottom, right);
+
+	*top = std::min(*top, i << subsample_h);
+	*left = std::min(*left, j << subsample_w);
+	*bottom = std::max(*bottom, (i + TILE_HEIGHT) << subsample_h);
+	*right = std::max(*right, (j + TILE_WIDTH) << subsample_w);
+}
+
 } // namespace
 
 
@@ -234,13 +555,102 @@ void zimg_set_cpu(int cpu)
 	}
 }
 
+void zimg_create_options_default(zimg_create_options *options, unsigned version)
+{
+	assert(options);
+
+	options->version = version;
+
+	if (version >= 3)
+		options->cpu = ZIMG_CPU_GLOBAL;
+}
+
+
+void zimg_set_allocator(zimg_alloc_func alloc, zimg_free_func free, void *user)
+{
+	AllocatorHooks &hooks = allocator_hooks();
+
+	// Cached buffers must be returned to the functions that allocated them.
+	unresize::clear_bilinear_context_cache();
+	assert(allocator_outstanding() == 0);
+
+	if (alloc && free)
+		hooks = { alloc, free, user };
+	else
+		hooks = { default_aligned_alloc, default_aligned_free, nullptr };
+}
+
+
+struct zimg_arena {
+	char *buffer;
+	size_t size;
+	std::atomic<size_t> offset;
+
+	zimg_arena(char *buffer, size_t size) : buffer{ buffer }, size{ size }, offset{ 0 }
+	{}
+};
+
+zimg_arena *zimg_arena_create(void *buffer, size_t size)
+{
+	zimg_arena *ret = nullptr;
+
+	assert(buffer || !size);
+
+	try {
+		// Skip to the first aligned address.
+		char *ptr = static_cast<char *>(buffer);
+		size_t skip = (ALIGNMENT - reinterpret_cast<uintptr_t>(ptr) % ALIGNMENT) % ALIGNMENT;
+
+		ret = new zimg_arena{ ptr + skip, size > skip ? size - skip : 0 };
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+void *zimg_arena_alloc(zimg_arena *arena, size_t size)
+{
+	assert(arena);
+
+	size_t aligned_size = ceil_n(size, ALIGNMENT);
+	size_t offset = arena->offset.load();
+
+	do {
+		if (arena->size - offset < aligned_size) {
+			handle_bad_alloc();
+			return nullptr;
+		}
+	} while (!arena->offset.compare_exchange_weak(offset, offset + aligned_size));
+
+	return arena->buffer + offset;
+}
+
+size_t zimg_arena_used(zimg_arena *arena)
+{
+	assert(arena);
+	return arena->offset.load();
+}
+
+void zimg_arena_reset(zimg_arena *arena)
+{
+	assert(arena);
+	arena->offset = 0;
+}
+
+void zimg_arena_delete(zimg_arena *arena)
+{
+	delete arena;
+}
+
 
 struct zimg_colorspace_context {
 	colorspace::ColorspaceConversion p;
 };
 
-zimg_colorspace_context *zimg_colorspace_create(int matrix_in, int transfer_in, int primaries_in,
-                                                int matrix_out, int transfer_out, int primaries_out)
+zimg_colorspace_context *zimg_colorspace_create2(int matrix_in, int transfer_in, int primaries_in,
+                                                 int matrix_out, int transfer_out, int primaries_out,
+                                                 const zimg_create_options *options)
 {
 	zimg_colorspace_context *ret = nullptr;
 
@@ -256,7 +666,7 @@ zimg_colorspace_context *zimg_colorspace_create(int matrix_in, int transfer_in,
 		csp_out.transfer  = get_transfer_characteristics(transfer_out);
 		csp_out.primaries = get_color_primaries(primaries_out);
 
-		ret = new zimg_colorspace_context{ colorspace::ColorspaceConversion{ csp_in, csp_out, g_cpu_type } };
+		ret = new zimg_colorspace_context{ colorspace::ColorspaceConversion{ csp_in, csp_out, get_cpu_option(options) } };
 	} catch (const ZimgException &e) {
 		handle_exception(e);
 	} catch (const std::bad_alloc &) {
@@ -266,6 +676,12 @@ zimg_colorspace_context *zimg_colorspace_create(int matrix_in, int transfer_in,
 	return ret;
 }
 
+zimg_colorspace_context *zimg_colorspace_create(int matrix_in, int transfer_in, int primaries_in,
+                                                int matrix_out, int transfer_out, int primaries_out)
+{
+	return zimg_colorspace_create2(matrix_in, transfer_in, primaries_in, matrix_out, transfer_out, primaries_out, nullptr);
+}
+
 size_t zimg_colorspace_tmp_size(zimg_colorspace_context *ctx)
 {
 	assert(ctx);
@@ -320,22 +736,80 @@ int zimg_colorspace_process_tile(zimg_colorspace_context *ctx, const zimg_image_
 	return ret;
 }
 
+int zimg_colorspace_process_tiles(zimg_colorspace_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp,
+                                  int width, int height)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src[0].buffer && src[1].buffer && src[2].buffer);
+	assert(dst && dst[0].buffer && dst[1].buffer && dst[2].buffer);
+	assert(tmp && pointer_is_aligned(tmp));
+	assert(width % TILE_WIDTH == 0 && height % TILE_HEIGHT == 0);
+
+	assert(pointer_is_aligned(src[0].buffer) && pointer_is_aligned(src[1].buffer) && pointer_is_aligned(src[2].buffer));
+	assert(pointer_is_aligned(dst[0].buffer) && pointer_is_aligned(dst[1].buffer) && pointer_is_aligned(dst[2].buffer));
+
+	try {
+		PlaneDescriptor src_desc[3];
+		PlaneDescriptor dst_desc[3];
+
+		ImageTile<const void> src_tiles[3];
+		ImageTile<void> dst_tiles[3];
+
+		for (int p = 0; p < 3; ++p) {
+			get_image_tile(&src[p], &src_tiles[p], &src_desc[p]);
+			get_image_tile(&dst[p], &dst_tiles[p], &dst_desc[p]);
+		}
+
+		ctx->p.process_plane(src_tiles, dst_tiles, width, height, tmp);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
 void zimg_colorspace_delete(zimg_colorspace_context *ctx)
 {
 	delete ctx;
 }
 
 
-struct zimg_depth_context {
-	depth::Depth p;
+struct zimg_colorspace_upsample_context {
+	ChromaResize resize;
+	colorspace::ColorspaceConversion csp;
 };
 
-zimg_depth_context *zimg_depth_create(int dither_type)
+zimg_colorspace_upsample_context *zimg_colorspace_upsample_create2(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                   int filter_type, double filter_param_a, double filter_param_b,
+                                                                   int matrix_in, int transfer_in, int primaries_in,
+                                                                   int matrix_out, int transfer_out, int primaries_out,
+                                                                   const zimg_create_options *options)
 {
-	zimg_depth_context *ret = nullptr;
+	zimg_colorspace_upsample_context *ret = nullptr;
 
 	try {
-		ret = new zimg_depth_context{ depth::Depth{ get_dither_type(dither_type), g_cpu_type } };
+		CPUClass cpu = get_cpu_option(options);
+		std::unique_ptr<resize::Filter> f{ create_filter(filter_type, filter_param_a, filter_param_b) };
+		colorspace::ColorspaceDefinition csp_in;
+		colorspace::ColorspaceDefinition csp_out;
+
+		if (subsample_w < 0 || subsample_h < 0)
+			throw ZimgIllegalArgument{ "invalid subsampling" };
+
+		csp_in.matrix     = get_matrix_coeffs(matrix_in);
+		csp_in.transfer   = get_transfer_characteristics(transfer_in);
+		csp_in.primaries  = get_color_primaries(primaries_in);
+
+		csp_out.matrix    = get_matrix_coeffs(matrix_out);
+		csp_out.transfer  = get_transfer_characteristics(transfer_out);
+		csp_out.primaries = get_color_primaries(primaries_out);
+
+		ChromaResize resize{ *f, width >> subsample_w, height >> subsample_h, width, height, -chroma_distance_h(chroma_loc, subsample_w) / (1 << subsample_w), 0.0, cpu };
+
+		ret = new zimg_colorspace_upsample_context{ resize, colorspace::ColorspaceConversion{ csp_in, csp_out, cpu } };
 	} catch (const ZimgException &e) {
 		handle_exception(e);
 	} catch (const std::bad_alloc &) {
@@ -345,14 +819,32 @@ zimg_depth_context *zimg_depth_create(int dither_type)
 	return ret;
 }
 
-int zimg_depth_tile_supported(zimg_depth_context *ctx, int pixel_in, int pixel_out)
+zimg_colorspace_upsample_context *zimg_colorspace_upsample_create(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                  int filter_type, double filter_param_a, double filter_param_b,
+                                                                  int matrix_in, int transfer_in, int primaries_in,
+                                                                  int matrix_out, int transfer_out, int primaries_out)
+{
+	return zimg_colorspace_upsample_create2(width, height, subsample_w, subsample_h, chroma_loc, filter_type, filter_param_a, filter_param_b,
+	                                        matrix_in, transfer_in, primaries_in, matrix_out, transfer_out, primaries_out, nullptr);
+}
+
+size_t zimg_colorspace_upsample_tmp_size(zimg_colorspace_upsample_context *ctx)
+{
+	size_t tile_size = TILE_WIDTH * TILE_HEIGHT * sizeof(float);
+
+	assert(ctx);
+	return 2 * tile_size + ctx->resize.tmp_size(sizeof(float)) + ctx->csp.tmp_size() * sizeof(float);
+}
+
+int zimg_colorspace_upsample_pixel_supported(zimg_colorspace_upsample_context *ctx, int pixel_type)
 {
 	int ret = 0;
 
 	assert(ctx);
 
 	try {
-		ret = ctx->p.tile_supported(get_pixel_type(pixel_in), get_pixel_type(pixel_out));
+		PixelType type = get_pixel_type(pixel_type);
+		ret = ctx->resize.pixel_supported(type) && ctx->csp.pixel_supported(type);
 	} catch (const ZimgException &e) {
 		handle_exception(e);
 	}
@@ -360,36 +852,61 @@ int zimg_depth_tile_supported(zimg_depth_context *ctx, int pixel_in, int pixel_o
 	return ret;
 }
 
-size_t zimg_depth_tmp_size(zimg_depth_context *ctx, int width)
+void zimg_colorspace_upsample_dependent_rect(zimg_colorspace_upsample_context *ctx, int dst_top, int dst_left, int dst_bottom, int dst_right,
+                                             int *src_top, int *src_left, int *src_bottom, int *src_right)
 {
-	return ctx->p.tmp_size(width);
+	assert(ctx);
+	assert(dst_top >= 0 && dst_bottom > dst_top);
+	assert(dst_left >= 0 && dst_right > dst_left);
+	assert(src_top && src_left && src_bottom && src_right);
+
+	ctx->resize.dependent_rect(dst_top, dst_left, dst_bottom, dst_right, src_top, src_left, src_bottom, src_right);
 }
 
-int zimg_depth_process(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp)
+int zimg_colorspace_upsample_process_tile(zimg_colorspace_upsample_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp)
 {
 	int ret = 0;
 
 	assert(ctx);
-	assert(src && src->buffer && pointer_is_aligned(src->buffer));
-	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
-	assert(pointer_is_aligned(tmp));
+	assert(src && src[0].buffer && src[1].buffer && src[2].buffer);
+	assert(dst && dst[0].buffer && dst[1].buffer && dst[2].buffer);
+	assert(tmp && pointer_is_aligned(tmp));
+	assert(dst[0].plane_offset_i >= 0 && dst[0].plane_offset_j >= 0);
 
 	try {
-		PlaneDescriptor src_desc;
-		PlaneDescriptor dst_desc;
+		PlaneDescriptor src_desc[3];
+		PlaneDescriptor dst_desc[3];
 
-		ImageTile<const void> src_tile;
-		ImageTile<void> dst_tile;
+		ImageTile<const void> src_tiles[3];
+		ImageTile<void> dst_tiles[3];
+		ImageTile<const void> csp_tiles[3];
 
-		get_image_tile(src, &src_tile, &src_desc);
-		get_image_tile(dst, &dst_tile, &dst_desc);
+		int i = dst[0].plane_offset_i;
+		int j = dst[0].plane_offset_j;
+		char *tmp_ptr = static_cast<char *>(tmp);
 
-		if (!ctx->p.tile_supported(src_desc.format.type, dst_desc.format.type)) {
-			assert(src->plane_offset_i == 0 && src->plane_offset_j == 0);
-			assert(dst->plane_offset_i == 0 && dst->plane_offset_j == 0);
+		for (int p = 0; p < 3; ++p) {
+			get_image_tile(&src[p], &src_tiles[p], &src_desc[p]);
+			get_image_tile(&dst[p], &dst_tiles[p], &dst_desc[p]);
+		}
+
+		csp_tiles[0] = src_tiles[0];
+
+		for (int p = 1; p < 3; ++p) {
+			ImageTile<void> up_tile{ tmp_ptr, &src_desc[p], TILE_WIDTH * src_desc[p].bytes_per_pixel };
+			int src_top, src_left, src_bottom, src_right;
+
+			ctx->resize.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &src_top, &src_left, &src_bottom, &src_right);
+			assert(src[p].plane_offset_i <= src_top && src[p].plane_offset_j <= src_left);
+
+			ctx->resize.process(src_tiles[p].sub_tile(src_top - src[p].plane_offset_i, src_left - src[p].plane_offset_j), up_tile, i, j,
+			                    tmp_ptr + 2 * TILE_WIDTH * TILE_HEIGHT * sizeof(float));
+
+			csp_tiles[p] = up_tile;
+			tmp_ptr += TILE_WIDTH * TILE_HEIGHT * sizeof(float);
 		}
 
-		ctx->p.process_tile(src_tile, dst_tile, tmp);
+		ctx->csp.process_tile(csp_tiles, dst_tiles, tmp_ptr + ctx->resize.tmp_size(sizeof(float)));
 	} catch (const ZimgException &e) {
 		handle_exception(e);
 		ret = g_last_error;
@@ -398,36 +915,345 @@ int zimg_depth_process(zimg_depth_context *ctx, const zimg_image_tile_t *src, co
 	return ret;
 }
 
-void zimg_depth_delete(zimg_depth_context *ctx)
+void zimg_colorspace_upsample_delete(zimg_colorspace_upsample_context *ctx)
 {
 	delete ctx;
 }
 
 
-struct zimg_resize_context {
-	resize::Resize p;
+struct zimg_colorspace_downsample_context {
+	ChromaResize resize;
+	colorspace::ColorspaceConversion csp;
+	int subsample_w;
+	int subsample_h;
+	int region_rows;
+	int region_stride;
 };
 
-int zimg_resize_horizontal_first(double xscale, double yscale)
-{
-	return resize::resize_horizontal_first(xscale, yscale);
-}
-
-zimg_resize_context *zimg_resize_create(int filter_type, int horizontal, int src_dim, int dst_dim,
-                                        double shift, double width, double filter_param_a, double filter_param_b)
+zimg_colorspace_downsample_context *zimg_colorspace_downsample_create2(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                       int filter_type, double filter_param_a, double filter_param_b,
+                                                                       int matrix_in, int transfer_in, int primaries_in,
+                                                                       int matrix_out, int transfer_out, int primaries_out,
+                                                                       const zimg_create_options *options)
 {
-	zimg_resize_context *ret = nullptr;
+	zimg_colorspace_downsample_context *ret = nullptr;
 
 	try {
+		CPUClass cpu = get_cpu_option(options);
 		std::unique_ptr<resize::Filter> f{ create_filter(filter_type, filter_param_a, filter_param_b) };
-		ret = new zimg_resize_context{ resize::Resize{ *f, !!horizontal, src_dim, dst_dim, shift, width, g_cpu_type } };
-	} catch (const ZimgException &e) {
-		handle_exception(e);
-	} catch (const std::bad_alloc &) {
-		handle_bad_alloc();
-	}
+		colorspace::ColorspaceDefinition csp_in;
+		colorspace::ColorspaceDefinition csp_out;
 
-	return ret;
+		int region_rows = 0;
+		int region_cols = 0;
+
+		if (subsample_w < 0 || subsample_h < 0)
+			throw ZimgIllegalArgument{ "invalid subsampling" };
+
+		csp_in.matrix     = get_matrix_coeffs(matrix_in);
+		csp_in.transfer   = get_transfer_characteristics(transfer_in);
+		csp_in.primaries  = get_color_primaries(primaries_in);
+
+		csp_out.matrix    = get_matrix_coeffs(matrix_out);
+		csp_out.transfer  = get_transfer_characteristics(transfer_out);
+		csp_out.primaries = get_color_primaries(primaries_out);
+
+		ChromaResize resize{ *f, width, height, width >> subsample_w, height >> subsample_h, chroma_distance_h(chroma_loc, subsample_w), 0.0, cpu };
+
+		for (int i = 0; i < (height >> subsample_h); i += TILE_HEIGHT) {
+			for (int j = 0; j < (width >> subsample_w); j += TILE_WIDTH) {
+				int top, left, bottom, right;
+
+				downsample_region(resize, subsample_w, subsample_h, i, j, &top, &left, &bottom, &right);
+				region_rows = std::max(region_rows, bottom - top);
+				region_cols = std::max(region_cols, right - left);
+			}
+		}
+
+		// Pad the region to allow reading past the end of each scanline.
+		region_cols = ceil_n(region_cols + TILE_WIDTH, AlignmentOf<float>::value);
+
+		ret = new zimg_colorspace_downsample_context{ resize, colorspace::ColorspaceConversion{ csp_in, csp_out, cpu },
+		                                              subsample_w, subsample_h, region_rows, region_cols };
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+zimg_colorspace_downsample_context *zimg_colorspace_downsample_create(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                      int filter_type, double filter_param_a, double filter_param_b,
+                                                                      int matrix_in, int transfer_in, int primaries_in,
+                                                                      int matrix_out, int transfer_out, int primaries_out)
+{
+	return zimg_colorspace_downsample_create2(width, height, subsample_w, subsample_h, chroma_loc, filter_type, filter_param_a, filter_param_b,
+	                                          matrix_in, transfer_in, primaries_in, matrix_out, transfer_out, primaries_out, nullptr);
+}
+
+size_t zimg_colorspace_downsample_tmp_size(zimg_colorspace_downsample_context *ctx)
+{
+	assert(ctx);
+	return 3 * (size_t)ctx->region_rows * ctx->region_stride * sizeof(float) + ctx->resize.tmp_size(sizeof(float));
+}
+
+int zimg_colorspace_downsample_pixel_supported(zimg_colorspace_downsample_context *ctx, int pixel_type)
+{
+	int ret = 0;
+
+	assert(ctx);
+
+	try {
+		PixelType type = get_pixel_type(pixel_type);
+		ret = type == PixelType::FLOAT && ctx->resize.pixel_supported(type) && ctx->csp.pixel_supported(type);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	}
+
+	return ret;
+}
+
+void zimg_colorspace_downsample_dependent_rect(zimg_colorspace_downsample_context *ctx, int dst_top, int dst_left,
+                                               int *src_top, int *src_left, int *src_bottom, int *src_right)
+{
+	assert(ctx);
+	assert(dst_top >= 0 && dst_left >= 0);
+	assert(src_top && src_left && src_bottom && src_right);
+
+	downsample_region(ctx->resize, ctx->subsample_w, ctx->subsample_h, dst_top, dst_left, src_top, src_left, src_bottom, src_right);
+}
+
+int zimg_colorspace_downsample_process_tile(zimg_colorspace_downsample_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src[0].buffer && src[1].buffer && src[2].buffer);
+	assert(dst && dst[0].buffer && dst[1].buffer && dst[2].buffer);
+	assert(tmp && pointer_is_aligned(tmp));
+	assert(dst[1].plane_offset_i >= 0 && dst[1].plane_offset_j >= 0);
+
+	try {
+		PlaneDescriptor src_desc[3];
+		PlaneDescriptor dst_desc[3];
+
+		ImageTile<const void> src_tiles[3];
+		ImageTile<void> dst_tiles[3];
+
+		PlaneDescriptor region_desc{ PixelType::FLOAT };
+		ImageTile<float> region_tiles[3];
+		float *region_ptr[3];
+
+		int i = dst[1].plane_offset_i;
+		int j = dst[1].plane_offset_j;
+		int top, left, bottom, right;
+		int chroma_top, chroma_left, chroma_bottom, chroma_right;
+
+		size_t region_size = (size_t)ctx->region_rows * ctx->region_stride;
+		float *resize_tmp = static_cast<float *>(tmp) + 3 * region_size;
+
+		for (int p = 0; p < 3; ++p) {
+			get_image_tile(&src[p], &src_tiles[p], &src_desc[p]);
+			get_image_tile(&dst[p], &dst_tiles[p], &dst_desc[p]);
+
+			if (src_desc[p].format.type != PixelType::FLOAT || dst_desc[p].format.type != PixelType::FLOAT)
+				throw ZimgUnsupportedError{ "only FLOAT is supported for chroma downsampling" };
+
+			region_tiles[p] = ImageTile<float>{ static_cast<float *>(tmp) + p * region_size, &region_desc, ctx->region_stride * (int)sizeof(float) };
+		}
+
+		downsample_region(ctx->resize, ctx->subsample_w, ctx->subsample_h, i, j, &top, &left, &bottom, &right);
+		assert(src[0].plane_offset_i <= top && src[0].plane_offset_j <= left);
+
+		// Convert exactly the required region, which is generally not aligned to tiles.
+		for (int r = top; r < bottom; ++r) {
+			for (int p = 0; p < 3; ++p) {
+				const float *src_row = tile_cast<const float>(src_tiles[p])[r - src[p].plane_offset_i] + (left - src[p].plane_offset_j);
+
+				region_ptr[p] = region_tiles[p][r - top];
+				std::copy_n(src_row, right - left, region_ptr[p]);
+			}
+
+			ctx->csp.process_scanline(region_ptr, right - left);
+		}
+
+		copy_image_tile_partial(ImageTile<const float>{ region_tiles[0].sub_tile((i << ctx->subsample_h) - top, (j << ctx->subsample_w) - left) },
+		                        tile_cast<float>(dst_tiles[0]), TILE_WIDTH << ctx->subsample_w, TILE_HEIGHT << ctx->subsample_h);
+
+		ctx->resize.dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &chroma_top, &chroma_left, &chroma_bottom, &chroma_right);
+
+		for (int p = 1; p < 3; ++p) {
+			ImageTile<const void> chroma_tile = tile_cast<const void>(ImageTile<const float>{ region_tiles[p] });
+			ctx->resize.process(chroma_tile.sub_tile(chroma_top - top, chroma_left - left), dst_tiles[p], i, j, resize_tmp);
+		}
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_colorspace_downsample_delete(zimg_colorspace_downsample_context *ctx)
+{
+	delete ctx;
+}
+
+
+struct zimg_depth_context {
+	depth::Depth p;
+};
+
+zimg_depth_context *zimg_depth_create2(int dither_type, const zimg_create_options *options)
+{
+	zimg_depth_context *ret = nullptr;
+
+	try {
+		ret = new zimg_depth_context{ depth::Depth{ get_dither_type(dither_type), get_cpu_option(options) } };
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+zimg_depth_context *zimg_depth_create(int dither_type)
+{
+	return zimg_depth_create2(dither_type, nullptr);
+}
+
+int zimg_depth_tile_supported(zimg_depth_context *ctx, int pixel_in, int pixel_out)
+{
+	int ret = 0;
+
+	assert(ctx);
+
+	try {
+		ret = ctx->p.tile_supported(get_pixel_type(pixel_in), get_pixel_type(pixel_out));
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	}
+
+	return ret;
+}
+
+size_t zimg_depth_tmp_size(zimg_depth_context *ctx, int width)
+{
+	return ctx->p.tmp_size(width) * sizeof(float);
+}
+
+int zimg_depth_process(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp)
+{
+	return zimg_depth_process_seeded(ctx, src, dst, tmp, 0);
+}
+
+int zimg_depth_process_seeded(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp, unsigned seed)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer && pointer_is_aligned(src->buffer));
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(pointer_is_aligned(tmp));
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor dst_desc;
+
+		ImageTile<const void> src_tile;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(src, &src_tile, &src_desc);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		if (!ctx->p.tile_supported(src_desc.format.type, dst_desc.format.type)) {
+			assert(src->plane_offset_i == 0 && src->plane_offset_j == 0);
+			assert(dst->plane_offset_i == 0 && dst->plane_offset_j == 0);
+		}
+
+		ctx->p.process_tile(src_tile, dst_tile, dst->plane_offset_i, dst->plane_offset_j, seed, tmp);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_depth_process_tiles(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp,
+                             int width, int height, unsigned seed)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer && pointer_is_aligned(src->buffer));
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(pointer_is_aligned(tmp));
+	assert(width % TILE_WIDTH == 0 && height % TILE_HEIGHT == 0);
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor dst_desc;
+
+		ImageTile<const void> src_tile;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(src, &src_tile, &src_desc);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		if (!ctx->p.tile_supported(src_desc.format.type, dst_desc.format.type))
+			throw ZimgIllegalArgument{ "conversion does not support tiles" };
+
+		ctx->p.process_plane(src_tile, dst_tile, dst->plane_offset_i, dst->plane_offset_j, width, height, seed, tmp);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_depth_delete(zimg_depth_context *ctx)
+{
+	delete ctx;
+}
+
+
+struct zimg_resize_context {
+	resize::Resize p;
+};
+
+int zimg_resize_horizontal_first(double xscale, double yscale)
+{
+	return resize::resize_horizontal_first(xscale, yscale);
+}
+
+zimg_resize_context *zimg_resize_create2(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                         double shift, double width, double filter_param_a, double filter_param_b,
+                                         const zimg_create_options *options)
+{
+	zimg_resize_context *ret = nullptr;
+
+	try {
+		std::unique_ptr<resize::Filter> f{ create_filter(filter_type, filter_param_a, filter_param_b) };
+		ret = new zimg_resize_context{ resize::Resize{ *f, !!horizontal, src_dim, dst_dim, shift, width, get_cpu_option(options) } };
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+zimg_resize_context *zimg_resize_create(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                        double shift, double width, double filter_param_a, double filter_param_b)
+{
+	return zimg_resize_create2(filter_type, horizontal, src_dim, dst_dim, shift, width, filter_param_a, filter_param_b, nullptr);
 }
 
 int zimg_resize_pixel_supported(zimg_resize_context *ctx, int pixel_type)
@@ -458,11 +1284,29 @@ int zimg_resize_process_tile(zimg_resize_context *ctx, const zimg_image_tile_t *
 {
 	int ret = 0;
 
+	assert(ctx);
+
+	try {
+		resize_process_tile(ctx->p, src, dst);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_resize_process_tiles(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int width, int height)
+{
+	int ret = 0;
+
 	assert(ctx);
 	assert(src && src->buffer);
 	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
 	assert(src->plane_offset_i >= 0 && src->plane_offset_j >= 0);
 	assert(dst->plane_offset_i >= 0 && dst->plane_offset_j >= 0);
+	assert(width > 0 && width % TILE_WIDTH == 0);
+	assert(height > 0 && height % TILE_HEIGHT == 0);
 
 	try {
 		PlaneDescriptor src_desc;
@@ -471,17 +1315,15 @@ int zimg_resize_process_tile(zimg_resize_context *ctx, const zimg_image_tile_t *
 		ImageTile<const void> src_tile;
 		ImageTile<void> dst_tile;
 
+		int top = dst->plane_offset_i;
+		int left = dst->plane_offset_j;
 		int src_top, src_left, src_bottom, src_right;
 
-		get_image_tile(src, &src_tile, &src_desc);
+		src_tile = get_resize_src_tile(ctx->p, src, &src_desc, top, left, top + height, left + width,
+		                               &src_top, &src_left, &src_bottom, &src_right);
 		get_image_tile(dst, &dst_tile, &dst_desc);
 
-		ctx->p.dependent_rect(dst->plane_offset_i, dst->plane_offset_j, dst->plane_offset_i + TILE_HEIGHT, dst->plane_offset_j + TILE_WIDTH,
-		                      &src_top, &src_left, &src_bottom, &src_right);
-		assert(src->plane_offset_i <= src_top && src->plane_offset_j <= src_left);
-
-		src_tile = src_tile.sub_tile(src_top - src->plane_offset_i, src_left - src->plane_offset_j);
-		ctx->p.process(src_tile, dst_tile, dst->plane_offset_i, dst->plane_offset_j);
+		ctx->p.process_plane(src_tile, dst_tile, top, left, top + height, left + width);
 	} catch (const ZimgException &e) {
 		handle_exception(e);
 		ret = g_last_error;
@@ -490,7 +1332,594 @@ int zimg_resize_process_tile(zimg_resize_context *ctx, const zimg_image_tile_t *
 	return ret;
 }
 
-void zimg_resize_delete(zimg_resize_context *ctx)
+size_t zimg_resize_batch_tmp_size(zimg_resize_context *ctx, int src_width, int src_height, int dst_width, int dst_height, int pixel_type)
+{
+	size_t ret = 0;
+
+	assert(ctx);
+
+	try {
+		ret = resize_batch_tmp_size(ctx->p, src_width, src_height, dst_width, dst_height, get_pixel_type(pixel_type));
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	}
+
+	return ret;
+}
+
+int zimg_resize_process_batch(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, size_t count, void *tmp)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && dst);
+	assert(!count || (tmp && pointer_is_aligned(tmp)));
+
+	try {
+		for (size_t n = 0; n < count; ++n) {
+			PlaneDescriptor src_desc;
+			PlaneDescriptor dst_desc;
+
+			ImageTile<const void> src_tile;
+			ImageTile<void> dst_tile;
+
+			assert(src[n].buffer);
+			assert(dst[n].buffer && pointer_is_aligned(dst[n].buffer));
+
+			get_image_tile(&src[n], &src_tile, &src_desc);
+			get_image_tile(&dst[n], &dst_tile, &dst_desc);
+
+			resize_process_plane(ctx->p, src_tile, dst_tile, tmp);
+		}
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+size_t zimg_resize_alpha_tmp_size(zimg_resize_context *ctx)
+{
+	assert(ctx);
+	return ctx->p.tmp_size_input() * sizeof(float);
+}
+
+int zimg_resize_process_tile_alpha(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *src_alpha,
+                                   const zimg_image_tile_t *dst, const zimg_image_tile_t *dst_alpha, void *tmp)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer);
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(!src_alpha || src_alpha->buffer);
+	assert(!dst_alpha || dst_alpha->buffer);
+	assert(tmp && pointer_is_aligned(tmp));
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor src_alpha_desc;
+		PlaneDescriptor dst_desc;
+		PlaneDescriptor dst_alpha_desc;
+
+		ImageTile<const void> src_tile;
+		ImageTile<const void> src_alpha_tile;
+		ImageTile<void> dst_tile;
+		ImageTile<const void> dst_alpha_tile;
+
+		int src_top, src_left, src_bottom, src_right;
+
+		src_tile = get_resize_src_tile(ctx->p, src, &src_desc, dst->plane_offset_i, dst->plane_offset_j,
+		                               dst->plane_offset_i + TILE_HEIGHT, dst->plane_offset_j + TILE_WIDTH,
+		                               &src_top, &src_left, &src_bottom, &src_right);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		if (src_alpha) {
+			get_image_tile(src_alpha, &src_alpha_tile, &src_alpha_desc);
+			src_alpha_tile = src_alpha_tile.sub_tile(src_top - src_alpha->plane_offset_i, src_left - src_alpha->plane_offset_j);
+		}
+		if (dst_alpha)
+			get_image_tile(dst_alpha, &dst_alpha_tile, &dst_alpha_desc);
+
+		ctx->p.process_alpha(src_tile, src_alpha ? &src_alpha_tile : nullptr, dst_tile, dst_alpha ? &dst_alpha_tile : nullptr,
+		                     dst->plane_offset_i, dst->plane_offset_j, tmp);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_resize_delete(zimg_resize_context *ctx)
+{
+	delete ctx;
+}
+
+
+struct zimg_resize_linear_context {
+	resize::Resize p;
+	std::unique_ptr<colorspace::Operation> to_linear;
+	std::unique_ptr<colorspace::Operation> to_gamma;
+};
+
+zimg_resize_linear_context *zimg_resize_linear_create2(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                                       double shift, double width, double filter_param_a, double filter_param_b,
+                                                       int transfer_in, int transfer_out,
+                                                       const zimg_create_options *options)
+{
+	zimg_resize_linear_context *ret = nullptr;
+
+	try {
+		CPUClass cpu = get_cpu_option(options);
+		std::unique_ptr<resize::Filter> f{ create_filter(filter_type, filter_param_a, filter_param_b) };
+		colorspace::TransferCharacteristics transfer_in_ = get_transfer_characteristics(transfer_in);
+		colorspace::TransferCharacteristics transfer_out_ = get_transfer_characteristics(transfer_out);
+		std::unique_ptr<colorspace::Operation> to_linear;
+		std::unique_ptr<colorspace::Operation> to_gamma;
+
+		if (transfer_in_ != colorspace::TransferCharacteristics::TRANSFER_LINEAR)
+			to_linear.reset(colorspace::create_gamma_to_linear_operation(transfer_in_, cpu));
+		if (transfer_out_ != colorspace::TransferCharacteristics::TRANSFER_LINEAR)
+			to_gamma.reset(colorspace::create_linear_to_gamma_operation(transfer_out_, cpu));
+
+		ret = new zimg_resize_linear_context{ resize::Resize{ *f, !!horizontal, src_dim, dst_dim, shift, width, cpu },
+		                                      std::move(to_linear), std::move(to_gamma) };
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+zimg_resize_linear_context *zimg_resize_linear_create(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                                      double shift, double width, double filter_param_a, double filter_param_b,
+                                                      int transfer_in, int transfer_out)
+{
+	return zimg_resize_linear_create2(filter_type, horizontal, src_dim, dst_dim, shift, width, filter_param_a, filter_param_b,
+	                                  transfer_in, transfer_out, nullptr);
+}
+
+size_t zimg_resize_linear_tmp_size(zimg_resize_linear_context *ctx)
+{
+	assert(ctx);
+
+	// Two extra scanlines allow the transfer function to be applied three scanlines at a time.
+	return (ctx->p.tmp_size_input() + 2 * ctx->p.tmp_input_stride()) * sizeof(float);
+}
+
+void zimg_resize_linear_dependent_rect(zimg_resize_linear_context *ctx, int dst_top, int dst_left, int dst_bottom, int dst_right,
+                                       int *src_top, int *src_left, int *src_bottom, int *src_right)
+{
+	assert(ctx);
+	assert(dst_top >= 0 && dst_bottom > dst_top);
+	assert(dst_left >= 0 && dst_right > dst_left);
+	assert(src_top && src_left && src_bottom && src_right);
+
+	ctx->p.dependent_rect(dst_top, dst_left, dst_bottom, dst_right, src_top, src_left, src_bottom, src_right);
+}
+
+int zimg_resize_linear_process_tile(zimg_resize_linear_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer);
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(tmp && pointer_is_aligned(tmp));
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor dst_desc;
+		PlaneDescriptor tmp_desc{ PixelType::FLOAT };
+
+		ImageTile<const void> src_tile;
+		ImageTile<void> dst_tile;
+		ImageTile<float> tmp_tile{ static_cast<float *>(tmp), &tmp_desc, ctx->p.tmp_input_stride() * (int)sizeof(float) };
+
+		int src_top, src_left, src_bottom, src_right;
+
+		src_tile = get_resize_src_tile(ctx->p, src, &src_desc, dst->plane_offset_i, dst->plane_offset_j,
+		                               dst->plane_offset_i + TILE_HEIGHT, dst->plane_offset_j + TILE_WIDTH,
+		                               &src_top, &src_left, &src_bottom, &src_right);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		if (src_desc.format.type != PixelType::FLOAT || dst_desc.format.type != PixelType::FLOAT)
+			throw ZimgUnsupportedError{ "only FLOAT is supported for linear resize" };
+
+		if (ctx->to_linear) {
+			ImageTile<const float> src_tile_f32 = tile_cast<const float>(src_tile);
+			int rows = src_bottom - src_top;
+			int cols = src_right - src_left;
+
+			// Linearize into the staging tile while each group of scanlines is still in cache.
+			for (int i = 0; i < rows; i += 3) {
+				float *ptr[3] = { tmp_tile[i], tmp_tile[i + 1], tmp_tile[i + 2] };
+
+				for (int p = 0; p < 3 && i + p < rows; ++p) {
+					std::copy_n(src_tile_f32[i + p], cols, ptr[p]);
+				}
+				ctx->to_linear->process(ptr, cols);
+			}
+
+			ctx->p.process(ImageTile<const void>{ tmp, &tmp_desc, tmp_tile.byte_stride() }, dst_tile, dst->plane_offset_i, dst->plane_offset_j);
+		} else {
+			ctx->p.process(src_tile, dst_tile, dst->plane_offset_i, dst->plane_offset_j);
+		}
+
+		if (ctx->to_gamma) {
+			ImageTile<float> dst_tile_f32 = tile_cast<float>(dst_tile);
+
+			// The staging tile is free at this point and provides the padding scanlines.
+			for (int i = 0; i < TILE_HEIGHT; i += 3) {
+				float *ptr[3];
+
+				for (int p = 0; p < 3; ++p) {
+					ptr[p] = i + p < TILE_HEIGHT ? dst_tile_f32[i + p] : tmp_tile[p];
+				}
+				ctx->to_gamma->process(ptr, TILE_WIDTH);
+			}
+		}
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_resize_linear_delete(zimg_resize_linear_context *ctx)
+{
+	delete ctx;
+}
+
+
+struct zimg_unresize_context {
+	unresize::Unresize p;
+};
+
+int zimg_unresize_horizontal_first(double xscale, double yscale)
+{
+	return unresize::unresize_horizontal_first(xscale, yscale);
+}
+
+zimg_unresize_context *zimg_unresize_create2(int filter_type, int horizontal, int src_dim, int dst_dim, double shift,
+                                             double filter_param_a, double filter_param_b,
+                                             const zimg_create_options *options)
+{
+	zimg_unresize_context *ret = nullptr;
+
+	try {
+		if (filter_type == ZIMG_RESIZE_BILINEAR) {
+			ret = new zimg_unresize_context{ unresize::Unresize{ !!horizontal, src_dim, dst_dim, shift, get_cpu_option(options) } };
+		} else {
+			std::unique_ptr<resize::Filter> f{ create_filter(filter_type, filter_param_a, filter_param_b) };
+			ret = new zimg_unresize_context{ unresize::Unresize{ *f, !!horizontal, src_dim, dst_dim, shift, get_cpu_option(options) } };
+		}
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+zimg_unresize_context *zimg_unresize_create(int filter_type, int horizontal, int src_dim, int dst_dim, double shift,
+                                            double filter_param_a, double filter_param_b)
+{
+	return zimg_unresize_create2(filter_type, horizontal, src_dim, dst_dim, shift, filter_param_a, filter_param_b, nullptr);
+}
+
+size_t zimg_unresize_tmp_size(zimg_unresize_context *ctx, int pixel_type)
+{
+	size_t ret = 0;
+
+	assert(ctx);
+
+	try {
+		PixelType type = get_pixel_type(pixel_type);
+		ret = ctx->p.tmp_size(type) * pixel_size(type);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	}
+
+	return ret;
+}
+
+int zimg_unresize_process(zimg_unresize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer && pointer_is_aligned(src->buffer));
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(!tmp || pointer_is_aligned(tmp));
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor dst_desc;
+		ImageTile<const void> src_tile;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(src, &src_tile, &src_desc);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		ctx->p.process(src_tile, dst_tile, tmp);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_unresize_dependent_rows(zimg_unresize_context *ctx, int dst_top, int dst_bottom, int *src_top, int *src_bottom)
+{
+	assert(ctx);
+	assert(dst_top >= 0 && dst_bottom > dst_top);
+	assert(src_top && src_bottom);
+
+	ctx->p.dependent_rows(dst_top, dst_bottom, src_top, src_bottom);
+}
+
+int zimg_unresize_process_strip(zimg_unresize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst,
+                                int dst_top, int dst_bottom, void *tmp)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer && pointer_is_aligned(src->buffer));
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(dst_top >= 0 && dst_bottom > dst_top && dst_bottom <= dst->plane_height);
+	assert(!tmp || pointer_is_aligned(tmp));
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor dst_desc;
+		ImageTile<const void> src_tile;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(src, &src_tile, &src_desc);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		ctx->p.process_strip(src_tile, dst_tile, dst_top, dst_bottom, tmp);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_unresize_process_strip_back(zimg_unresize_context *ctx, const zimg_image_tile_t *dst, int dst_top, int dst_bottom)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(dst_top >= 0 && dst_bottom > dst_top && dst_bottom <= dst->plane_height);
+
+	try {
+		PlaneDescriptor dst_desc;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		ctx->p.process_strip_back(dst_tile, dst_top, dst_bottom);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_unresize_set_partitions(zimg_unresize_context *ctx, int count)
+{
+	int ret = 0;
+
+	assert(ctx);
+
+	try {
+		ctx->p.set_partitions(count);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_unresize_partition_rows(zimg_unresize_context *ctx, int k, int *dst_top, int *dst_bottom)
+{
+	assert(ctx);
+	assert(k >= 0 && k < ctx->p.num_partitions());
+	assert(dst_top && dst_bottom);
+
+	ctx->p.partition_rows(k, dst_top, dst_bottom);
+}
+
+int zimg_unresize_process_partition(zimg_unresize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int k)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src->buffer && pointer_is_aligned(src->buffer));
+	assert(dst && dst->buffer && pointer_is_aligned(dst->buffer));
+	assert(k >= 0 && k < ctx->p.num_partitions());
+
+	try {
+		PlaneDescriptor src_desc;
+		PlaneDescriptor dst_desc;
+		ImageTile<const void> src_tile;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(src, &src_tile, &src_desc);
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		ctx->p.process_partition(src_tile, dst_tile, k);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_unresize_process_partition_reduce(zimg_unresize_context *ctx, const zimg_image_tile_t *dst)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(dst && dst->buffer);
+
+	try {
+		PlaneDescriptor dst_desc;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		ctx->p.process_partition_reduce(dst_tile);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_unresize_process_partition_fixup(zimg_unresize_context *ctx, const zimg_image_tile_t *dst, int k)
+{
+	int ret = 0;
+
+	assert(ctx);
+	assert(dst && dst->buffer);
+	assert(k >= 0 && k < ctx->p.num_partitions());
+
+	try {
+		PlaneDescriptor dst_desc;
+		ImageTile<void> dst_tile;
+
+		get_image_tile(dst, &dst_tile, &dst_desc);
+
+		ctx->p.process_partition_fixup(dst_tile, k);
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_unresize_delete(zimg_unresize_context *ctx)
+{
+	delete ctx;
+}
+
+
+struct zimg_packed_context {
+	std::unique_ptr<colorspace::PackedAdapter> p;
+	colorspace::PackedFormat format;
+};
+
+zimg_packed_context *zimg_packed_create2(int format, const zimg_create_options *options)
+{
+	zimg_packed_context *ret = nullptr;
+
+	try {
+		colorspace::PackedFormat packed_format = get_packed_format(format);
+		std::unique_ptr<colorspace::PackedAdapter> adapter{ colorspace::create_packed_adapter(packed_format, get_cpu_option(options)) };
+
+		ret = new zimg_packed_context{ std::move(adapter), packed_format };
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+	} catch (const std::bad_alloc &) {
+		handle_bad_alloc();
+	}
+
+	return ret;
+}
+
+zimg_packed_context *zimg_packed_create(int format)
+{
+	return zimg_packed_create2(format, nullptr);
+}
+
+int zimg_packed_planes(zimg_packed_context *ctx)
+{
+	assert(ctx);
+	return colorspace::packed_format_planes(ctx->format);
+}
+
+int zimg_packed_unpack(zimg_packed_context *ctx, const void *src, int src_stride, void * const dst[], const int dst_stride[], int width, int height)
+{
+	int planes;
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && dst && dst_stride);
+	assert(width >= 0 && height >= 0);
+
+	planes = colorspace::packed_format_planes(ctx->format);
+
+	try {
+		if (ctx->format == colorspace::PackedFormat::UYVY && width % 2)
+			throw ZimgIllegalArgument{ "UYVY width must be even" };
+
+		for (int i = 0; i < height; ++i) {
+			uint8_t *dst_ptr[4];
+
+			for (int p = 0; p < planes; ++p) {
+				dst_ptr[p] = static_cast<uint8_t *>(dst[p]) + static_cast<ptrdiff_t>(i) * dst_stride[p];
+			}
+
+			ctx->p->unpack(static_cast<const uint8_t *>(src) + static_cast<ptrdiff_t>(i) * src_stride, dst_ptr, width);
+		}
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+int zimg_packed_pack(zimg_packed_context *ctx, const void * const src[], const int src_stride[], void *dst, int dst_stride, int width, int height)
+{
+	int planes;
+	int ret = 0;
+
+	assert(ctx);
+	assert(src && src_stride && dst);
+	assert(width >= 0 && height >= 0);
+
+	planes = colorspace::packed_format_planes(ctx->format);
+
+	try {
+		if (ctx->format == colorspace::PackedFormat::UYVY && width % 2)
+			throw ZimgIllegalArgument{ "UYVY width must be even" };
+
+		for (int i = 0; i < height; ++i) {
+			const uint8_t *src_ptr[4];
+
+			for (int p = 0; p < planes; ++p) {
+				src_ptr[p] = static_cast<const uint8_t *>(src[p]) + static_cast<ptrdiff_t>(i) * src_stride[p];
+			}
+
+			ctx->p->pack(src_ptr, static_cast<uint8_t *>(dst) + static_cast<ptrdiff_t>(i) * dst_stride, width);
+		}
+	} catch (const ZimgException &e) {
+		handle_exception(e);
+		ret = g_last_error;
+	}
+
+	return ret;
+}
+
+void zimg_packed_delete(zimg_packed_context *ctx)
 {
 	delete ctx;
 }
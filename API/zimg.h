@@ -7,7 +7,7 @@ extern "C" {;
 
 #include <stddef.h>
 
-#define ZIMG_API_VERSION 2
+#define ZIMG_API_VERSION 3
 
 #define ZIMG_ERROR_UNKNOWN           -1
 #define ZIMG_ERROR_LOGIC            100 /* Internal logic error. */
@@ -42,11 +42,74 @@ void zimg_clear_last_error(void);
 #endif
 
 /**
- * Set the desired CPU type to [cpu]. The result is set globally.
- * This function is thread-safe.
+ * Set the desired CPU type to [cpu]. The result is set globally, and applies to contexts
+ * subsequently created without a CPU type in their options. This function is thread-safe.
  */
 void zimg_set_cpu(int cpu);
 
+#define ZIMG_CPU_GLOBAL -1 /* Use the CPU type set by zimg_set_cpu. */
+
+/**
+ * Options applied when creating a context. The *_create2 functions take a pointer to this struct,
+ * or NULL to use the defaults, and the *_create functions use the defaults. The options are only read at creation, so contexts created with different
+ * options, such as different CPU types, may coexist and be used concurrently.
+ *
+ * The struct must be initialized by zimg_create_options_default. Fields may be added in later API versions,
+ * and are only read if [version] is at least the version in which they were added.
+ */
+typedef struct zimg_create_options {
+	unsigned version; /* API version the struct was initialized for. */
+	int cpu;          /* CPU type as in zimg_set_cpu, or ZIMG_CPU_GLOBAL. Since version 3. */
+} zimg_create_options;
+
+/* Initialize [options] with the defaults for API [version], normally ZIMG_API_VERSION. */
+void zimg_create_options_default(zimg_create_options *options, unsigned version);
+
+
+/**
+ * Allocation functions for the aligned buffers held by contexts, such as filter coefficients and tables.
+ * [alloc] returns a buffer of [size] bytes aligned to [alignment], or NULL on failure.
+ * [free] releases a buffer returned by [alloc]. Both receive the [user] pointer passed to zimg_set_allocator.
+ */
+typedef void *(*zimg_alloc_func)(void *user, size_t size, size_t alignment);
+typedef void (*zimg_free_func)(void *user, void *ptr);
+
+/**
+ * Replace the allocation functions. If [alloc] or [free] is NULL, the default functions are restored.
+ * Buffers are released with the functions in effect when they are freed, so this function must be called
+ * while no context exists, typically at startup. Internally cached buffers are released before the functions
+ * are replaced. This function is not thread-safe.
+ */
+void zimg_set_allocator(zimg_alloc_func alloc, zimg_free_func free, void *user);
+
+
+typedef struct zimg_arena zimg_arena;
+
+/**
+ * Create an arena handing out aligned temporary buffers from the caller-supplied block of [size] bytes at [buffer],
+ * for example memory backed by huge pages. The block is not freed by the arena, and must outlive it.
+ * Temporary buffers for any process function may be taken from an arena, so that no allocation is done per frame.
+ *
+ * On error, a NULL pointer is returned.
+ */
+zimg_arena *zimg_arena_create(void *buffer, size_t size);
+
+/**
+ * Take a buffer of [size] bytes, suitably aligned for the process functions, from the arena.
+ * The buffer remains valid until zimg_arena_reset. This function is thread-safe.
+ *
+ * If the arena is exhausted, a NULL pointer is returned.
+ */
+void *zimg_arena_alloc(zimg_arena *arena, size_t size);
+
+/* Get the number of bytes taken from the arena, including alignment padding. */
+size_t zimg_arena_used(zimg_arena *arena);
+
+/* Return all buffers to the arena. The buffers must no longer be in use. */
+void zimg_arena_reset(zimg_arena *arena);
+
+void zimg_arena_delete(zimg_arena *arena);
+
 
 #define ZIMG_PIXEL_BYTE  0 /* Unsigned integer, one byte per sample. */
 #define ZIMG_PIXEL_WORD  1 /* Unsigned integer, two bytes per sample. */
@@ -108,6 +171,11 @@ typedef struct zimg_colorspace_context zimg_colorspace_context;
 zimg_colorspace_context *zimg_colorspace_create(int matrix_in, int transfer_in, int primaries_in,
                                                 int matrix_out, int transfer_out, int primaries_out);
 
+/* As zimg_colorspace_create, with the given [options]. */
+zimg_colorspace_context *zimg_colorspace_create2(int matrix_in, int transfer_in, int primaries_in,
+                                                 int matrix_out, int transfer_out, int primaries_out,
+                                                 const zimg_create_options *options);
+
 /* Get the temporary buffer size in bytes required to process a tile using [ctx]. */
 size_t zimg_colorspace_tmp_size(zimg_colorspace_context *ctx);
 
@@ -121,14 +189,26 @@ int zimg_colorspace_pixel_supported(zimg_colorspace_context *ctx, int pixel_type
  */
 int zimg_colorspace_process_tile(zimg_colorspace_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp, int pixel_type);
 
+/**
+ * Process a rectangle of [width] x [height] pixels starting at the given tiles, as if by calling zimg_colorspace_process_tile on each tile.
+ * The dimensions must be multiples of 64.
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_colorspace_process_tiles(zimg_colorspace_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp,
+                                  int width, int height);
+
 /* Delete the context. */
 void zimg_colorspace_delete(zimg_colorspace_context *ctx);
 
 
-#define ZIMG_DITHER_NONE            0
-#define ZIMG_DITHER_ORDERED         1
-#define ZIMG_DITHER_RANDOM          2
-#define ZIMG_DITHER_ERROR_DIFFUSION 3
+#define ZIMG_DITHER_NONE                       0
+#define ZIMG_DITHER_ORDERED                    1
+#define ZIMG_DITHER_RANDOM                     2
+#define ZIMG_DITHER_ERROR_DIFFUSION            3
+#define ZIMG_DITHER_BLUE_NOISE                 4
+#define ZIMG_DITHER_SIERRA_LITE                5
+#define ZIMG_DITHER_ERROR_DIFFUSION_ROW        6
+#define ZIMG_DITHER_ERROR_DIFFUSION_SERPENTINE 7
 
 typedef struct zimg_depth_context zimg_depth_context;
 
@@ -138,6 +218,9 @@ typedef struct zimg_depth_context zimg_depth_context;
  */
 zimg_depth_context *zimg_depth_create(int dither_type);
 
+/* As zimg_depth_create, with the given [options]. */
+zimg_depth_context *zimg_depth_create2(int dither_type, const zimg_create_options *options);
+
 /**
  * Check if the context [ctx] operates on tiles or planes when converting [pixel_in] to [pixel_out].
  *
@@ -148,7 +231,7 @@ int zimg_depth_tile_supported(zimg_depth_context *ctx, int pixel_in, int pixel_o
 
 /** 
  * Get the temporary buffer size in bytes required to process a plane with [width] using [ctx].
- * This function is only required if zimg_depth_tile_supported returns zero.
+ * This function is only required if zimg_depth_tile_supported returns zero or the dither type is ZIMG_DITHER_RANDOM.
  */
 size_t zimg_depth_tmp_size(zimg_depth_context *ctx, int width);
 
@@ -163,6 +246,23 @@ size_t zimg_depth_tmp_size(zimg_depth_context *ctx, int width);
  */
 int zimg_depth_process(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp);
 
+/**
+ * Process a tile or a plane as in zimg_depth_process, using [seed] to vary the dither between frames.
+ * For ZIMG_DITHER_RANDOM, the noise is a function of [seed] and the position of each pixel,
+ * which is determined by the plane_offset_i and plane_offset_j fields of [dst].
+ */
+int zimg_depth_process_seeded(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp, unsigned seed);
+
+/**
+ * Process a rectangle of [width] x [height] pixels starting at the given tiles, as if by calling zimg_depth_process_seeded on each tile.
+ * The dimensions must be multiples of 64, and zimg_depth_tile_supported must return non-zero for the pixel types.
+ * The position of the rectangle is determined by the plane_offset_i and plane_offset_j fields of [dst].
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_depth_process_tiles(zimg_depth_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp,
+                             int width, int height, unsigned seed);
+
 /* Delete the context. */
 void zimg_depth_delete(zimg_depth_context *ctx);
 
@@ -198,7 +298,15 @@ int zimg_resize_horizontal_first(double xscale, double yscale);
 zimg_resize_context *zimg_resize_create(int filter_type, int horizontal, int src_dim, int dst_dim,
                                         double shift, double width, double filter_param_a, double filter_param_b);
 
-/* Check if the context [ctx] supports processing [pixel_type]. */
+/* As zimg_resize_create, with the given [options]. */
+zimg_resize_context *zimg_resize_create2(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                         double shift, double width, double filter_param_a, double filter_param_b,
+                                         const zimg_create_options *options);
+
+/**
+ * Check if the context [ctx] supports processing [pixel_type].
+ * Point resizing supports every pixel type, including ZIMG_PIXEL_BYTE.
+ */
 int zimg_resize_pixel_supported(zimg_resize_context *ctx, int pixel_type);
 
 /**
@@ -219,10 +327,324 @@ void zimg_resize_dependent_rect(zimg_resize_context *ctx, int dst_top, int dst_l
  */
 int zimg_resize_process_tile(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst);
 
+/**
+ * Process a rectangle of [width] x [height] output pixels, as if by calling zimg_resize_process_tile on each tile.
+ * The dimensions must be multiples of 64. The output rectangle starts at the plane_offset_i and plane_offset_j fields of [dst],
+ * and the input tile must contain the rectangle indicated by zimg_resize_dependent_rect for the whole output rectangle.
+ * A context may be shared by several threads, so a plane can be divided into rectangles processed by separate threads.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_resize_process_tiles(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int width, int height);
+
+/* Get the temporary buffer size in bytes required to process an image of the given dimensions using zimg_resize_process_batch. */
+size_t zimg_resize_batch_tmp_size(zimg_resize_context *ctx, int src_width, int src_height, int dst_width, int dst_height, int pixel_type);
+
+/**
+ * Process [count] entire planes from the arrays [src] and [dst] in one call, such as many small images sharing one context.
+ * Each pair of tiles describes a whole plane, with the plane_width and plane_height fields set and the buffer pointing
+ * to its top-left pixel. The planes may have any dimensions consistent with the context, including sizes that are
+ * not multiples of 64. Whole tiles are processed in place, and the tiles at the right and bottom edges are staged
+ * in [tmp], which must hold zimg_resize_batch_tmp_size bytes for the largest image.
+ *
+ * A context may be shared by several threads, so large batches can be divided between threads by the caller.
+ * Processing stops at the first failing image. On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_resize_process_batch(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, size_t count, void *tmp);
+
+/* Get the temporary buffer size in bytes required to process a tile using zimg_resize_process_tile_alpha. */
+size_t zimg_resize_alpha_tmp_size(zimg_resize_context *ctx);
+
+/**
+ * Process a 64x64 tile of a color plane with straight alpha, filtering the color premultiplied by alpha to avoid halos.
+ * The alpha plane itself is resized with zimg_resize_process_tile.
+ *
+ * [src_alpha] is the alpha tile matching [src], used to premultiply the input, or NULL if the input is already premultiplied.
+ * [dst_alpha] is the resized alpha tile matching [dst], used to unpremultiply the output, or NULL to keep it premultiplied.
+ * For a two pass resize, [src_alpha] is passed in the first pass and [dst_alpha] in the second.
+ * Only ZIMG_PIXEL_FLOAT is supported.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_resize_process_tile_alpha(zimg_resize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *src_alpha,
+                                   const zimg_image_tile_t *dst, const zimg_image_tile_t *dst_alpha, void *tmp);
+
 /* Delete the context. */
 void zimg_resize_delete(zimg_resize_context *ctx);
 
 
+typedef struct zimg_resize_linear_context zimg_resize_linear_context;
+
+/**
+ * Create a context to resize in linear light without separate colorspace passes.
+ * The input is converted from [transfer_in] to linear light as each tile is loaded,
+ * and the output from linear light to [transfer_out] as it is stored.
+ *
+ * Passing ZIMG_TRANSFER_LINEAR for either side skips that conversion. For a two pass resize,
+ * the first pass is created with (transfer, ZIMG_TRANSFER_LINEAR) and the second with (ZIMG_TRANSFER_LINEAR, transfer),
+ * keeping the intermediate image linear. The remaining parameters have the same meaning as in zimg_resize_create.
+ * Only ZIMG_PIXEL_FLOAT is supported.
+ */
+zimg_resize_linear_context *zimg_resize_linear_create(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                                      double shift, double width, double filter_param_a, double filter_param_b,
+                                                      int transfer_in, int transfer_out);
+
+/* As zimg_resize_linear_create, with the given [options]. */
+zimg_resize_linear_context *zimg_resize_linear_create2(int filter_type, int horizontal, int src_dim, int dst_dim,
+                                                       double shift, double width, double filter_param_a, double filter_param_b,
+                                                       int transfer_in, int transfer_out,
+                                                       const zimg_create_options *options);
+
+/* Get the temporary buffer size in bytes required to process a tile. */
+size_t zimg_resize_linear_tmp_size(zimg_resize_linear_context *ctx);
+
+/* See zimg_resize_dependent_rect. */
+void zimg_resize_linear_dependent_rect(zimg_resize_linear_context *ctx, int dst_top, int dst_left, int dst_bottom, int dst_right,
+                                       int *src_top, int *src_left, int *src_bottom, int *src_right);
+
+/* See zimg_resize_process_tile. */
+int zimg_resize_linear_process_tile(zimg_resize_linear_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp);
+
+void zimg_resize_linear_delete(zimg_resize_linear_context *ctx);
+
+
+typedef struct zimg_unresize_context zimg_unresize_context;
+
+/**
+ * Query whether performing horizontal or vertical unresizing first is faster.
+ * See zimg_resize_horizontal_first.
+ */
+int zimg_unresize_horizontal_first(double xscale, double yscale);
+
+/**
+ * Create a context to reverse an upsampling from [dst_dim] to [src_dim], where [src_dim] is greater than [dst_dim].
+ * The upsampling was done by the filter given by [filter_type], [filter_param_a] and [filter_param_b],
+ * as in zimg_resize_create.
+ * The unresizing is done horizontally if the [horizontal] argument is non-zero.
+ * The center of the image is shifted by [shift] input pixels.
+ *
+ * Partitioning is only supported for ZIMG_RESIZE_BILINEAR.
+ *
+ * On error, a NULL pointer is returned.
+ */
+zimg_unresize_context *zimg_unresize_create(int filter_type, int horizontal, int src_dim, int dst_dim, double shift,
+                                            double filter_param_a, double filter_param_b);
+
+/* As zimg_unresize_create, with the given [options]. */
+zimg_unresize_context *zimg_unresize_create2(int filter_type, int horizontal, int src_dim, int dst_dim, double shift,
+                                             double filter_param_a, double filter_param_b,
+                                             const zimg_create_options *options);
+
+/* Get the temporary buffer size in bytes required to process [pixel_type]. */
+size_t zimg_unresize_tmp_size(zimg_unresize_context *ctx, int pixel_type);
+
+/**
+ * Process an entire plane. The tiles must have the plane_width and plane_height fields set.
+ * ZIMG_PIXEL_WORD and ZIMG_PIXEL_FLOAT are supported, and ZIMG_PIXEL_HALF if the context was created for AVX2.
+ * ZIMG_PIXEL_WORD is converted in blocks within the temporary buffer and clamped to the range of the depth field
+ * of [dst], or to [0, 65535] if it is not set.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_unresize_process(zimg_unresize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, void *tmp);
+
+/**
+ * Get the input rows required to process the output rows [dst_top] to [dst_bottom].
+ * The range is returned in the pointers [src_top] and [src_bottom].
+ */
+void zimg_unresize_dependent_rows(zimg_unresize_context *ctx, int dst_top, int dst_bottom, int *src_top, int *src_bottom);
+
+/**
+ * Process the output rows [dst_top] to [dst_bottom], such that only the input rows
+ * indicated by zimg_unresize_dependent_rows need to be present in memory.
+ *
+ * The input tile begins at the first dependent row. The output tile spans the entire plane,
+ * with plane_height set to its height. For both tiles, plane_width is the number of columns to process,
+ * so that a strip can be divided into column ranges for threading when unresizing vertically.
+ *
+ * Horizontal strips are complete after this call and may be processed in any order.
+ * Vertical strips must be processed from top to bottom and then completed
+ * with zimg_unresize_process_strip_back from bottom to top.
+ * Only ZIMG_PIXEL_HALF and ZIMG_PIXEL_FLOAT are supported.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_unresize_process_strip(zimg_unresize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst,
+                                int dst_top, int dst_bottom, void *tmp);
+
+/* Complete a strip processed with zimg_unresize_process_strip. Does nothing for horizontal contexts. */
+int zimg_unresize_process_strip_back(zimg_unresize_context *ctx, const zimg_image_tile_t *dst, int dst_top, int dst_bottom);
+
+/**
+ * Divide the rows of a vertical context into [count] partitions that can be solved concurrently,
+ * such that a single plane can be processed by several threads. Each partition must hold at least two rows.
+ * Passing 1 removes the partitioning. This function must not be called while the context is in use.
+ *
+ * A plane is processed in three steps, each of which must complete before the next begins:
+ * zimg_unresize_process_partition for every partition, zimg_unresize_process_partition_reduce once,
+ * and zimg_unresize_process_partition_fixup for every partition. Only ZIMG_PIXEL_FLOAT is supported.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_unresize_set_partitions(zimg_unresize_context *ctx, int count);
+
+/* Get the output rows [dst_top] to [dst_bottom] of partition [k]. */
+void zimg_unresize_partition_rows(zimg_unresize_context *ctx, int k, int *dst_top, int *dst_bottom);
+
+/**
+ * Solve partition [k] independently of its neighbours. The input tile begins at the first row indicated
+ * by zimg_unresize_dependent_rows for the partition, and the output tile spans the entire plane.
+ */
+int zimg_unresize_process_partition(zimg_unresize_context *ctx, const zimg_image_tile_t *src, const zimg_image_tile_t *dst, int k);
+
+/**
+ * Solve the system coupling the partitions. As in zimg_unresize_process_strip,
+ * the plane may be divided into column ranges by setting plane_width.
+ */
+int zimg_unresize_process_partition_reduce(zimg_unresize_context *ctx, const zimg_image_tile_t *dst);
+
+/* Complete partition [k]. */
+int zimg_unresize_process_partition_fixup(zimg_unresize_context *ctx, const zimg_image_tile_t *dst, int k);
+
+/* Delete the context. */
+void zimg_unresize_delete(zimg_unresize_context *ctx);
+
+
+#define ZIMG_CHROMA_LOC_MPEG1 0 /* Chroma sited between luma samples, as in JPEG. */
+#define ZIMG_CHROMA_LOC_MPEG2 1 /* Chroma co-sited horizontally with the left luma sample. */
+
+typedef struct zimg_colorspace_upsample_context zimg_colorspace_upsample_context;
+
+/**
+ * Create a context to convert a [width] by [height] image with chroma subsampled by 2^[subsample_w] and 2^[subsample_h]
+ * between the described colorspaces, upsampling the chroma with the given resampling filter on the fly.
+ * This avoids resizing the chroma planes into temporary full size planes before the conversion.
+ * The filter parameters have the same meaning as in zimg_resize_create.
+ *
+ * On error, a NULL pointer is returned.
+ */
+zimg_colorspace_upsample_context *zimg_colorspace_upsample_create(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                  int filter_type, double filter_param_a, double filter_param_b,
+                                                                  int matrix_in, int transfer_in, int primaries_in,
+                                                                  int matrix_out, int transfer_out, int primaries_out);
+
+/* As zimg_colorspace_upsample_create, with the given [options]. */
+zimg_colorspace_upsample_context *zimg_colorspace_upsample_create2(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                   int filter_type, double filter_param_a, double filter_param_b,
+                                                                   int matrix_in, int transfer_in, int primaries_in,
+                                                                   int matrix_out, int transfer_out, int primaries_out,
+                                                                   const zimg_create_options *options);
+
+/* Get the temporary buffer size in bytes required to process a tile using [ctx]. */
+size_t zimg_colorspace_upsample_tmp_size(zimg_colorspace_upsample_context *ctx);
+
+/* Check if the context [ctx] supports processing [pixel_type]. */
+int zimg_colorspace_upsample_pixel_supported(zimg_colorspace_upsample_context *ctx, int pixel_type);
+
+/* Get the rectangle of the chroma planes required to process an output rectangle. See zimg_resize_dependent_rect. */
+void zimg_colorspace_upsample_dependent_rect(zimg_colorspace_upsample_context *ctx, int dst_top, int dst_left, int dst_bottom, int dst_right,
+                                             int *src_top, int *src_left, int *src_bottom, int *src_right);
+
+/**
+ * Process a 64x64 tile. The first input tile is the luma tile at the position of the output tiles.
+ * The chroma input tiles must contain the rectangle indicated by zimg_colorspace_upsample_dependent_rect,
+ * and may be read up to 16 pixels past their end.
+ *
+ * The output tiles and chroma input tiles must have the plane_offset_i and plane_offset_j fields set.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_colorspace_upsample_process_tile(zimg_colorspace_upsample_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp);
+
+/* Delete the context. */
+void zimg_colorspace_upsample_delete(zimg_colorspace_upsample_context *ctx);
+
+typedef struct zimg_colorspace_downsample_context zimg_colorspace_downsample_context;
+
+/**
+ * Create a context to convert a [width] by [height] image between the described colorspaces,
+ * subsampling the chroma of the result by 2^[subsample_w] and 2^[subsample_h] with the given resampling filter on the fly.
+ * This avoids writing and reading back full size chroma planes before resizing them.
+ * Only ZIMG_PIXEL_FLOAT is supported.
+ *
+ * On error, a NULL pointer is returned.
+ */
+zimg_colorspace_downsample_context *zimg_colorspace_downsample_create(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                      int filter_type, double filter_param_a, double filter_param_b,
+                                                                      int matrix_in, int transfer_in, int primaries_in,
+                                                                      int matrix_out, int transfer_out, int primaries_out);
+
+/* As zimg_colorspace_downsample_create, with the given [options]. */
+zimg_colorspace_downsample_context *zimg_colorspace_downsample_create2(int width, int height, int subsample_w, int subsample_h, int chroma_loc,
+                                                                       int filter_type, double filter_param_a, double filter_param_b,
+                                                                       int matrix_in, int transfer_in, int primaries_in,
+                                                                       int matrix_out, int transfer_out, int primaries_out,
+                                                                       const zimg_create_options *options);
+
+/* Get the temporary buffer size in bytes required to process a tile using [ctx]. */
+size_t zimg_colorspace_downsample_tmp_size(zimg_colorspace_downsample_context *ctx);
+
+/* Check if the context [ctx] supports processing [pixel_type]. */
+int zimg_colorspace_downsample_pixel_supported(zimg_colorspace_downsample_context *ctx, int pixel_type);
+
+/**
+ * Get the rectangle of the input planes required to process the chroma tile at [dst_top], [dst_left].
+ * The rectangle is returned in the pointers [src_top], [src_left], [src_bottom], and [src_right].
+ */
+void zimg_colorspace_downsample_dependent_rect(zimg_colorspace_downsample_context *ctx, int dst_top, int dst_left,
+                                               int *src_top, int *src_left, int *src_bottom, int *src_right);
+
+/**
+ * Process a 64x64 chroma tile. The input tiles must contain the rectangle indicated by zimg_colorspace_downsample_dependent_rect
+ * and have the plane_offset_i and plane_offset_j fields set, as must the chroma output tiles.
+ *
+ * The first output tile receives the luma pixels covered by the chroma tile,
+ * a block of 64*2^[subsample_h] rows and 64*2^[subsample_w] columns.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_colorspace_downsample_process_tile(zimg_colorspace_downsample_context *ctx, const zimg_image_tile_t src[3], const zimg_image_tile_t dst[3], void *tmp);
+
+/* Delete the context. */
+void zimg_colorspace_downsample_delete(zimg_colorspace_downsample_context *ctx);
+
+
+#define ZIMG_PACKED_RGB24 0 /* R, G, B. */
+#define ZIMG_PACKED_RGBA  1 /* R, G, B, A. */
+#define ZIMG_PACKED_UYVY  2 /* U, Y, V, Y (4:2:2). Unpacked in the order Y, U, V with half width chroma planes. */
+#define ZIMG_PACKED_NV12  3 /* U, V. The interleaved chroma plane of NV12, NV16, and NV24. */
+
+typedef struct zimg_packed_context zimg_packed_context;
+
+/**
+ * Create a context to convert between the 8-bit interleaved format [format] and separate planes.
+ * On error, a NULL pointer is returned.
+ */
+zimg_packed_context *zimg_packed_create(int format);
+
+/* As zimg_packed_create, with the given [options]. */
+zimg_packed_context *zimg_packed_create2(int format, const zimg_create_options *options);
+
+/* Get the number of planes held by the packed format of [ctx]. */
+int zimg_packed_planes(zimg_packed_context *ctx);
+
+/**
+ * Deinterleave a [width] by [height] pixel rectangle of the packed image [src] into the planes [dst].
+ * Calling this on the region of one tile fills the tile buffers passed to the other process functions directly,
+ * avoiding separate full frame passes to split and merge the planes.
+ * For ZIMG_PACKED_UYVY, [width] must be even.
+ *
+ * On success, 0 is returned, else a corresponding error code.
+ */
+int zimg_packed_unpack(zimg_packed_context *ctx, const void *src, int src_stride, void * const dst[], const int dst_stride[], int width, int height);
+
+/* Interleave the planes [src] into the packed image [dst]. See zimg_packed_unpack. */
+int zimg_packed_pack(zimg_packed_context *ctx, const void * const src[], const int src_stride[], void *dst, int dst_stride, int width, int height);
+
+/* Delete the context. */
+void zimg_packed_delete(zimg_packed_context *ctx);
+
+
 
 /**
  * The inline functions below are convenience wrappers that process entire planes.
@@ -276,6 +698,16 @@ static ZIMG_INLINE void _zimg_bit_blt(const void *src, void *dst, int line_size,
 	}
 }
 
+static ZIMG_INLINE void _zimg_zero_fill(void *dst, size_t size)
+{
+	char *dst_b = (char *)dst;
+	size_t i;
+
+	for (i = 0; i < size; ++i) {
+		dst_b[i] = 0;
+	}
+}
+
 static ZIMG_INLINE size_t _zimg_colorspace_plane_tmp_size(zimg_colorspace_context *ctx, int pixel_type)
 {
 	return zimg_colorspace_tmp_size(ctx) * sizeof(float) + 3 * _zimg_tile_size(pixel_type);
@@ -291,19 +723,47 @@ static ZIMG_INLINE void _zimg_colorspace_plane_process(zimg_colorspace_context *
 	int tmp_stride = ZIMG_TILE_WIDTH * pixel_size;
 	size_t tmp_size = _zimg_tile_size(pixel_type);
 
+	int interior_width = width - width % ZIMG_TILE_WIDTH;
+	int interior_height = height - height % ZIMG_TILE_HEIGHT;
 	int i, j;
 
 	src_tiles[0].pixel_type = dst_tiles[0].pixel_type = pixel_type;
 	src_tiles[1].pixel_type = dst_tiles[1].pixel_type = pixel_type;
 	src_tiles[2].pixel_type = dst_tiles[2].pixel_type = pixel_type;
 
+	/* The whole tiles are processed in a single call. */
+	if (interior_width && interior_height) {
+		src_tiles[0].buffer = (void *)src[0];
+		src_tiles[1].buffer = (void *)src[1];
+		src_tiles[2].buffer = (void *)src[2];
+
+		dst_tiles[0].buffer = dst[0];
+		dst_tiles[1].buffer = dst[1];
+		dst_tiles[2].buffer = dst[2];
+
+		src_tiles[0].stride = src_stride[0];
+		src_tiles[1].stride = src_stride[1];
+		src_tiles[2].stride = src_stride[2];
+
+		dst_tiles[0].stride = dst_stride[0];
+		dst_tiles[1].stride = dst_stride[1];
+		dst_tiles[2].stride = dst_stride[2];
+
+		zimg_colorspace_process_tiles(ctx, src_tiles, dst_tiles, tmp, interior_width, interior_height);
+	}
+
 	for (i = 0; i < height; i += ZIMG_TILE_HEIGHT) {
 		for (j = 0; j < width; j += ZIMG_TILE_WIDTH) {
-			int need_copy = i + ZIMG_TILE_HEIGHT > height || j + ZIMG_TILE_WIDTH > width;
-
 			void *src_ptr[3];
 			void *dst_ptr[3];
 
+			int tile_width  = ZIMG_MIN(width - j, ZIMG_TILE_WIDTH);
+			int tile_height = ZIMG_MIN(height - i, ZIMG_TILE_HEIGHT);
+			void *ttmp;
+
+			if (i < interior_height && j < interior_width)
+				continue;
+
 			src_ptr[0] = (char *)src[0] + i * src_stride[0] + j * pixel_size;
 			src_ptr[1] = (char *)src[1] + i * src_stride[1] + j * pixel_size;
 			src_ptr[2] = (char *)src[2] + i * src_stride[2] + j * pixel_size;
@@ -312,48 +772,24 @@ static ZIMG_INLINE void _zimg_colorspace_plane_process(zimg_colorspace_context *
 			dst_ptr[1] = (char *)dst[1] + i * dst_stride[1] + j * pixel_size;
 			dst_ptr[2] = (char *)dst[2] + i * dst_stride[2] + j * pixel_size;
 
-			if (need_copy) {
-				int tile_width  = ZIMG_MIN(width - j, ZIMG_TILE_WIDTH);
-				int tile_height = ZIMG_MIN(height - i, ZIMG_TILE_HEIGHT);
-				void *ttmp;
+			src_tiles[0].buffer = (char *)tmp + 0 * tmp_size;
+			src_tiles[1].buffer = (char *)tmp + 1 * tmp_size;
+			src_tiles[2].buffer = (char *)tmp + 2 * tmp_size;
+			ttmp = (char *)tmp + 3 * tmp_size;
 
-				src_tiles[0].buffer = (char *)tmp + 0 * tmp_size;
-				src_tiles[1].buffer = (char *)tmp + 1 * tmp_size;
-				src_tiles[2].buffer = (char *)tmp + 2 * tmp_size;
-				ttmp = (char *)tmp + 3 * tmp_size;
+			src_tiles[0].stride = tmp_stride;
+			src_tiles[1].stride = tmp_stride;
+			src_tiles[2].stride = tmp_stride;
 
-				src_tiles[0].stride = tmp_stride;
-				src_tiles[1].stride = tmp_stride;
-				src_tiles[2].stride = tmp_stride;
+			_zimg_bit_blt(src_ptr[0], src_tiles[0].buffer, tile_width * pixel_size, tile_height, src_stride[0], tmp_stride);
+			_zimg_bit_blt(src_ptr[1], src_tiles[1].buffer, tile_width * pixel_size, tile_height, src_stride[1], tmp_stride);
+			_zimg_bit_blt(src_ptr[2], src_tiles[2].buffer, tile_width * pixel_size, tile_height, src_stride[2], tmp_stride);
 
-				_zimg_bit_blt(src_ptr[0], src_tiles[0].buffer, tile_width * pixel_size, tile_height, src_stride[0], tmp_stride);
-				_zimg_bit_blt(src_ptr[1], src_tiles[1].buffer, tile_width * pixel_size, tile_height, src_stride[1], tmp_stride);
-				_zimg_bit_blt(src_ptr[2], src_tiles[2].buffer, tile_width * pixel_size, tile_height, src_stride[2], tmp_stride);
+			zimg_colorspace_process_tile(ctx, src_tiles, src_tiles, ttmp, pixel_type);
 
-				zimg_colorspace_process_tile(ctx, src_tiles, src_tiles, ttmp, pixel_type);
-
-				_zimg_bit_blt(src_tiles[0].buffer, dst_ptr[0], tile_width * pixel_size, tile_height, tmp_stride, dst_stride[0]);
-				_zimg_bit_blt(src_tiles[1].buffer, dst_ptr[1], tile_width * pixel_size, tile_height, tmp_stride, dst_stride[1]);
-				_zimg_bit_blt(src_tiles[2].buffer, dst_ptr[2], tile_width * pixel_size, tile_height, tmp_stride, dst_stride[2]);
-			} else {
-				src_tiles[0].buffer = src_ptr[0];
-				src_tiles[1].buffer = src_ptr[1];
-				src_tiles[2].buffer = src_ptr[2];
-
-				dst_tiles[0].buffer = dst_ptr[0];
-				dst_tiles[1].buffer = dst_ptr[1];
-				dst_tiles[2].buffer = dst_ptr[2];
-
-				src_tiles[0].stride = src_stride[0];
-				src_tiles[1].stride = src_stride[1];
-				src_tiles[2].stride = src_stride[2];
-
-				dst_tiles[0].stride = dst_stride[0];
-				dst_tiles[1].stride = dst_stride[1];
-				dst_tiles[2].stride = dst_stride[2];
-
-				zimg_colorspace_process_tile(ctx, src_tiles, dst_tiles, tmp, pixel_type);
-			}
+			_zimg_bit_blt(src_tiles[0].buffer, dst_ptr[0], tile_width * pixel_size, tile_height, tmp_stride, dst_stride[0]);
+			_zimg_bit_blt(src_tiles[1].buffer, dst_ptr[1], tile_width * pixel_size, tile_height, tmp_stride, dst_stride[1]);
+			_zimg_bit_blt(src_tiles[2].buffer, dst_ptr[2], tile_width * pixel_size, tile_height, tmp_stride, dst_stride[2]);
 		}
 	}
 }
@@ -368,9 +804,10 @@ static ZIMG_INLINE size_t _zimg_depth_plane_tmp_size(zimg_depth_context *ctx, in
 	return ret;
 }
 
-static ZIMG_INLINE void _zimg_depth_plane_process(zimg_depth_context *ctx, const void *src, void *dst, void *tmp,
-                                                    int width, int height, int src_stride, int dst_stride,
-                                                    int pixel_in, int pixel_out, int depth_in, int depth_out, int range_in, int range_out, int chroma)
+static ZIMG_INLINE void _zimg_depth_plane_process_seeded(zimg_depth_context *ctx, const void *src, void *dst, void *tmp,
+                                                           int width, int height, int src_stride, int dst_stride,
+                                                           int pixel_in, int pixel_out, int depth_in, int depth_out, int range_in, int range_out, int chroma,
+                                                           unsigned seed)
 {
 	zimg_image_tile_t src_tile;
 	zimg_image_tile_t dst_tile;
@@ -395,53 +832,77 @@ static ZIMG_INLINE void _zimg_depth_plane_process(zimg_depth_context *ctx, const
 		size_t tmp_size_in = _zimg_tile_size(pixel_in);
 		size_t tmp_size_out = _zimg_tile_size(pixel_out);
 
+		int interior_width = width - width % ZIMG_TILE_WIDTH;
+		int interior_height = height - height % ZIMG_TILE_HEIGHT;
 		int i, j;
 
+		/* The whole tiles are processed in a single call. */
+		if (interior_width && interior_height) {
+			src_tile.buffer = (void *)src;
+			dst_tile.buffer = dst;
+
+			src_tile.stride = src_stride;
+			dst_tile.stride = dst_stride;
+
+			src_tile.plane_offset_i = dst_tile.plane_offset_i = 0;
+			src_tile.plane_offset_j = dst_tile.plane_offset_j = 0;
+
+			zimg_depth_process_tiles(ctx, &src_tile, &dst_tile, tmp, interior_width, interior_height, seed);
+		}
+
 		for (i = 0; i < height; i += ZIMG_TILE_HEIGHT) {
 			for (j = 0; j < width; j += ZIMG_TILE_WIDTH) {
-				int need_copy = i + ZIMG_TILE_HEIGHT > height || j + ZIMG_TILE_WIDTH > width;
 				void *src_ptr = (char *)src + i * src_stride + j * pixel_size_in;
 				void *dst_ptr = (char *)dst + i * dst_stride + j * pixel_size_out;
 
-				if (need_copy) {
-					int tile_width = ZIMG_MIN(width - j, ZIMG_TILE_WIDTH);
-					int tile_height = ZIMG_MIN(height - i, ZIMG_TILE_HEIGHT);
-					void *tmp2;
+				int tile_width = ZIMG_MIN(width - j, ZIMG_TILE_WIDTH);
+				int tile_height = ZIMG_MIN(height - i, ZIMG_TILE_HEIGHT);
+				void *tmp2;
 
-					src_tile.buffer = tmp;
-					dst_tile.buffer = (char *)src_tile.buffer + tmp_size_in;
-					tmp2 = (char *)dst_tile.buffer + tmp_size_out;
+				if (i < interior_height && j < interior_width)
+					continue;
 
-					src_tile.stride = tmp_stride_in;
-					dst_tile.stride = tmp_stride_out;
+				src_tile.plane_offset_i = dst_tile.plane_offset_i = i;
+				src_tile.plane_offset_j = dst_tile.plane_offset_j = j;
 
-					_zimg_bit_blt(src_ptr, src_tile.buffer, tile_width * pixel_size_in, tile_height, src_stride, tmp_stride_in);
+				src_tile.buffer = tmp;
+				dst_tile.buffer = (char *)src_tile.buffer + tmp_size_in;
+				tmp2 = (char *)dst_tile.buffer + tmp_size_out;
 
-					zimg_depth_process(ctx, &src_tile, &dst_tile, tmp2);
+				src_tile.stride = tmp_stride_in;
+				dst_tile.stride = tmp_stride_out;
 
-					_zimg_bit_blt(dst_tile.buffer, dst_ptr, tile_width * pixel_size_out, tile_height, tmp_stride_out, dst_stride);
-				} else {
-					src_tile.buffer = src_ptr;
-					dst_tile.buffer = dst_ptr;
+				_zimg_bit_blt(src_ptr, src_tile.buffer, tile_width * pixel_size_in, tile_height, src_stride, tmp_stride_in);
 
-					src_tile.stride = src_stride;
-					dst_tile.stride = dst_stride;
+				zimg_depth_process_seeded(ctx, &src_tile, &dst_tile, tmp2, seed);
 
-					zimg_depth_process(ctx, &src_tile, &dst_tile, tmp);
-				}
+				_zimg_bit_blt(dst_tile.buffer, dst_ptr, tile_width * pixel_size_out, tile_height, tmp_stride_out, dst_stride);
 			}
 		}
 	} else {
 		src_tile.buffer = (void *)src;
 		dst_tile.buffer = dst;
 
+		src_tile.stride = src_stride;
+		dst_tile.stride = dst_stride;
+
+		src_tile.plane_offset_i = dst_tile.plane_offset_i = 0;
+		src_tile.plane_offset_j = dst_tile.plane_offset_j = 0;
 		src_tile.plane_width = dst_tile.plane_width = width;
 		src_tile.plane_height = dst_tile.plane_height = height;
 
-		zimg_depth_process(ctx, &src_tile, &dst_tile, tmp);
+		zimg_depth_process_seeded(ctx, &src_tile, &dst_tile, tmp, seed);
 	}
 }
 
+static ZIMG_INLINE void _zimg_depth_plane_process(zimg_depth_context *ctx, const void *src, void *dst, void *tmp,
+                                                    int width, int height, int src_stride, int dst_stride,
+                                                    int pixel_in, int pixel_out, int depth_in, int depth_out, int range_in, int range_out, int chroma)
+{
+	_zimg_depth_plane_process_seeded(ctx, src, dst, tmp, width, height, src_stride, dst_stride,
+	                                 pixel_in, pixel_out, depth_in, depth_out, range_in, range_out, chroma, 0);
+}
+
 static ZIMG_INLINE size_t _zimg_resize_plane_tmp_size(zimg_resize_context *ctx, int src_width, int src_height, int dst_width, int dst_height, int pixel_type)
 {
 	size_t sz = 0;
@@ -470,75 +931,193 @@ static ZIMG_INLINE size_t _zimg_resize_plane_tmp_size(zimg_resize_context *ctx,
 	return sz;
 }
 
-static ZIMG_INLINE void _zimg_resize_plane_process(zimg_resize_context *ctx, const void *src, void *dst, void *tmp,
-                                                   int src_width, int src_height, int dst_width, int dst_height, int src_stride, int dst_stride, int pixel_type)
+static ZIMG_INLINE void _zimg_resize_plane_process_tile(zimg_resize_context *ctx, const void *src, void *dst, void *tmp,
+                                                        int src_width, int src_height, int dst_width, int dst_height, int src_stride, int dst_stride,
+                                                        int pixel_type, int i, int j)
 {
 	zimg_image_tile_t src_tile;
 	zimg_image_tile_t dst_tile;
-		
+
 	int pixel_size = _zimg_pixel_size(pixel_type);
 	int top, left, bottom, right;
-	int i, j;
+
+	int need_copy_src;
+	int need_copy_dst;
+
+	void *src_ptr;
+	void *dst_ptr;
+	void *ttmp;
 
 	src_tile.pixel_type = dst_tile.pixel_type = pixel_type;
 
-	for (i = 0; i < dst_height; i += ZIMG_TILE_HEIGHT) {
-		for (j = 0; j < dst_width; j += ZIMG_TILE_WIDTH) {
-			int need_copy_src;
-			int need_copy_dst;
+	zimg_resize_dependent_rect(ctx, i, j, i + ZIMG_TILE_HEIGHT, j + ZIMG_TILE_WIDTH, &top, &left, &bottom, &right);
 
-			void *src_ptr;
-			void *dst_ptr;
-			void *ttmp;
+	need_copy_src = bottom > src_height || right + ZIMG_TILE_WIDTH > src_width;
+	need_copy_dst = i + ZIMG_TILE_HEIGHT > dst_height || j + ZIMG_TILE_WIDTH > dst_width;
 
-			zimg_resize_dependent_rect(ctx, i, j, i + ZIMG_TILE_HEIGHT, j + ZIMG_TILE_WIDTH, &top, &left, &bottom, &right);
+	src_ptr = (char *)src + top * src_stride + left * pixel_size;
+	dst_ptr = (char *)dst + i * dst_stride + j * pixel_size;
 
-			need_copy_src = bottom > src_height || right + ZIMG_TILE_WIDTH > src_width;
-			need_copy_dst = i + ZIMG_TILE_HEIGHT > dst_height || j + ZIMG_TILE_WIDTH > dst_width;
+	src_tile.plane_offset_i = top;
+	src_tile.plane_offset_j = left;
+	dst_tile.plane_offset_i = i;
+	dst_tile.plane_offset_j = j;
 
-			src_ptr = (char *)src + top * src_stride + left * pixel_size;
-			dst_ptr = (char *)dst + i * dst_stride + j * pixel_size;
+	ttmp = tmp;
 
-			src_tile.plane_offset_i = top;
-			src_tile.plane_offset_j = left;
-			dst_tile.plane_offset_i = i;
-			dst_tile.plane_offset_j = j;
+	if (need_copy_src) {
+		int tile_width = ZIMG_MIN(right - left, src_width - left);
+		int tile_height = ZIMG_MIN(bottom - top, src_height - top);
 
-			ttmp = tmp;
+		src_tile.buffer = ttmp;
+		src_tile.stride = (right - left + ZIMG_TILE_WIDTH) * pixel_size;
 
-			if (need_copy_src) {
-				int tile_width = ZIMG_MIN(right - left, src_width - left);
-				int tile_height = ZIMG_MIN(bottom - top, src_height - top);
+		if (src_tile.stride % ZIMG_TILE_WIDTH)
+			src_tile.stride += ZIMG_TILE_WIDTH - src_tile.stride % ZIMG_TILE_WIDTH;
 
-				src_tile.buffer = ttmp;
-				src_tile.stride = (right - left + ZIMG_TILE_WIDTH) * pixel_size;
+		/* Pixels past the edge of the plane are read with zero weight, so they must not be left uninitialized. */
+		_zimg_zero_fill(src_tile.buffer, (size_t)src_tile.stride * (bottom - top));
+		_zimg_bit_blt(src_ptr, src_tile.buffer, tile_width * pixel_size, tile_height, src_stride, src_tile.stride);
 
-				if (src_tile.stride % ZIMG_TILE_WIDTH)
-					src_tile.stride += ZIMG_TILE_WIDTH - src_tile.stride % ZIMG_TILE_WIDTH;
+		ttmp = (char *)ttmp + src_tile.stride * (bottom - top);
+	} else {
+		src_tile.buffer = src_ptr;
+		src_tile.stride = src_stride;
+	}
 
-				_zimg_bit_blt(src_ptr, src_tile.buffer, tile_width * pixel_size, tile_height, src_stride, src_tile.stride);
+	if (need_copy_dst) {
+		int tile_width = ZIMG_MIN(dst_width - j, ZIMG_TILE_WIDTH);
+		int tile_height = ZIMG_MIN(dst_height - i, ZIMG_TILE_HEIGHT);
 
-				ttmp = (char *)ttmp + src_tile.stride * (bottom - top);
-			} else {
-				src_tile.buffer = src_ptr;
-				src_tile.stride = src_stride;
-			}
+		dst_tile.buffer = ttmp;
+		dst_tile.stride = ZIMG_TILE_WIDTH * pixel_size;
+
+		zimg_resize_process_tile(ctx, &src_tile, &dst_tile);
+
+		_zimg_bit_blt(dst_tile.buffer, dst_ptr, tile_width * pixel_size, tile_height, dst_tile.stride, dst_stride);
+	} else {
+		dst_tile.buffer = dst_ptr;
+		dst_tile.stride = dst_stride;
+
+		zimg_resize_process_tile(ctx, &src_tile, &dst_tile);
+	}
+}
+
+/* Check if the output tile at [i], [j] can be processed in place, without copying to or from the temporary buffer. */
+static ZIMG_INLINE int _zimg_resize_plane_tile_in_place(zimg_resize_context *ctx, int src_width, int src_height, int dst_width, int dst_height, int i, int j)
+{
+	int top, left, bottom, right;
+
+	if (i + ZIMG_TILE_HEIGHT > dst_height || j + ZIMG_TILE_WIDTH > dst_width)
+		return 0;
+
+	zimg_resize_dependent_rect(ctx, i, j, i + ZIMG_TILE_HEIGHT, j + ZIMG_TILE_WIDTH, &top, &left, &bottom, &right);
+
+	return bottom <= src_height && right + ZIMG_TILE_WIDTH <= src_width;
+}
+
+/* Process the output rectangle of [width] x [height] at [i], [j], which must consist of tiles that can be processed in place. */
+static ZIMG_INLINE void _zimg_resize_plane_process_tiles(zimg_resize_context *ctx, const void *src, void *dst,
+                                                         int src_stride, int dst_stride, int pixel_type, int i, int j, int width, int height)
+{
+	zimg_image_tile_t src_tile;
+	zimg_image_tile_t dst_tile;
+
+	src_tile.pixel_type = dst_tile.pixel_type = pixel_type;
+
+	src_tile.buffer = (void *)src;
+	src_tile.stride = src_stride;
+	src_tile.plane_offset_i = 0;
+	src_tile.plane_offset_j = 0;
+
+	dst_tile.buffer = (char *)dst + i * dst_stride + j * _zimg_pixel_size(pixel_type);
+	dst_tile.stride = dst_stride;
+	dst_tile.plane_offset_i = i;
+	dst_tile.plane_offset_j = j;
+
+	zimg_resize_process_tiles(ctx, &src_tile, &dst_tile, width, height);
+}
+
+static ZIMG_INLINE void _zimg_resize_plane_process(zimg_resize_context *ctx, const void *src, void *dst, void *tmp,
+                                                   int src_width, int src_height, int dst_width, int dst_height, int src_stride, int dst_stride, int pixel_type)
+{
+	int interior_width = 0;
+	int interior_height = 0;
+	int i, j;
 
-			if (need_copy_dst) {
-				int tile_width = ZIMG_MIN(dst_width - j, ZIMG_TILE_WIDTH);
-				int tile_height = ZIMG_MIN(dst_height - i, ZIMG_TILE_HEIGHT);
+	/* The input rows of an output tile depend only on its row, and the input columns only on its column. */
+	while (_zimg_resize_plane_tile_in_place(ctx, src_width, src_height, dst_width, dst_height, interior_height, 0))
+		interior_height += ZIMG_TILE_HEIGHT;
+	while (interior_height && _zimg_resize_plane_tile_in_place(ctx, src_width, src_height, dst_width, dst_height, 0, interior_width))
+		interior_width += ZIMG_TILE_WIDTH;
 
-				dst_tile.buffer = ttmp;
-				dst_tile.stride = ZIMG_TILE_WIDTH * pixel_size;
+	if (interior_width && interior_height)
+		_zimg_resize_plane_process_tiles(ctx, src, dst, src_stride, dst_stride, pixel_type, 0, 0, interior_width, interior_height);
 
-				zimg_resize_process_tile(ctx, &src_tile, &dst_tile);
+	for (i = 0; i < dst_height; i += ZIMG_TILE_HEIGHT) {
+		for (j = 0; j < dst_width; j += ZIMG_TILE_WIDTH) {
+			if (i < interior_height && j < interior_width)
+				continue;
 
-				_zimg_bit_blt(dst_tile.buffer, dst_ptr, tile_width * pixel_size, tile_height, dst_tile.stride, dst_stride);
-			} else {
-				dst_tile.buffer = dst_ptr;
-				dst_tile.stride = dst_stride;
+			_zimg_resize_plane_process_tile(ctx, src, dst, tmp, src_width, src_height, dst_width, dst_height, src_stride, dst_stride, pixel_type, i, j);
+		}
+	}
+}
 
-				zimg_resize_process_tile(ctx, &src_tile, &dst_tile);
+static ZIMG_INLINE size_t _zimg_resize_plane_multi_tmp_size(zimg_resize_context * const ctx[], int n, int src_width, int src_height,
+                                                            const int dst_width[], const int dst_height[], int pixel_type)
+{
+	size_t sz = 0;
+	int k;
+
+	for (k = 0; k < n; ++k) {
+		sz = ZIMG_MAX(sz, _zimg_resize_plane_tmp_size(ctx[k], src_width, src_height, dst_width[k], dst_height[k], pixel_type));
+	}
+
+	return sz;
+}
+
+/**
+ * Apply [n] contexts resizing in the same direction to one source plane, e.g. the first pass of a resolution ladder.
+ * Each strip of 64 rows (horizontal) or 64 columns (vertical) of the source is passed through every context
+ * before advancing, so the source is fetched from memory once rather than once per output.
+ * For horizontal contexts, the outputs must have the height of the source, and for vertical contexts, its width.
+ *
+ * Lower rungs can instead be cascaded from higher ones by passing an earlier output as the source of a later call.
+ */
+static ZIMG_INLINE void _zimg_resize_plane_process_multi(zimg_resize_context * const ctx[], int n, int horizontal, const void *src, void * const dst[], void *tmp,
+                                                         int src_width, int src_height, const int dst_width[], const int dst_height[],
+                                                         int src_stride, const int dst_stride[], int pixel_type)
+{
+	int i, j, k;
+
+	/* Within each strip, the leading run of tiles that can be processed in place is processed in a single call. */
+	if (horizontal) {
+		for (i = 0; i < src_height; i += ZIMG_TILE_HEIGHT) {
+			for (k = 0; k < n; ++k) {
+				j = 0;
+				while (_zimg_resize_plane_tile_in_place(ctx[k], src_width, src_height, dst_width[k], dst_height[k], i, j))
+					j += ZIMG_TILE_WIDTH;
+				if (j)
+					_zimg_resize_plane_process_tiles(ctx[k], src, dst[k], src_stride, dst_stride[k], pixel_type, i, 0, j, ZIMG_TILE_HEIGHT);
+
+				for (; j < dst_width[k]; j += ZIMG_TILE_WIDTH) {
+					_zimg_resize_plane_process_tile(ctx[k], src, dst[k], tmp, src_width, src_height, dst_width[k], dst_height[k], src_stride, dst_stride[k], pixel_type, i, j);
+				}
+			}
+		}
+	} else {
+		for (j = 0; j < src_width; j += ZIMG_TILE_WIDTH) {
+			for (k = 0; k < n; ++k) {
+				i = 0;
+				while (_zimg_resize_plane_tile_in_place(ctx[k], src_width, src_height, dst_width[k], dst_height[k], i, j))
+					i += ZIMG_TILE_HEIGHT;
+				if (i)
+					_zimg_resize_plane_process_tiles(ctx[k], src, dst[k], src_stride, dst_stride[k], pixel_type, 0, j, ZIMG_TILE_WIDTH, i);
+
+				for (; i < dst_height[k]; i += ZIMG_TILE_HEIGHT) {
+					_zimg_resize_plane_process_tile(ctx[k], src, dst[k], tmp, src_width, src_height, dst_width[k], dst_height[k], src_stride, dst_stride[k], pixel_type, i, j);
+				}
 			}
 		}
 	}
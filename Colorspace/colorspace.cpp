@@ -103,5 +103,52 @@ void ColorspaceConversion::process_tile(const ImageTile<const void> src[3], cons
 	store_tile(tmp_ptr[2], dst[2]);
 }
 
+void ColorspaceConversion::process_plane(const ImageTile<const void> src[3], const ImageTile<void> dst[3], int width, int height, void *tmp) const
+{
+	if (src[0].descriptor()->format.type != PixelType::FLOAT || dst[0].descriptor()->format.type != PixelType::FLOAT) {
+		for (int i = 0; i < height; i += TILE_HEIGHT) {
+			for (int j = 0; j < width; j += TILE_WIDTH) {
+				ImageTile<const void> src_tiles[3] = { src[0].sub_tile(i, j), src[1].sub_tile(i, j), src[2].sub_tile(i, j) };
+				ImageTile<void> dst_tiles[3] = { dst[0].sub_tile(i, j), dst[1].sub_tile(i, j), dst[2].sub_tile(i, j) };
+
+				process_tile(src_tiles, dst_tiles, tmp);
+			}
+		}
+		return;
+	}
+
+	int stride[3];
+
+	for (int p = 0; p < 3; ++p) {
+		stride[p] = tile_cast<float>(dst[p]).pixel_stride();
+	}
+
+	// Each strip is converted by every operation before advancing, so that it remains in cache.
+	for (int i = 0; i < height; i += TILE_HEIGHT) {
+		float *ptr[3];
+
+		for (int p = 0; p < 3; ++p) {
+			ImageTile<const float> src_strip = tile_cast<const float>(src[p]).sub_tile(i, 0);
+			ImageTile<float> dst_strip = tile_cast<float>(dst[p]).sub_tile(i, 0);
+
+			if (src_strip.data() != dst_strip.data())
+				copy_image_tile_partial(src_strip, dst_strip, width, TILE_HEIGHT);
+
+			ptr[p] = dst_strip.data();
+		}
+
+		for (const auto &op : m_operations) {
+			op->process_rows(ptr, stride, width, TILE_HEIGHT);
+		}
+	}
+}
+
+void ColorspaceConversion::process_scanline(float * const ptr[3], int width) const
+{
+	for (const auto &op : m_operations) {
+		op->process(ptr, width);
+	}
+}
+
 } // namespace colorspace
 } // namespace zimg
@@ -75,6 +75,27 @@ public:
 	 * @param tmp temporary buffer (@see ColorspaceConversion::tmp_size)
 	 */
 	void process_tile(const ImageTile<const void> src[3], const ImageTile<void> dst[3], void *tmp) const;
+
+	/**
+	 * Process a rectangle of whole tiles. The input and output pixel formats must match.
+	 * Single precision samples are converted in strips of scanlines, applying each operation once per strip.
+	 *
+	 * @param src pointer to three input tiles at the top-left of the rectangle
+	 * @param dst pointer to three output tiles at the top-left of the rectangle, which may be the same as the input tiles
+	 * @param width width of rectangle, a multiple of TILE_WIDTH
+	 * @param height height of rectangle, a multiple of TILE_HEIGHT
+	 * @param tmp temporary buffer (@see ColorspaceConversion::tmp_size)
+	 */
+	void process_plane(const ImageTile<const void> src[3], const ImageTile<void> dst[3], int width, int height, void *tmp) const;
+
+	/**
+	 * Process scanlines of single precision samples in-place.
+	 * This allows converting regions which are not aligned to tiles.
+	 *
+	 * @param ptr pointer to three scanline pointers
+	 * @param width number of samples
+	 */
+	void process_scanline(float * const ptr[3], int width) const;
 };
 
 } // namespace colorspace
@@ -15,6 +15,11 @@ Operation::~Operation()
 {
 }
 
+void Operation::process_rows(float * const ptr[3], const int stride[3], int width, int height) const
+{
+	operation_process_rows(*this, ptr, stride, width, height);
+}
+
 Operation *create_ncl_yuv_to_rgb_operation(MatrixCoefficients matrix, CPUClass cpu)
 {
 	return create_matrix_operation(ncl_yuv_to_rgb_matrix(matrix), cpu);
@@ -29,7 +34,7 @@ Operation *create_gamma_to_linear_operation(TransferCharacteristics transfer, CP
 {
 	switch (transfer) {
 	case TransferCharacteristics::TRANSFER_709:
-		return create_rec709_gamma_operation(cpu);
+		return create_rec709_inverse_gamma_operation(cpu);
 	default:
 		throw ZimgUnsupportedError{ "unsupported transfer function" };
 	}
@@ -39,7 +44,7 @@ Operation *create_linear_to_gamma_operation(TransferCharacteristics transfer, CP
 {
 	switch (transfer) {
 	case TransferCharacteristics::TRANSFER_709:
-		return create_rec709_inverse_gamma_operation(cpu);
+		return create_rec709_gamma_operation(cpu);
 	default:
 		throw ZimgUnsupportedError{ "unsupported transfer function" };
 	}
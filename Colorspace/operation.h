@@ -4,6 +4,7 @@
 #define ZIMG_COLORSPACE_OPERATION_H_
 
 #include <cstdint>
+#include <utility>
 #include "Common/osdep.h"
 
 namespace zimg {;
@@ -62,6 +63,59 @@ public:
 	 * @param width number of samples
 	 */
 	virtual void process(float * const ptr[3], int width) const = 0;
+
+	/**
+	 * Apply operation to a block of scanlines in-place, overwriting the input.
+	 *
+	 * @param ptr pointer to three pointers to the first scanline of each plane
+	 * @param stride pointer to the distance between scanlines of each plane, in samples
+	 * @param width number of samples per scanline
+	 * @param height number of scanlines
+	 */
+	virtual void process_rows(float * const ptr[3], const int stride[3], int width, int height) const;
+};
+
+/**
+ * Apply an operation to a block of scanlines.
+ *
+ * @param op operation, whose Operation::process is called directly if its type is final
+ * @see Operation::process_rows
+ */
+template <class Op>
+void operation_process_rows(const Op &op, float * const ptr[3], const int stride[3], int width, int height)
+{
+	// Contiguous scanlines are processed as a single scanline.
+	if (stride[0] == width && stride[1] == width && stride[2] == width) {
+		op.process(ptr, width * height);
+		return;
+	}
+
+	for (int i = 0; i < height; ++i) {
+		float *row[3] = { ptr[0] + i * stride[0], ptr[1] + i * stride[1], ptr[2] + i * stride[2] };
+		op.process(row, width);
+	}
+}
+
+/**
+ * Helper for concrete operations, providing Operation::process_rows through operation_process_rows,
+ * with Derived::process called once per scanline, or once for the whole block if its scanlines are contiguous.
+ * As for the tile helpers (@see for_each_tile), Derived must be final.
+ *
+ * @param Derived concrete operation
+ * @param Base base class of Derived
+ */
+template <class Derived, class Base = Operation>
+class OperationRows : public Base {
+protected:
+	template <class ...Args>
+	explicit OperationRows(Args &&...args) : Base(std::forward<Args>(args)...)
+	{
+	}
+public:
+	void process_rows(float * const ptr[3], const int stride[3], int width, int height) const override
+	{
+		operation_process_rows(static_cast<const Derived &>(*this), ptr, stride, width, height);
+	}
 };
 
 /**
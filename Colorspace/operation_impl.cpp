@@ -13,9 +13,9 @@ namespace colorspace {;
 
 namespace {;
 
-class MatrixOperationC : public MatrixOperationImpl {
+class MatrixOperationC final : public OperationRows<MatrixOperationC, MatrixOperationImpl> {
 public:
-	explicit MatrixOperationC(const Matrix3x3 &m) : MatrixOperationImpl(m)
+	explicit MatrixOperationC(const Matrix3x3 &m) : OperationRows(m)
 	{}
 
 	void process(float * const ptr[3], int width) const override
@@ -39,7 +39,7 @@ public:
 	}
 };
 
-class Rec709GammaOperationC : public Operation {
+class Rec709GammaOperationC final : public OperationRows<Rec709GammaOperationC> {
 public:
 	void process(float * const ptr[3], int width) const override
 	{
@@ -53,7 +53,7 @@ public:
 	}
 };
 
-class Rec709InverseGammaOperationC : public Operation {
+class Rec709InverseGammaOperationC final : public OperationRows<Rec709InverseGammaOperationC> {
 public:
 	void process(float * const ptr[3], int width) const override
 	{
@@ -67,7 +67,7 @@ public:
 	}
 };
 
-class Rec2020CLToRGBOperationC : public Operation {
+class Rec2020CLToRGBOperationC final : public OperationRows<Rec2020CLToRGBOperationC> {
 public:
 	void process(float * const ptr[3], int width) const override
 	{
@@ -111,7 +111,7 @@ public:
 	}
 };
 
-class Rec2020CLToYUVOperationC : public Operation {
+class Rec2020CLToYUVOperationC final : public OperationRows<Rec2020CLToYUVOperationC> {
 public:
 	void process(float * const ptr[3], int width) const override
 	{
@@ -67,7 +67,7 @@ public:
 	}
 };
 
-class LookupTableOperationAVX2 : public Operation {
+class LookupTableOperationAVX2 final : public OperationRows<LookupTableOperationAVX2> {
 	float m_lut[1L << 16];
 public:
 	template <class Proc>
@@ -103,9 +103,9 @@ public:
 	}
 };
 
-class MatrixOperationAVX2 : public MatrixOperationImpl {
+class MatrixOperationAVX2 final : public OperationRows<MatrixOperationAVX2, MatrixOperationImpl> {
 public:
-	explicit MatrixOperationAVX2(const Matrix3x3 &m) : MatrixOperationImpl(m)
+	explicit MatrixOperationAVX2(const Matrix3x3 &m) : OperationRows(m)
 	{}
 
 	void process(float * const *ptr, int width) const override
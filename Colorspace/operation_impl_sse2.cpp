@@ -12,9 +12,9 @@ namespace colorspace {;
 
 namespace {;
 
-class MatrixOperationSSE2 : public MatrixOperationImpl {
+class MatrixOperationSSE2 final : public OperationRows<MatrixOperationSSE2, MatrixOperationImpl> {
 public:
-	explicit MatrixOperationSSE2(const Matrix3x3 &m) : MatrixOperationImpl(m)
+	explicit MatrixOperationSSE2(const Matrix3x3 &m) : OperationRows(m)
 	{}
 
 	void process(float * const *ptr, int width) const override
@@ -25,6 +25,25 @@ PixelAdapter *create_pixel_adapter_x86(CPUClass cpu)
 	return ret;
 }
 
+PackedAdapter *create_packed_adapter_x86(PackedFormat format, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	PackedAdapter *ret;
+
+	if (cpu == CPUClass::CPU_X86_AUTO) {
+		if (caps.avx2)
+			ret = create_packed_adapter_avx2(format);
+		else
+			ret = nullptr;
+	} else if (cpu >= CPUClass::CPU_X86_AVX2) {
+		ret = create_packed_adapter_avx2(format);
+	} else {
+		ret = nullptr;
+	}
+
+	return ret;
+}
+
 Operation *create_matrix_operation_x86(const Matrix3x3 &m, CPUClass cpu)
 {
 	X86Capabilities caps = query_x86_capabilities();
@@ -12,12 +12,17 @@ enum class CPUClass;
 namespace colorspace {;
 
 class PixelAdapter;
+class PackedAdapter;
 class Operation;
 
+enum class PackedFormat;
+
 struct Matrix3x3;
 
 PixelAdapter *create_pixel_adapter_avx2();
 
+PackedAdapter *create_packed_adapter_avx2(PackedFormat format);
+
 Operation *create_matrix_operation_sse2(const Matrix3x3 &m);
 Operation *create_matrix_operation_avx2(const Matrix3x3 &m);
 
@@ -32,6 +37,15 @@ Operation *create_rec709_inverse_gamma_operation_avx2();
  */
 PixelAdapter *create_pixel_adapter_x86(CPUClass cpu);
 
+/**
+ * Create an appropriate x86 optimized PackedAdapter for the given CPU.
+ *
+ * @param format packed format
+ * @param cpu create adapter for given cpu
+ * @return concrete adapter
+ */
+PackedAdapter *create_packed_adapter_x86(PackedFormat format, CPUClass cpu);
+
 /**
  * Create an appropriate x86 optimized matrix operation for the given CPU.
  *
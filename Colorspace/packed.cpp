@@ -0,0 +1,102 @@
+#include "Common/cpuinfo.h"
+#include "Common/except.h"
+#include "operation_impl_x86.h"
+#include "packed.h"
+
+namespace zimg {;
+namespace colorspace {;
+
+namespace {;
+
+template <int N>
+class PackedAdapterChunkyC : public PackedAdapter {
+public:
+	void unpack(const uint8_t *src, uint8_t * const *dst, int width) const override
+	{
+		for (int j = 0; j < width; ++j) {
+			for (int p = 0; p < N; ++p) {
+				dst[p][j] = src[j * N + p];
+			}
+		}
+	}
+
+	void pack(const uint8_t * const *src, uint8_t *dst, int width) const override
+	{
+		for (int j = 0; j < width; ++j) {
+			for (int p = 0; p < N; ++p) {
+				dst[j * N + p] = src[p][j];
+			}
+		}
+	}
+};
+
+class PackedAdapterUYVYC : public PackedAdapter {
+public:
+	void unpack(const uint8_t *src, uint8_t * const *dst, int width) const override
+	{
+		for (int j = 0; j < width / 2; ++j) {
+			dst[1][j] = src[j * 4 + 0];
+			dst[0][j * 2 + 0] = src[j * 4 + 1];
+			dst[2][j] = src[j * 4 + 2];
+			dst[0][j * 2 + 1] = src[j * 4 + 3];
+		}
+	}
+
+	void pack(const uint8_t * const *src, uint8_t *dst, int width) const override
+	{
+		for (int j = 0; j < width / 2; ++j) {
+			dst[j * 4 + 0] = src[1][j];
+			dst[j * 4 + 1] = src[0][j * 2 + 0];
+			dst[j * 4 + 2] = src[2][j];
+			dst[j * 4 + 3] = src[0][j * 2 + 1];
+		}
+	}
+};
+
+} // namespace
+
+
+int packed_format_planes(PackedFormat format)
+{
+	switch (format) {
+	case PackedFormat::RGB24:
+	case PackedFormat::UYVY:
+		return 3;
+	case PackedFormat::RGBA:
+		return 4;
+	case PackedFormat::NV12:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+PackedAdapter::~PackedAdapter()
+{
+}
+
+PackedAdapter *create_packed_adapter(PackedFormat format, CPUClass cpu)
+{
+	PackedAdapter *ret = nullptr;
+#ifdef ZIMG_X86
+	ret = create_packed_adapter_x86(format, cpu);
+#endif
+	if (ret)
+		return ret;
+
+	switch (format) {
+	case PackedFormat::RGB24:
+		return new PackedAdapterChunkyC<3>{};
+	case PackedFormat::RGBA:
+		return new PackedAdapterChunkyC<4>{};
+	case PackedFormat::UYVY:
+		return new PackedAdapterUYVYC{};
+	case PackedFormat::NV12:
+		return new PackedAdapterChunkyC<2>{};
+	default:
+		throw ZimgIllegalArgument{ "unsupported packed format" };
+	}
+}
+
+} // namespace colorspace
+} // namespace zimg
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef ZIMG_COLORSPACE_PACKED_H_
+#define ZIMG_COLORSPACE_PACKED_H_
+
+#include <cstdint>
+
+namespace zimg {;
+
+enum class CPUClass;
+
+namespace colorspace {;
+
+/**
+ * Enum for supported interleaved 8-bit formats.
+ *
+ * RGB24 = R, G, B
+ * RGBA = R, G, B, A
+ * UYVY = U, Y, V, Y (4:2:2)
+ * NV12 = U, V (interleaved chroma plane of NV12/NV16/NV24)
+ */
+enum class PackedFormat {
+	RGB24,
+	RGBA,
+	UYVY,
+	NV12
+};
+
+/**
+ * Get the number of planes held by a packed format.
+ *
+ * @param format packed format
+ * @return number of planes
+ */
+int packed_format_planes(PackedFormat format);
+
+/**
+ * Base class for implementations of packed format conversion.
+ *
+ * The planes of a scanline are ordered as in the name of the format,
+ * except UYVY, which is unpacked to Y, U, V. For UYVY, the chroma planes have half the width.
+ */
+class PackedAdapter {
+public:
+	/**
+	 * Destroy implementation.
+	 */
+	virtual ~PackedAdapter() = 0;
+
+	/**
+	 * Deinterleave a scanline.
+	 *
+	 * @param src pointer to packed scanline
+	 * @param dst pointers to planar scanlines
+	 * @param width number of pixels, must be even for UYVY
+	 */
+	virtual void unpack(const uint8_t *src, uint8_t * const *dst, int width) const = 0;
+
+	/**
+	 * Interleave a scanline.
+	 *
+	 * @see PackedAdapter::unpack
+	 */
+	virtual void pack(const uint8_t * const *src, uint8_t *dst, int width) const = 0;
+};
+
+/**
+ * Create a concrete packed format adapter.
+ *
+ * @param format packed format
+ * @param cpu create adapter optimized for given cpu
+ * @return concrete adapter
+ * @throws ZimgIllegalArgument on unsupported format
+ */
+PackedAdapter *create_packed_adapter(PackedFormat format, CPUClass cpu);
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_COLORSPACE_PACKED_H_
@@ -0,0 +1,264 @@
+#ifdef ZIMG_X86
+
+#include <immintrin.h>
+#include "Common/osdep.h"
+#include "operation_impl_x86.h"
+#include "packed.h"
+
+namespace zimg {;
+namespace colorspace {;
+
+namespace {;
+
+// Transpose of a 4x4 byte matrix in each lane, converting between RGBA pixels and RRRRGGGGBBBBAAAA.
+inline FORCE_INLINE __m256i shuffle_transpose_4x4()
+{
+	return _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+	                        0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+}
+
+class PackedAdapterRGB24_AVX2 : public PackedAdapter {
+public:
+	void unpack(const uint8_t *src, uint8_t * const *dst, int width) const override
+	{
+		const __m256i shuf = _mm256_setr_epi8(0, 3, 6, 9, 1, 4, 7, 10, 2, 5, 8, 11, -1, -1, -1, -1,
+		                                      0, 3, 6, 9, 1, 4, 7, 10, 2, 5, 8, 11, -1, -1, -1, -1);
+		const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		int j;
+
+		// Each 16-byte load covers 4 pixels and 4 trailing bytes, which must lie within the scanline.
+		for (j = 0; j + 10 <= width; j += 8) {
+			__m128i lo = _mm_loadu_si128((const __m128i *)&src[j * 3 + 0]);
+			__m128i hi = _mm_loadu_si128((const __m128i *)&src[j * 3 + 12]);
+			__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+			__m128i rg, bx;
+
+			x = _mm256_shuffle_epi8(x, shuf);
+			x = _mm256_permutevar8x32_epi32(x, perm);
+
+			rg = _mm256_castsi256_si128(x);
+			bx = _mm256_extracti128_si256(x, 1);
+
+			_mm_storel_epi64((__m128i *)&dst[0][j], rg);
+			_mm_storel_epi64((__m128i *)&dst[1][j], _mm_srli_si128(rg, 8));
+			_mm_storel_epi64((__m128i *)&dst[2][j], bx);
+		}
+		for (; j < width; ++j) {
+			dst[0][j] = src[j * 3 + 0];
+			dst[1][j] = src[j * 3 + 1];
+			dst[2][j] = src[j * 3 + 2];
+		}
+	}
+
+	void pack(const uint8_t * const *src, uint8_t *dst, int width) const override
+	{
+		const __m256i shuf = _mm256_setr_epi8(0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11, -1, -1, -1, -1,
+		                                      0, 4, 8, 1, 5, 9, 2, 6, 10, 3, 7, 11, -1, -1, -1, -1);
+		const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+		int j;
+
+		// The upper half of each lane is written as padding and overwritten by the following store.
+		for (j = 0; j + 10 <= width; j += 8) {
+			__m128i r = _mm_loadl_epi64((const __m128i *)&src[0][j]);
+			__m128i g = _mm_loadl_epi64((const __m128i *)&src[1][j]);
+			__m128i b = _mm_loadl_epi64((const __m128i *)&src[2][j]);
+			__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi64(r, g)), b, 1);
+
+			x = _mm256_permutevar8x32_epi32(x, perm);
+			x = _mm256_shuffle_epi8(x, shuf);
+
+			_mm_storeu_si128((__m128i *)&dst[j * 3 + 0], _mm256_castsi256_si128(x));
+			_mm_storeu_si128((__m128i *)&dst[j * 3 + 12], _mm256_extracti128_si256(x, 1));
+		}
+		for (; j < width; ++j) {
+			dst[j * 3 + 0] = src[0][j];
+			dst[j * 3 + 1] = src[1][j];
+			dst[j * 3 + 2] = src[2][j];
+		}
+	}
+};
+
+class PackedAdapterRGBA_AVX2 : public PackedAdapter {
+public:
+	void unpack(const uint8_t *src, uint8_t * const *dst, int width) const override
+	{
+		const __m256i shuf = shuffle_transpose_4x4();
+		const __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)&src[j * 4]);
+			__m128i rg, ba;
+
+			x = _mm256_shuffle_epi8(x, shuf);
+			x = _mm256_permutevar8x32_epi32(x, perm);
+
+			rg = _mm256_castsi256_si128(x);
+			ba = _mm256_extracti128_si256(x, 1);
+
+			_mm_storel_epi64((__m128i *)&dst[0][j], rg);
+			_mm_storel_epi64((__m128i *)&dst[1][j], _mm_srli_si128(rg, 8));
+			_mm_storel_epi64((__m128i *)&dst[2][j], ba);
+			_mm_storel_epi64((__m128i *)&dst[3][j], _mm_srli_si128(ba, 8));
+		}
+		for (; j < width; ++j) {
+			dst[0][j] = src[j * 4 + 0];
+			dst[1][j] = src[j * 4 + 1];
+			dst[2][j] = src[j * 4 + 2];
+			dst[3][j] = src[j * 4 + 3];
+		}
+	}
+
+	void pack(const uint8_t * const *src, uint8_t *dst, int width) const override
+	{
+		const __m256i shuf = shuffle_transpose_4x4();
+		const __m256i perm = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m128i r = _mm_loadl_epi64((const __m128i *)&src[0][j]);
+			__m128i g = _mm_loadl_epi64((const __m128i *)&src[1][j]);
+			__m128i b = _mm_loadl_epi64((const __m128i *)&src[2][j]);
+			__m128i a = _mm_loadl_epi64((const __m128i *)&src[3][j]);
+			__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi64(r, g)), _mm_unpacklo_epi64(b, a), 1);
+
+			x = _mm256_permutevar8x32_epi32(x, perm);
+			x = _mm256_shuffle_epi8(x, shuf);
+
+			_mm256_storeu_si256((__m256i *)&dst[j * 4], x);
+		}
+		for (; j < width; ++j) {
+			dst[j * 4 + 0] = src[0][j];
+			dst[j * 4 + 1] = src[1][j];
+			dst[j * 4 + 2] = src[2][j];
+			dst[j * 4 + 3] = src[3][j];
+		}
+	}
+};
+
+class PackedAdapterUYVY_AVX2 : public PackedAdapter {
+public:
+	void unpack(const uint8_t *src, uint8_t * const *dst, int width) const override
+	{
+		const __m256i shuf = _mm256_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14,
+		                                      1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14);
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)&src[j * 2]);
+			__m128i uv;
+
+			x = _mm256_shuffle_epi8(x, shuf);
+			x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+
+			uv = _mm256_extracti128_si256(x, 1);
+			uv = _mm_shuffle_epi32(uv, _MM_SHUFFLE(3, 1, 2, 0));
+
+			_mm_storeu_si128((__m128i *)&dst[0][j], _mm256_castsi256_si128(x));
+			_mm_storel_epi64((__m128i *)&dst[1][j / 2], uv);
+			_mm_storel_epi64((__m128i *)&dst[2][j / 2], _mm_srli_si128(uv, 8));
+		}
+		for (; j < width; j += 2) {
+			dst[1][j / 2] = src[j * 2 + 0];
+			dst[0][j + 0] = src[j * 2 + 1];
+			dst[2][j / 2] = src[j * 2 + 2];
+			dst[0][j + 1] = src[j * 2 + 3];
+		}
+	}
+
+	void pack(const uint8_t * const *src, uint8_t *dst, int width) const override
+	{
+		const __m256i shuf = _mm256_setr_epi8(8, 0, 12, 1, 9, 2, 13, 3, 10, 4, 14, 5, 11, 6, 15, 7,
+		                                      8, 0, 12, 1, 9, 2, 13, 3, 10, 4, 14, 5, 11, 6, 15, 7);
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m128i y = _mm_loadu_si128((const __m128i *)&src[0][j]);
+			__m128i u = _mm_loadl_epi64((const __m128i *)&src[1][j / 2]);
+			__m128i v = _mm_loadl_epi64((const __m128i *)&src[2][j / 2]);
+			__m128i uv = _mm_shuffle_epi32(_mm_unpacklo_epi64(u, v), _MM_SHUFFLE(3, 1, 2, 0));
+			__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(y), uv, 1);
+
+			x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+			x = _mm256_shuffle_epi8(x, shuf);
+
+			_mm256_storeu_si256((__m256i *)&dst[j * 2], x);
+		}
+		for (; j < width; j += 2) {
+			dst[j * 2 + 0] = src[1][j / 2];
+			dst[j * 2 + 1] = src[0][j + 0];
+			dst[j * 2 + 2] = src[2][j / 2];
+			dst[j * 2 + 3] = src[0][j + 1];
+		}
+	}
+};
+
+class PackedAdapterNV12_AVX2 : public PackedAdapter {
+public:
+	void unpack(const uint8_t *src, uint8_t * const *dst, int width) const override
+	{
+		const __m256i shuf = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+		                                      0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)&src[j * 2]);
+
+			x = _mm256_shuffle_epi8(x, shuf);
+			x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+
+			_mm_storeu_si128((__m128i *)&dst[0][j], _mm256_castsi256_si128(x));
+			_mm_storeu_si128((__m128i *)&dst[1][j], _mm256_extracti128_si256(x, 1));
+		}
+		for (; j < width; ++j) {
+			dst[0][j] = src[j * 2 + 0];
+			dst[1][j] = src[j * 2 + 1];
+		}
+	}
+
+	void pack(const uint8_t * const *src, uint8_t *dst, int width) const override
+	{
+		const __m256i shuf = _mm256_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15,
+		                                      0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m128i u = _mm_loadu_si128((const __m128i *)&src[0][j]);
+			__m128i v = _mm_loadu_si128((const __m128i *)&src[1][j]);
+			__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(u), v, 1);
+
+			x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+			x = _mm256_shuffle_epi8(x, shuf);
+
+			_mm256_storeu_si256((__m256i *)&dst[j * 2], x);
+		}
+		for (; j < width; ++j) {
+			dst[j * 2 + 0] = src[0][j];
+			dst[j * 2 + 1] = src[1][j];
+		}
+	}
+};
+
+} // namespace
+
+
+PackedAdapter *create_packed_adapter_avx2(PackedFormat format)
+{
+	switch (format) {
+	case PackedFormat::RGB24:
+		return new PackedAdapterRGB24_AVX2{};
+	case PackedFormat::RGBA:
+		return new PackedAdapterRGBA_AVX2{};
+	case PackedFormat::UYVY:
+		return new PackedAdapterUYVY_AVX2{};
+	case PackedFormat::NV12:
+		return new PackedAdapterNV12_AVX2{};
+	default:
+		return nullptr;
+	}
+}
+
+} // namespace colorspace
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -3,6 +3,7 @@
 #ifndef ZIMG_ALIGN_H_
 #define ZIMG_ALIGN_H_
 
+#include <atomic>
 #include <vector>
 
 #ifdef _WIN32
@@ -36,6 +37,44 @@ inline T ceil_n(T x, U n) { return x % n ? x + n - (x % n) : x; }
 template <class T, class U>
 inline T floor_n(T x, U n) { return x - (x % n); }
 
+/**
+ * Memory allocation functions used for aligned buffers.
+ * The default functions use the system aligned allocator.
+ */
+struct AllocatorHooks {
+	/** Allocate size bytes aligned to alignment, returning nullptr on failure. */
+	void *(*alloc)(void *user, size_t size, size_t alignment);
+	/** Free a pointer returned by alloc. */
+	void (*free)(void *user, void *ptr);
+	/** User data passed to alloc and free. */
+	void *user;
+};
+
+inline void *default_aligned_alloc(void *, size_t size, size_t alignment) { return zimg_aligned_malloc(size, (int)alignment); }
+inline void default_aligned_free(void *, void *ptr) { zimg_aligned_free(ptr); }
+
+/**
+ * Get the allocator hooks in use. Modifying them while any buffer is allocated is undefined.
+ *
+ * @return reference to hooks
+ */
+inline AllocatorHooks &allocator_hooks()
+{
+	static AllocatorHooks hooks{ default_aligned_alloc, default_aligned_free, nullptr };
+	return hooks;
+}
+
+/**
+ * Get the number of buffers allocated through the hooks and not yet freed.
+ *
+ * @return reference to counter
+ */
+inline std::atomic<long> &allocator_outstanding()
+{
+	static std::atomic<long> count{ 0 };
+	return count;
+}
+
 /**
  * Helper struct that computes alignment in units of object count.
  *
@@ -57,15 +96,22 @@ struct AlignedAllocator {
 
 	T *allocate(size_t n) const
 	{
-		T *ptr = (T *)zimg_aligned_malloc(n * sizeof(T), ALIGNMENT);
+		const AllocatorHooks &hooks = allocator_hooks();
+		T *ptr = (T *)hooks.alloc(hooks.user, n * sizeof(T), ALIGNMENT);
 
 		if (!ptr)
 			throw std::bad_alloc{};
 
+		++allocator_outstanding();
 		return ptr;
 	}
 
-	void deallocate(void *ptr, size_t) const { zimg_aligned_free(ptr); }
+	void deallocate(void *ptr, size_t) const
+	{
+		const AllocatorHooks &hooks = allocator_hooks();
+		hooks.free(hooks.user, ptr);
+		--allocator_outstanding();
+	}
 
 	bool operator==(const AlignedAllocator &) const { return true; }
 
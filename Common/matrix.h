@@ -216,8 +216,9 @@ inline RowMatrix<T> transpose(const RowMatrix<T> &r)
 {
 	RowMatrix<T> m{ r.cols(), r.rows() };
 
+	// Only the stored range of each row can be non-zero.
 	for (size_t i = 0; i < r.rows(); ++i) {
-		for (size_t j = 0; j < r.cols(); ++j) {
+		for (size_t j = r.row_left(i); j < r.row_right(i); ++j) {
 			m[j][i] = r[i][j];
 		}
 	}
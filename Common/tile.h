@@ -216,6 +216,29 @@ inline void copy_image_tile(const ImageTile<const T> &src, const ImageTile<T> &d
 	copy_image_tile_partial(src, dst, TILE_WIDTH, TILE_HEIGHT);
 }
 
+/**
+ * Apply a function to each tile of a rectangle consisting of whole tiles.
+ *
+ * @param src input tile at the top-left of the rectangle
+ * @param dst output tile at the top-left of the rectangle
+ * @param width width of rectangle, a multiple of TILE_WIDTH
+ * @param height height of rectangle, a multiple of TILE_HEIGHT
+ * Rectangle helpers of the concrete implementations (ResizeImplPlane, DepthConvertPlane, DitherConvertPlane)
+ * are templates on the implementation type, which must be final. The tile functions called by func are then
+ * bound statically and can be inlined into the loop, instead of being dispatched virtually for every tile.
+ *
+ * @param func func(src_tile, dst_tile, i, j), where i and j are the offset of the tile in the rectangle
+ */
+template <class T, class U, class Func>
+inline void for_each_tile(const ImageTile<T> &src, const ImageTile<U> &dst, int width, int height, Func func)
+{
+	for (int i = 0; i < height; i += TILE_HEIGHT) {
+		for (int j = 0; j < width; j += TILE_WIDTH) {
+			func(src.sub_tile(i, j), dst.sub_tile(i, j), i, j);
+		}
+	}
+}
+
 } // namespace zimg
 
 #endif // ZIMG_TILE_H_
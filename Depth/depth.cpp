@@ -6,104 +6,17 @@
 #include "depth.h"
 #include "depth_convert.h"
 #include "dither.h"
+#include "error_diffusion.h"
+#include "quantize.h"
 
 namespace zimg {;
 namespace depth {;
 
-namespace {;
-
-void convert_dithered(const DitherConvert &dither, const ImageTile<const void> &src, const ImageTile<void> &dst, void *tmp)
-{
-	PixelType src_type = src.descriptor()->format.type;
-	PixelType dst_type = dst.descriptor()->format.type;
-	float *tmp_f = (float *)tmp;
-
-	if (dst_type == PixelType::BYTE) {
-		ImageTile<uint8_t> dst_b = tile_cast<uint8_t>(dst);
-
-		switch (src_type) {
-		case PixelType::BYTE:
-			dither.byte_to_byte(tile_cast<const uint8_t>(src), dst_b, tmp_f);
-			break;
-		case PixelType::WORD:
-			dither.word_to_byte(tile_cast<const uint16_t>(src), dst_b, tmp_f);
-			break;
-		case PixelType::HALF:
-			dither.half_to_byte(tile_cast<const uint16_t>(src), dst_b, tmp_f);
-			break;
-		case PixelType::FLOAT:
-			dither.float_to_byte(tile_cast<const float>(src), dst_b, tmp_f);
-			break;
-		}
-	} else if (dst_type == PixelType::WORD) {
-		ImageTile<uint16_t> dst_w = tile_cast<uint16_t>(dst);
-
-		switch (src_type) {
-		case PixelType::BYTE:
-			dither.byte_to_word(tile_cast<const uint8_t>(src), dst_w, tmp_f);
-			break;
-		case PixelType::WORD:
-			dither.word_to_word(tile_cast<const uint16_t>(src), dst_w, tmp_f);
-			break;
-		case PixelType::HALF:
-			dither.half_to_word(tile_cast<const uint16_t>(src), dst_w, tmp_f);
-			break;
-		case PixelType::FLOAT:
-			dither.float_to_word(tile_cast<const float>(src), dst_w, tmp_f);
-			break;
-		}
-	}
-}
-
-void convert_depth(const DepthConvert &depth, const ImageTile<const void> &src, const ImageTile<void> &dst)
-{
-	PixelType src_type = src.descriptor()->format.type;
-	PixelType dst_type = dst.descriptor()->format.type;
-
-	if (dst_type == PixelType::HALF) {
-		ImageTile<uint16_t> dst_w = tile_cast<uint16_t>(dst);
-
-		switch (src_type) {
-		case PixelType::BYTE:
-			depth.byte_to_half(tile_cast<const uint8_t>(src), dst_w);
-			break;
-		case PixelType::WORD:
-			depth.word_to_half(tile_cast<const uint16_t>(src), dst_w);
-			break;
-		case PixelType::HALF:
-			copy_image_tile(tile_cast<const uint16_t>(src), dst_w);
-			break;
-		case PixelType::FLOAT:
-			depth.float_to_half(tile_cast<const float>(src), dst_w);
-			break;
-		}
-	} else if (dst_type == PixelType::FLOAT) {
-		ImageTile<float> dst_f = tile_cast<float>(dst);
-
-		switch (src_type) {
-		case PixelType::BYTE:
-			depth.byte_to_float(tile_cast<const uint8_t>(src), dst_f);
-			break;
-		case PixelType::WORD:
-			depth.word_to_float(tile_cast<const uint16_t>(src), dst_f);
-			break;
-		case PixelType::HALF:
-			depth.half_to_float(tile_cast<const uint16_t>(src), dst_f);
-			break;
-		case PixelType::FLOAT:
-			copy_image_tile(tile_cast<const float>(src), dst_f);
-			break;
-		}
-	}
-}
-
-} // namespace
-
-
 Depth::Depth(DitherType type, CPUClass cpu) try :
 	m_depth{ create_depth_convert(cpu) },
 	m_dither{ create_dither_convert(type, cpu) },
-	m_error_diffusion{ type == DitherType::DITHER_ERROR_DIFFUSION }
+	m_dither_none{ type == DitherType::DITHER_NONE },
+	m_error_diffusion{ is_error_diffusion(type) }
 {
 }
 catch (const std::bad_alloc &)
@@ -118,15 +31,32 @@ bool Depth::tile_supported(PixelType src_type, PixelType dst_type) const
 
 size_t Depth::tmp_size(int width) const
 {
-	return m_error_diffusion ? ((size_t)width + 2) * 2 : 0;
+	return m_error_diffusion ? ((size_t)width + 2) * 4 : m_dither->tile_tmp_size();
 }
 
 void Depth::process_tile(const ImageTile<const void> &src, const ImageTile<void> &dst, void *tmp) const
 {
-	if (dst.descriptor()->format.type >= PixelType::HALF)
-		convert_depth(*m_depth, src, dst);
+	process_tile(src, dst, 0, 0, 0, tmp);
+}
+
+void Depth::process_tile(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, uint32_t seed, void *tmp) const
+{
+	// If the conversion can not be tiled, the implementation treats the single tile as the whole plane.
+	process_plane(src, dst, i, j, TILE_WIDTH, TILE_HEIGHT, seed, tmp);
+}
+
+void Depth::process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, void *tmp) const
+{
+	const PixelFormat &src_format = src.descriptor()->format;
+	const PixelFormat &dst_format = dst.descriptor()->format;
+	IntegerConversionParams params;
+
+	if (dst_format.type >= PixelType::HALF)
+		m_depth->process_plane(src, dst, width, height, nullptr);
+	else if (m_dither_none && src_format.type < PixelType::HALF && get_integer_conversion_params(src_format, dst_format, &params))
+		m_depth->process_plane(src, dst, width, height, &params);
 	else
-		convert_dithered(*m_dither, src, dst, tmp);
+		m_dither->process_plane(src, dst, i, j, width, height, seed, static_cast<float *>(tmp));
 }
 
 } // namespace depth
@@ -4,6 +4,7 @@
 #define ZIMG_DEPTH_DEPTH_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace zimg {;
@@ -26,7 +27,11 @@ enum class DitherType {
 	DITHER_NONE,
 	DITHER_ORDERED,
 	DITHER_RANDOM,
-	DITHER_ERROR_DIFFUSION
+	DITHER_ERROR_DIFFUSION,
+	DITHER_BLUE_NOISE,
+	DITHER_SIERRA_LITE,
+	DITHER_ERROR_DIFFUSION_ROW,
+	DITHER_ERROR_DIFFUSION_SERPENTINE
 };
 
 /**
@@ -37,6 +42,7 @@ enum class DitherType {
 class Depth {
 	std::shared_ptr<DepthConvert> m_depth;
 	std::shared_ptr<DitherConvert> m_dither;
+	bool m_dither_none;
 	bool m_error_diffusion;
 public:
 	/**
@@ -81,6 +87,36 @@ public:
 	 * @see Depth::tile_supported
 	 */
 	void process_tile(const ImageTile<const void> &src, const ImageTile<void> &dst, void *tmp) const;
+
+	/**
+	 * Process a tile at a given position in a given frame.
+	 * Dithers which vary over time or position, such as DITHER_RANDOM, are evaluated at the given coordinates.
+	 *
+	 * @param src input tile
+	 * @param dst output tile
+	 * @param i row index of tile in plane
+	 * @param j column index of tile in plane
+	 * @param seed per-frame seed
+	 * @param tmp temporary buffer (@see Depth::tmp_size)
+	 * @see Depth::process_tile
+	 */
+	void process_tile(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, uint32_t seed, void *tmp) const;
+
+	/**
+	 * Process a rectangle of whole tiles at a given position in a given frame, selecting the conversion once for the whole rectangle.
+	 * Only conversions which can be applied on tiles are supported.
+	 *
+	 * @param src input tile at the top-left of the rectangle
+	 * @param dst output tile at the top-left of the rectangle
+	 * @param i row index of rectangle in plane
+	 * @param j column index of rectangle in plane
+	 * @param width width of rectangle, a multiple of TILE_WIDTH
+	 * @param height height of rectangle, a multiple of TILE_HEIGHT
+	 * @param seed per-frame seed
+	 * @param tmp temporary buffer (@see Depth::tmp_size)
+	 * @see Depth::process_tile
+	 */
+	void process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, void *tmp) const;
 };
 
 } // namespace depth
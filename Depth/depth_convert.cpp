@@ -10,7 +10,7 @@ namespace depth {;
 
 namespace {;
 
-class DepthConvertC : public DepthConvert {
+class DepthConvertC final : public DepthConvertPlane<DepthConvertC> {
 	template <class T, class U, class Proc>
 	void process_tile(const ImageTile<const T> &src, const ImageTile<U> &dst, Proc proc) const
 	{
@@ -43,6 +43,26 @@ public:
 		process_tile<uint16_t, float>(src, dst, make_integer_to_float<uint16_t>(src.descriptor()->format));
 	}
 
+	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const override
+	{
+		process_tile(src, dst, IntegerToInteger<uint8_t, uint8_t>{ params });
+	}
+
+	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const override
+	{
+		process_tile(src, dst, IntegerToInteger<uint8_t, uint16_t>{ params });
+	}
+
+	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const override
+	{
+		process_tile(src, dst, IntegerToInteger<uint16_t, uint8_t>{ params });
+	}
+
+	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const override
+	{
+		process_tile(src, dst, IntegerToInteger<uint16_t, uint16_t>{ params });
+	}
+
 	void half_to_float(const ImageTile<const uint16_t> &src, const ImageTile<float> &dst) const override
 	{
 		process_tile(src, dst, depth::half_to_float);
@@ -61,6 +81,11 @@ DepthConvert::~DepthConvert()
 {
 }
 
+void DepthConvert::process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int width, int height, const IntegerConversionParams *params) const
+{
+	depth_convert_plane(*this, src, dst, width, height, params);
+}
+
 DepthConvert *create_depth_convert(CPUClass cpu)
 {
 	DepthConvert *ret = nullptr;
@@ -4,16 +4,18 @@
 #define ZIMG_DEPTH_DEPTH_CONVERSION_H_
 
 #include <cstdint>
+#include <utility>
+#include "Common/pixel.h"
+#include "Common/tile.h"
 
 namespace zimg {;
 
 enum class CPUClass;
 
-template <class T>
-class ImageTile;
-
 namespace depth {;
 
+struct IntegerConversionParams;
+
 /**
  * Base class for non-dithering conversions.
  */
@@ -53,6 +55,36 @@ public:
 	 */
 	virtual void word_to_float(const ImageTile<const uint16_t> &src, const ImageTile<float> &dst) const = 0;
 
+	/**
+	 * Convert from byte to byte without intermediate floating point.
+	 *
+	 * @param src input tile
+	 * @param dst output tile
+	 * @param params fixed-point parameters (@see get_integer_conversion_params)
+	 */
+	virtual void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const = 0;
+
+	/**
+	 * Convert from byte to word without intermediate floating point.
+	 *
+	 * @see DepthConvert::byte_to_byte
+	 */
+	virtual void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const = 0;
+
+	/**
+	 * Convert from word to byte without intermediate floating point.
+	 *
+	 * @see DepthConvert::byte_to_byte
+	 */
+	virtual void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const = 0;
+
+	/**
+	 * Convert from word to word without intermediate floating point.
+	 *
+	 * @see DepthConvert::byte_to_byte
+	 */
+	virtual void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const = 0;
+
 	/**
 	 * Convert from half precision to full precision.
 	 *
@@ -68,6 +100,100 @@ public:
 	 * @see DepthConvert::half_to_float
 	 */
 	virtual void float_to_half(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst) const = 0;
+
+	/**
+	 * Convert a rectangle of whole tiles, selecting the conversion once for the whole rectangle.
+	 *
+	 * @param src input tile at the top-left of the rectangle
+	 * @param dst output tile at the top-left of the rectangle
+	 * @param width width of rectangle, a multiple of TILE_WIDTH
+	 * @param height height of rectangle, a multiple of TILE_HEIGHT
+	 * @param params fixed-point parameters to convert between integers without floating point, or nullptr
+	 */
+	virtual void process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int width, int height, const IntegerConversionParams *params) const;
+};
+
+/**
+ * Convert a rectangle of whole tiles by calling the tile functions of a DepthConvert.
+ *
+ * @param cvt implementation, whose tile functions are called directly if its type is final
+ * @see DepthConvert::process_plane
+ */
+template <class Convert>
+void depth_convert_plane(const Convert &cvt, const ImageTile<const void> &src, const ImageTile<void> &dst, int width, int height, const IntegerConversionParams *params)
+{
+	typedef ImageTile<const uint8_t> src_byte;
+	typedef ImageTile<const uint16_t> src_word;
+	typedef ImageTile<const float> src_float;
+	typedef ImageTile<uint8_t> dst_byte;
+	typedef ImageTile<uint16_t> dst_word;
+	typedef ImageTile<float> dst_float;
+
+	PixelType src_type = src.descriptor()->format.type;
+	PixelType dst_type = dst.descriptor()->format.type;
+
+	if (params) {
+		const IntegerConversionParams &p = *params;
+
+		if (src_type == PixelType::BYTE && dst_type == PixelType::BYTE)
+			for_each_tile(tile_cast<const uint8_t>(src), tile_cast<uint8_t>(dst), width, height, [&](const src_byte &s, const dst_byte &d, int, int) { cvt.byte_to_byte(s, d, p); });
+		else if (src_type == PixelType::BYTE && dst_type == PixelType::WORD)
+			for_each_tile(tile_cast<const uint8_t>(src), tile_cast<uint16_t>(dst), width, height, [&](const src_byte &s, const dst_word &d, int, int) { cvt.byte_to_word(s, d, p); });
+		else if (src_type == PixelType::WORD && dst_type == PixelType::BYTE)
+			for_each_tile(tile_cast<const uint16_t>(src), tile_cast<uint8_t>(dst), width, height, [&](const src_word &s, const dst_byte &d, int, int) { cvt.word_to_byte(s, d, p); });
+		else
+			for_each_tile(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), width, height, [&](const src_word &s, const dst_word &d, int, int) { cvt.word_to_word(s, d, p); });
+	} else if (dst_type == PixelType::HALF) {
+		switch (src_type) {
+		case PixelType::BYTE:
+			for_each_tile(tile_cast<const uint8_t>(src), tile_cast<uint16_t>(dst), width, height, [&](const src_byte &s, const dst_word &d, int, int) { cvt.byte_to_half(s, d); });
+			break;
+		case PixelType::WORD:
+			for_each_tile(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), width, height, [&](const src_word &s, const dst_word &d, int, int) { cvt.word_to_half(s, d); });
+			break;
+		case PixelType::HALF:
+			for_each_tile(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), width, height, [&](const src_word &s, const dst_word &d, int, int) { copy_image_tile(s, d); });
+			break;
+		case PixelType::FLOAT:
+			for_each_tile(tile_cast<const float>(src), tile_cast<uint16_t>(dst), width, height, [&](const src_float &s, const dst_word &d, int, int) { cvt.float_to_half(s, d); });
+			break;
+		}
+	} else if (dst_type == PixelType::FLOAT) {
+		switch (src_type) {
+		case PixelType::BYTE:
+			for_each_tile(tile_cast<const uint8_t>(src), tile_cast<float>(dst), width, height, [&](const src_byte &s, const dst_float &d, int, int) { cvt.byte_to_float(s, d); });
+			break;
+		case PixelType::WORD:
+			for_each_tile(tile_cast<const uint16_t>(src), tile_cast<float>(dst), width, height, [&](const src_word &s, const dst_float &d, int, int) { cvt.word_to_float(s, d); });
+			break;
+		case PixelType::HALF:
+			for_each_tile(tile_cast<const uint16_t>(src), tile_cast<float>(dst), width, height, [&](const src_word &s, const dst_float &d, int, int) { cvt.half_to_float(s, d); });
+			break;
+		case PixelType::FLOAT:
+			for_each_tile(tile_cast<const float>(src), tile_cast<float>(dst), width, height, [&](const src_float &s, const dst_float &d, int, int) { copy_image_tile(s, d); });
+			break;
+		}
+	}
+}
+
+/**
+ * Helper for concrete implementations, providing DepthConvert::process_plane through depth_convert_plane (@see for_each_tile).
+ *
+ * @param Derived concrete implementation
+ * @param Base base class of Derived
+ */
+template <class Derived, class Base = DepthConvert>
+class DepthConvertPlane : public Base {
+protected:
+	template <class ...Args>
+	explicit DepthConvertPlane(Args &&...args) : Base(std::forward<Args>(args)...)
+	{
+	}
+public:
+	void process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int width, int height, const IntegerConversionParams *params) const override
+	{
+		depth_convert_plane(static_cast<const Derived &>(*this), src, dst, width, height, params);
+	}
 };
 
 /**
@@ -1,6 +1,7 @@
 #ifdef ZIMG_X86
 
 #include <immintrin.h>
+#include "Common/osdep.h"
 #include "Common/tile.h"
 #include "depth_convert.h"
 #include "depth_convert_x86.h"
@@ -12,7 +13,41 @@ namespace depth {;
 
 namespace {;
 
-class DepthConvertAVX2 : public DepthConvertX86 {
+inline FORCE_INLINE __m256i load_16(const uint8_t *ptr)
+{
+	return _mm256_cvtepu8_epi16(_mm_load_si128((const __m128i *)ptr));
+}
+
+inline FORCE_INLINE __m256i load_16(const uint16_t *ptr)
+{
+	return _mm256_load_si256((const __m256i *)ptr);
+}
+
+inline FORCE_INLINE void store_16(uint8_t *ptr, __m256i x)
+{
+	_mm_store_si128((__m128i *)ptr, _mm_packus_epi16(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1)));
+}
+
+inline FORCE_INLINE void store_16(uint16_t *ptr, __m256i x)
+{
+	_mm256_store_si256((__m256i *)ptr, x);
+}
+
+class DepthConvertAVX2 final : public DepthConvertPlane<DepthConvertAVX2, DepthConvertX86> {
+	template <class T, class U>
+	void integer_to_integer(const ImageTile<const T> &src, const ImageTile<U> &dst, const IntegerConversionParams &params) const
+	{
+		IntegerToIntegerAVX2 cvt{ params };
+
+		for (int i = 0; i < TILE_HEIGHT; ++i) {
+			const T *src_ptr = src[i];
+			U *dst_ptr = dst[i];
+
+			for (int j = 0; j < TILE_WIDTH; j += 16) {
+				store_16(&dst_ptr[j], cvt(load_16(&src_ptr[j])));
+			}
+		}
+	}
 public:
 	void byte_to_half(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst) const override
 	{
@@ -50,6 +85,26 @@ public:
 		process<uint16_t, float>(src, dst, UnpackWordAVX2{}, PackFloatAVX2{}, cvt_avx2, cvt);
 	}
 
+	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
+	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
+	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
+	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
 	void half_to_float(const ImageTile<const uint16_t> &src, const ImageTile<float> &dst) const override
 	{
 		process(src, dst, UnpackHalfAVX2{}, PackFloatAVX2{}, half_to_float_avx2, depth::half_to_float);
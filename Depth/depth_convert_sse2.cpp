@@ -1,6 +1,7 @@
 #ifdef ZIMG_X86
 
 #include <emmintrin.h>
+#include "Common/osdep.h"
 #include "Common/tile.h"
 #include "depth_convert.h"
 #include "depth_convert_x86.h"
@@ -12,7 +13,49 @@ namespace depth {;
 
 namespace {;
 
-class DepthConvertSSE2 : public DepthConvertX86 {
+inline FORCE_INLINE void load_16(const uint8_t *ptr, __m128i &lo, __m128i &hi)
+{
+	__m128i x = _mm_load_si128((const __m128i *)ptr);
+
+	lo = _mm_unpacklo_epi8(x, _mm_setzero_si128());
+	hi = _mm_unpackhi_epi8(x, _mm_setzero_si128());
+}
+
+inline FORCE_INLINE void load_16(const uint16_t *ptr, __m128i &lo, __m128i &hi)
+{
+	lo = _mm_load_si128((const __m128i *)ptr);
+	hi = _mm_load_si128((const __m128i *)(ptr + 8));
+}
+
+inline FORCE_INLINE void store_16(uint8_t *ptr, __m128i lo, __m128i hi)
+{
+	_mm_store_si128((__m128i *)ptr, _mm_packus_epi16(lo, hi));
+}
+
+inline FORCE_INLINE void store_16(uint16_t *ptr, __m128i lo, __m128i hi)
+{
+	_mm_store_si128((__m128i *)ptr, lo);
+	_mm_store_si128((__m128i *)(ptr + 8), hi);
+}
+
+class DepthConvertSSE2 final : public DepthConvertPlane<DepthConvertSSE2, DepthConvertX86> {
+	template <class T, class U>
+	void integer_to_integer(const ImageTile<const T> &src, const ImageTile<U> &dst, const IntegerConversionParams &params) const
+	{
+		IntegerToIntegerSSE2 cvt{ params };
+
+		for (int i = 0; i < TILE_HEIGHT; ++i) {
+			const T *src_ptr = src[i];
+			U *dst_ptr = dst[i];
+
+			for (int j = 0; j < TILE_WIDTH; j += 16) {
+				__m128i lo, hi;
+
+				load_16(&src_ptr[j], lo, hi);
+				store_16(&dst_ptr[j], cvt(lo), cvt(hi));
+			}
+		}
+	}
 public:
 	void byte_to_half(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst) const override
 	{
@@ -50,6 +93,26 @@ public:
 		process(src, dst, UnpackWordSSE2{}, PackFloatSSE2{}, cvt_sse2, cvt);
 	}
 
+	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
+	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
+	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
+	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, const IntegerConversionParams &params) const override
+	{
+		integer_to_integer(src, dst, params);
+	}
+
 	void half_to_float(const ImageTile<const uint16_t> &src, const ImageTile<float> &dst) const override
 	{
 		process<uint16_t, float>(src, dst, UnpackWordSSE2{}, PackFloatSSE2{}, half_to_float_sse2, depth::half_to_float);
@@ -14,15 +14,33 @@ DitherConvert::~DitherConvert()
 {
 }
 
+size_t DitherConvert::tile_tmp_size() const
+{
+	return 0;
+}
+
+void DitherConvert::prepare_tile(float *tmp, uint32_t seed, int i, int j) const
+{
+}
+
+void DitherConvert::process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, float *tmp) const
+{
+	dither_convert_plane(*this, src, dst, i, j, width, height, seed, tmp);
+}
+
 DitherConvert *create_dither_convert(DitherType type, CPUClass cpu)
 {
 	switch (type) {
 	case DitherType::DITHER_NONE:
 	case DitherType::DITHER_ORDERED:
 	case DitherType::DITHER_RANDOM:
+	case DitherType::DITHER_BLUE_NOISE:
 		return create_ordered_dither(type, cpu);
 	case DitherType::DITHER_ERROR_DIFFUSION:
-		return create_error_diffusion(cpu);
+	case DitherType::DITHER_SIERRA_LITE:
+	case DitherType::DITHER_ERROR_DIFFUSION_ROW:
+	case DitherType::DITHER_ERROR_DIFFUSION_SERPENTINE:
+		return create_error_diffusion(type, cpu);
 	default:
 		throw ZimgIllegalArgument{ "unrecognized dither type" };
 	}
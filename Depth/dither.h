@@ -3,15 +3,16 @@
 #ifndef ZIMG_DEPTH_DITHER_H_
 #define ZIMG_DEPTH_DITHER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <utility>
+#include "Common/pixel.h"
+#include "Common/tile.h"
 
 namespace zimg {;
 
 enum class CPUClass;
 
-template <class T>
-class ImageTile;
-
 namespace depth {;
 
 enum class DitherType;
@@ -26,6 +27,24 @@ public:
 	 */
 	virtual ~DitherConvert() = 0;
 
+	/**
+	 * Get the size of the temporary buffer prepared by DitherConvert::prepare_tile.
+	 *
+	 * @return the size of the temporary buffer in units of floats
+	 */
+	virtual size_t tile_tmp_size() const;
+
+	/**
+	 * Prepare the temporary buffer for the tile at the given position and frame.
+	 * Must be called before converting each tile if DitherConvert::tile_tmp_size is non-zero.
+	 *
+	 * @param tmp temporary buffer
+	 * @param seed per-frame seed
+	 * @param i row index of tile in plane
+	 * @param j column index of tile in plane
+	 */
+	virtual void prepare_tile(float *tmp, uint32_t seed, int i, int j) const;
+
 	/**
 	 * Convert from byte to byte.
 	 *
@@ -83,6 +102,109 @@ public:
 	 * @see DitherConvert::byte_to_byte
 	 */
 	virtual void float_to_word(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst, float *tmp) const = 0;
+
+	/**
+	 * Convert a rectangle of whole tiles, selecting the conversion once for the whole rectangle.
+	 * Each tile is prepared by DitherConvert::prepare_tile before it is converted.
+	 *
+	 * @param src input tile at the top-left of the rectangle
+	 * @param dst output tile at the top-left of the rectangle
+	 * @param i row index of rectangle in plane
+	 * @param j column index of rectangle in plane
+	 * @param width width of rectangle, a multiple of TILE_WIDTH
+	 * @param height height of rectangle, a multiple of TILE_HEIGHT
+	 * @param seed per-frame seed
+	 * @param tmp temporary buffer (implementation defined size)
+	 */
+	virtual void process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, float *tmp) const;
+};
+
+/**
+ * Convert a rectangle of whole tiles, preparing the dither of each tile before converting it.
+ *
+ * @param func func(src_tile, dst_tile, tmp), calling a tile function of cvt
+ * @see dither_convert_plane
+ */
+template <class T, class U, class Convert, class Func>
+void dither_convert_tiles(const Convert &cvt, const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, float *tmp, Func func)
+{
+	for_each_tile(tile_cast<const T>(src), tile_cast<U>(dst), width, height, [&](const ImageTile<const T> &s, const ImageTile<U> &d, int ii, int jj)
+	{
+		cvt.prepare_tile(tmp, seed, i + ii, j + jj);
+		func(s, d, tmp);
+	});
+}
+
+/**
+ * Convert a rectangle of whole tiles by calling the tile functions of a DitherConvert.
+ *
+ * @param cvt implementation, whose tile functions are called directly if its type is final
+ * @see DitherConvert::process_plane
+ */
+template <class Convert>
+void dither_convert_plane(const Convert &cvt, const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, float *tmp)
+{
+	typedef ImageTile<const uint8_t> src_byte;
+	typedef ImageTile<const uint16_t> src_word;
+	typedef ImageTile<const float> src_float;
+	typedef ImageTile<uint8_t> dst_byte;
+	typedef ImageTile<uint16_t> dst_word;
+
+	PixelType src_type = src.descriptor()->format.type;
+	PixelType dst_type = dst.descriptor()->format.type;
+
+	if (dst_type == PixelType::BYTE) {
+		switch (src_type) {
+		case PixelType::BYTE:
+			dither_convert_tiles<uint8_t, uint8_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_byte &s, const dst_byte &d, float *t) { cvt.byte_to_byte(s, d, t); });
+			break;
+		case PixelType::WORD:
+			dither_convert_tiles<uint16_t, uint8_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_word &s, const dst_byte &d, float *t) { cvt.word_to_byte(s, d, t); });
+			break;
+		case PixelType::HALF:
+			dither_convert_tiles<uint16_t, uint8_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_word &s, const dst_byte &d, float *t) { cvt.half_to_byte(s, d, t); });
+			break;
+		case PixelType::FLOAT:
+			dither_convert_tiles<float, uint8_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_float &s, const dst_byte &d, float *t) { cvt.float_to_byte(s, d, t); });
+			break;
+		}
+	} else if (dst_type == PixelType::WORD) {
+		switch (src_type) {
+		case PixelType::BYTE:
+			dither_convert_tiles<uint8_t, uint16_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_byte &s, const dst_word &d, float *t) { cvt.byte_to_word(s, d, t); });
+			break;
+		case PixelType::WORD:
+			dither_convert_tiles<uint16_t, uint16_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_word &s, const dst_word &d, float *t) { cvt.word_to_word(s, d, t); });
+			break;
+		case PixelType::HALF:
+			dither_convert_tiles<uint16_t, uint16_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_word &s, const dst_word &d, float *t) { cvt.half_to_word(s, d, t); });
+			break;
+		case PixelType::FLOAT:
+			dither_convert_tiles<float, uint16_t>(cvt, src, dst, i, j, width, height, seed, tmp, [&](const src_float &s, const dst_word &d, float *t) { cvt.float_to_word(s, d, t); });
+			break;
+		}
+	}
+}
+
+/**
+ * Helper for concrete implementations, providing DitherConvert::process_plane through dither_convert_plane,
+ * which prepares the dither of each tile before converting it (@see for_each_tile).
+ *
+ * @param Derived concrete implementation
+ * @param Base base class of Derived
+ */
+template <class Derived, class Base = DitherConvert>
+class DitherConvertPlane : public Base {
+protected:
+	template <class ...Args>
+	explicit DitherConvertPlane(Args &&...args) : Base(std::forward<Args>(args)...)
+	{
+	}
+public:
+	void process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j, int width, int height, uint32_t seed, float *tmp) const override
+	{
+		dither_convert_plane(static_cast<const Derived &>(*this), src, dst, i, j, width, height, seed, tmp);
+	}
 };
 
 /**
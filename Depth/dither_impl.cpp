@@ -1,6 +1,5 @@
 #include <algorithm>
 #include <cmath>
-#include <random>
 #include <utility>
 #include <vector>
 #include "Common/align.h"
@@ -29,6 +28,269 @@ static const unsigned short ORDERED_DITHERS[64] = {
 
 static const int ORDERED_DITHERS_SCALE = 65;
 
+// 64x64 blue noise threshold matrix, holding each rank in 0-4095 once.
+// Generated by the void-and-cluster method (Ulichney) with a toroidal Gaussian of sigma 1.5.
+static const unsigned short BLUE_NOISE_DITHERS[64 * 64] = {
+	3668, 2440, 3433, 2762, 2238, 1895,  613, 2283,  927, 1287, 2199, 3061, 1935, 3573, 2386,  360,
+	3111,  675, 1131, 2091, 3557, 3066, 1007, 2224, 1341, 2983,  510,  908, 2436,  420, 3952, 2771,
+	3644, 2193, 1109, 3301, 2352, 3115, 3904,  751, 1224, 3409, 2317, 1091, 3221, 2439,  928, 2979,
+	 443, 3556, 1074,  166, 3421,  838, 1606, 2420,  654, 3835, 2907,   58, 2423, 1424, 3868,  150,
+	1052, 3124, 1806,  498, 1213, 3592, 3118, 1414, 3451,  258, 2800, 1534,  832,   23, 1452, 2886,
+	2177, 1591, 3374, 2763,  444, 1799, 2579, 3436,  789, 2080, 3725, 1475, 3425, 3068,  739, 1907,
+	  40, 3031,  487, 1751,  160,  967, 2868, 2176, 2581, 3720,  584, 2007, 1505,  182, 2680, 1343,
+	1791, 2128, 2798, 3748, 2262, 2862, 4094, 1153, 2700, 1676, 1261, 2146, 3533,  414, 2691, 1995,
+	2857,  289, 1374, 3970, 2974,  170, 1663, 3918, 2446, 1837, 3687,  536, 3941, 2752, 3366,  976,
+	3999,  105, 2460,  899, 3891, 1242,   61, 4086,  383, 3224, 2535,  107, 1113, 1737, 2645, 1312,
+	3802,  896, 2573, 4080, 2012, 3586, 1313, 1872,   22,  951, 2772, 3084, 3776,  760, 3455, 4057,
+	  54, 3275,  787, 1677, 1227,  511, 2081,  262, 3572, 3179,  490, 3980, 1773,  791, 3269, 1630,
+	 677, 3777, 2108,  735, 2336,  994, 2787,  408,  768, 3006, 1103, 2531, 2168, 1272, 1958,  556,
+	1778, 3605, 1385, 1975, 3144, 2324, 1520, 2834, 1850, 1060, 1659, 2870, 4026, 2186,  277, 3309,
+	2358, 1540, 3435, 1247,  667, 2699,  454, 3989, 3241, 1706, 1346,  376, 2356, 1692, 2102, 1044,
+	3065, 1451, 3922,  291, 2503, 3363, 3050, 1429,  854, 1923, 2562,  958, 3060, 2496, 1179, 3509,
+	2390, 1587, 3188, 2658, 3565, 1876, 3383, 2144, 1274, 3338,  155, 1638, 3476,  282, 3726, 2665,
+	3199,  803, 2950,  241,  635, 3587,  847, 3329, 2400, 3785,  697, 2053,  521, 3504,  926, 2931,
+	 578, 2033,  219, 3143, 2383, 3462, 1571, 2951,  682, 2453, 3879, 3402, 1133, 2902,  269, 2553,
+	 665, 2302, 2715, 1936, 3601,  933, 1768, 3856, 2315,  121, 3386, 1545,  284, 3734, 2064,   42,
+	2805, 1011,  377, 1265,  254, 1460,  659, 3827, 2696, 1951, 4082,  618, 3121,  860, 2404, 1168,
+	 358, 2212, 2524, 3791, 1741, 2733, 2136,  483, 1368,  161, 3441, 3027, 1326, 2413, 1576, 3735,
+	1184, 3948, 2750, 1662, 1018,   98, 2194, 1111, 3651, 2084,  225, 1917,  651, 3822, 3337, 1567,
+	3630, 1157,  469, 3129, 1340,   24, 2760,  583, 2940, 3685, 1166, 2853, 2269,  606, 1437, 4016,
+	1807, 3302, 3703, 2051, 4039, 3070, 2364,  115, 1526,  906, 2273, 2731, 1858, 1420, 3010, 3919,
+	1623, 3416, 1264,  914, 3219,  331, 1193, 3974, 2878, 1616, 2602, 1010, 3873,  127, 2688, 1903,
+	 353, 2319,  825, 3670, 1914, 3808, 2633,  316, 1445, 2871,  986, 3148, 2705, 1369, 1988,  404,
+	3011, 1808, 3803,  754, 2253, 4028, 2458, 1108, 1592, 2022,  688, 3887, 1846, 3420, 3021,  867,
+	2185,  600, 2473, 1693,  876, 2754, 1165, 3660, 3259,  318, 3576, 1192, 3839,   57, 2124,  676,
+	1982,  175, 4012, 2106, 1528, 3698, 2490, 1922,  919, 3608, 2017,  361, 1810, 3146,  684, 3577,
+	3270, 2854, 1396,  432, 2922,  646, 3130, 1700, 3432,  537, 3977, 1644,   73, 2344,  929, 3932,
+	2179,   94, 2859, 1523, 3372, 1886,  426, 3591, 3237,  364, 2662, 1329,  157, 1036, 2640,  413,
+	3467, 1142, 2988,   70, 3429, 2170,  424, 1871, 2551, 2977, 1684,  427, 3281, 2590, 3482, 1069,
+	2792, 3081,  593, 2663,    9, 3014,  671, 3308,  234, 3079,  723, 2455, 3399, 1408, 2256,  965,
+	1703,   16, 2110, 3397, 2412, 1256, 3961,  834, 2515, 2138, 1202, 2589, 3756, 3213,  540, 2778,
+	1280, 3318, 1019, 2544,  209, 1195, 3092, 2154,  937, 3990, 2299, 3095, 3561, 2418, 1643, 3845,
+	 174, 2739, 1477, 3916,  623, 1521, 3812,  817, 1283, 2113,  733, 2384,  925, 1506,  503, 2301,
+	3588, 1403, 1852, 3637, 1152, 2303, 1760, 1398, 3823, 2158, 1508, 4064, 1130, 2796,  405, 3894,
+	1276, 3089, 4054,  879, 1568,  228, 2223, 1840, 3619,  168, 3351,  711, 1854, 1139, 3540, 1583,
+	2426,  669, 3624, 2044, 3902, 1709,  620, 2790, 1401,   79, 1664,  720, 2059,  333, 3173, 1334,
+	1869, 3681, 2131, 1004, 3242, 2448, 2890, 3344,   15, 3995, 3127, 3706, 1959, 3067, 4034, 1735,
+	 232,  923, 2437, 3277,  744, 3893,  452, 2556, 1028, 2758,  526, 2993,   66, 3634, 1887, 2641,
+	2361,  633, 1805, 2672, 3648, 3215, 2827,  421, 1332, 3071, 1561, 2279,  374, 2985, 2117,  153,
+	4044, 1847,  311, 2815,  887, 3440, 2517, 3755, 1890, 3367, 2912, 3708, 1259, 4070,  900, 2295,
+	3286,  819,  287, 2657, 1800,  197, 1075, 1992, 1626, 2676,  325, 1350, 2747,  112, 1164, 2536,
+	3731, 3145,  416, 1575, 2801, 1961, 3464, 3116,  132, 3669, 1897,  890, 2178, 1600,  729, 3430,
+	 278, 3548, 1149,  145, 2005,  728, 1096, 3759, 2608,  909, 4090, 2849, 3659, 1434,  737, 3255,
+	2643, 1191, 3174, 1456, 2353,  409, 1317,  222,  788, 2441, 1017,  428, 1836, 2499, 2967,  563,
+	2606, 1657, 3807, 3038, 1345, 4067, 2287, 3695,  608, 3479, 1054, 1796,  630, 3431, 2066,  756,
+	2908, 1258, 2160, 4072,  106, 1338,  873, 2174, 1690, 1212, 3364, 2610, 3909, 3194, 1082, 2941,
+	1502, 2181, 3054, 3799, 1411, 2450, 3312, 1668, 2120,  542, 1981,    7, 1000, 2518, 3775, 1712,
+	 941, 2172, 3847,  638, 3057, 2010, 3982, 2867, 2107, 3580, 1558, 2749, 3294,   10, 1490, 3593,
+	 366, 1250, 2240,  496, 3475,  853,  388, 3082, 1425, 2476, 2135, 3921, 2954, 2363, 3857, 1589,
+	 476, 1838, 3324, 1002, 2636, 3664, 2936,  328, 3985, 2339,  431, 1419,  191, 2425,  481, 2025,
+	4001,  848, 2508,  569, 2901,  396, 3966,  156, 3034, 3445, 1305, 2679, 3404, 1940,  250, 2964,
+	 493, 3505,  188, 1761, 3615,  930, 1648, 3211, 1163,  306, 3957,  680, 2157, 3805, 1084, 2079,
+	4013, 3162,  910, 2521, 1960, 2811, 1699, 2584,  936,  152, 3172,  422, 1513, 1026,  190, 3266,
+	2737, 3806,  230, 2306, 1767,  557, 2403, 1430, 3260,  685, 3013, 3610, 1828, 1230, 3761, 2767,
+	  72, 1318, 1878, 3280, 1619, 2248,  990, 1382, 2389,  815, 3907, 1634,  508, 1251, 2406, 3929,
+	1489, 2785, 2456, 1216, 2729,   30, 2534,  544, 3456, 1765, 3019, 1234, 2618, 1730,  792, 2904,
+	 129, 1867, 3398, 1441,   43, 3650, 1182, 3295, 3976, 1879, 3523, 2684,  796, 3647, 1927, 1208,
+	2409,  851, 1461, 3578, 3046,  946, 3843, 1883, 1037, 2585, 2055,  916, 2713, 3388,  687, 1742,
+	3180, 3567,  337, 3890,  777, 3529, 2783, 1816, 3684,  336, 2939, 2230, 3209, 3621,  698, 2112,
+	1031, 3341,  766, 2074, 3244, 3767, 1443, 2159, 2708,  902, 2330,  201, 3423,  485, 3568, 2443,
+	1574, 2741,  598, 3951, 3002,  708, 2067,  248, 2270,  695, 1237, 1681, 2286, 3137, 2642,  621,
+	3459, 2076, 2865,  363, 1325, 3342,  194, 2789, 3498,   31, 1608, 4033,  273, 2145, 1381, 2568,
+	 984, 2227, 2725, 1092, 2034,   47, 3197,  581, 2646, 1150, 1870,  126,  949, 2735, 1610, 3099,
+	 103, 1845, 4011,  393, 1595,  605, 1042, 4095,  146, 3606, 1919, 3881, 1436, 3108, 1971, 1214,
+	 849, 3597, 2173, 1102, 2343, 1603, 3863, 2955, 1486, 3751, 2806,   75, 4087,  378, 1360, 3871,
+	  19, 1628, 3986,  736, 2580, 2169, 1670,  652, 2264, 3745, 1187, 3222,  614, 3030, 3673,  210,
+	3944,  550, 1530, 3085, 2512, 1294, 4015, 2202, 1499, 3368, 3850, 2592, 1416, 4021,  340, 2452,
+	3723, 1327, 2976, 2337, 3539, 3097, 2487, 1708, 3171, 1347,  512, 2847,  765, 2528,  354, 3854,
+	2924,  419, 1749,  204, 3251, 2669,  410, 1009, 2489,  513, 1949, 3379, 1127, 2134, 1731, 2813,
+	2294, 1122, 3133, 1938, 3682, 1067, 4047, 3094, 1370,  475, 2872, 2325, 1888, 1134, 2379, 1621,
+	2980, 1933, 3494,  242, 3737, 1734,  957,  286, 3087,  858,  478, 2086, 3285,  599, 1931, 3449,
+	 746, 2660,  236, 1162,  829, 1991,  329, 2894,  753, 2393, 3289, 1661, 2105, 1088, 3377, 2271,
+	1373, 3310, 2463, 3719, 1354,  778, 3468, 1848, 3186, 3629,  886, 3041, 2548,  580, 3521,  901,
+	3330,  538, 2468,  163, 1572,  435, 2714,  875, 1993, 3354, 1682,  830, 3875,  402, 3378,  725,
+	2525, 1243,  898, 2167,  672, 3327, 2930, 1932, 3747, 2387, 1705, 3646, 1027, 2338, 2914, 1114,
+	1541, 2166, 3819, 1743, 2825, 3931, 1277, 3693, 2056, 1151, 3741,   36, 4040, 2710,  217, 1801,
+	3903,  952, 2779,  575, 1997, 3818, 2250, 1413,  307, 1260, 2323,  227, 1433, 3733, 2966,  260,
+	1904, 3789, 1344, 3499, 2875, 3288, 2281,  108, 3888, 2454,  305, 3536, 2563, 1524, 2063, 3826,
+	  21, 3276, 4081, 2819, 1349, 2327,  527, 2577, 1226,   78, 2892, 1339,  252, 3132, 1740,   26,
+	3683, 3056,  437, 3320, 2457,   59, 1622,  570, 3438,  310, 2617,  903, 3015, 1307, 3653,  690,
+	2035,   62, 1536, 3156, 1135, 2863,  104, 2634, 4018, 2841, 1650, 3864, 1893,  992, 2242, 1570,
+	2637, 3024,  831, 2111,  573, 1106, 1831, 3519, 1522, 1006, 2799, 1288,  120, 3218,  974, 2764,
+	1428, 2314,  389, 1631, 3526,  113, 3938, 1577, 3413,  749, 4056, 2542, 3458,  780, 3955, 2623,
+	 622, 1868,  996, 1397,  724, 3500, 2297, 2745, 1782, 3073, 2214, 1555, 1976,  447, 2421, 3077,
+	2616, 3543, 2300, 4066,  368, 1685, 3346,  940, 1910,  501, 3232,  732, 3437, 2743,  441, 4035,
+	1204,  180, 1795, 3956, 2493, 3690, 1323, 2648,  615, 3152, 1970, 4059, 1764, 2910,  494, 3582,
+	1859,  855, 3109, 1999, 1057, 2694, 1853,  969, 2970, 2260, 1803,  482, 2014, 1439, 2203, 1183,
+	3547, 2342, 2751, 4030, 2095, 3090, 1073, 3882,  783, 1361, 3958,  602, 3262, 3518, 1640, 1043,
+	 531, 1267, 1818,  811, 2537, 3661,  644, 2206, 3528, 1154, 2565, 2115,   99, 1319, 3181,  773,
+	3463, 2309, 3296, 1484,   52,  801, 2917,  285, 2162, 3736,  425,  865, 3370, 2252, 1215, 2464,
+	 261, 3784, 2605,  637, 3848, 3193,  590, 3655,  332, 1468, 3191, 1087, 2839, 3721,  308, 3303,
+	1525,  370, 3176,  136, 1772,  506, 1531,  214, 2523, 3353,  101, 2820, 1143, 2268,  200, 3983,
+	2791, 3371,  240, 3008, 2028, 1285, 3220, 1488, 2883,  176, 3946, 1533, 2438, 3794, 2037, 1714,
+	2571,  562, 1040, 2730, 3159, 1973, 3862, 3348, 1720, 1186, 2346, 2682, 1438,  673, 3953, 3007,
+	1566, 3393, 1223, 2191,  202, 1410, 2391, 1989, 2650, 3554,  681, 3908,  109, 2399,  947, 2937,
+	2047,  845, 3691, 1141, 2554, 3788, 2852, 3538, 2123,  988, 1834, 2431, 3816,  790, 2947, 1934,
+	 885, 2349, 3727, 1085, 3913,   14, 2424,  438, 3732, 1798,  807, 3136,  515,  963, 2972,  293,
+	3831, 1393, 3559,  359, 2255, 1602,  989, 2401,  692, 2877, 3545,  406, 3773, 2125,   97, 1909,
+	 934,  448, 2858, 1746, 3515, 3001, 1090, 3993,    2, 1220, 1921, 2516, 1527, 3123, 1839,  558,
+	3979, 2614, 1665, 2237, 3395,  857, 1929, 1206,  453, 2989, 3589, 1284,  303, 1580, 3674, 1342,
+	3261, 1727, 1450,  601, 2765, 1777, 2971, 1068, 2087, 2673, 1253, 3520, 2822, 1627, 3635, 1175,
+	2190, 2848, 1900, 4074,  649, 3272,  223, 1383, 4008,   67, 1529, 1889, 3163, 1140, 2667, 3598,
+	3200, 2376, 3897,  774, 2552,  439, 1674,  795, 3042, 2195, 3349,  442, 3512, 1199, 3658, 2296,
+	1348,  220, 3049,  612, 1384,  309, 3287, 2360, 3924, 1639,  641, 2639, 1985, 3101, 2218,   71,
+	3833,  423, 2575, 3553, 2211,  842, 3403, 4045,  653, 3271,  237, 1874, 2245,   35, 2526,  701,
+	3238,  203,  874, 2461, 1207, 2835, 3714, 2559, 3047, 2072, 3382,  962,  276, 2911, 1649,  502,
+	1364, 2043,   56, 1543, 3713, 2130, 3419, 2717, 3752, 1444,  911, 2855, 1781,  763,  165, 2895,
+	3352, 1030, 3571, 1849, 4069, 2677, 1582,  678, 2773,  149, 3254, 4004,  907, 3486,  591, 2720,
+	 828, 2978, 1990,  271, 3225, 1336,  185, 1647, 2341, 1421, 3686,  931, 4023, 1335, 3392, 2016,
+	3936, 1501, 3096, 1721, 3385, 2003,  524, 1695, 1115,  742, 2494, 3947, 2261, 3688,  782, 2513,
+	4058, 1101, 3339, 2984,  961, 1291,  159, 1855,  514, 2497,  213, 4091, 2259, 2707, 3849, 1482,
+	1965,  489, 2776, 2348,   33, 3139, 1045, 3739, 2013, 1394, 2288, 1739,  394, 2444, 1172, 1860,
+	2200, 1304, 3705, 1021, 1691, 2505, 3618, 2744,  461, 2949, 2082, 2587,  666, 3004,  440, 1652,
+	1053, 2594,  547, 3754,   28,  943, 2293, 3466,  255, 3234, 1427,  518, 1744, 1225, 3080, 2165,
+	 244, 2712, 1817,  375, 2472, 4027, 3153, 2312, 1125, 3485, 1596, 3175, 1104,  344, 2137,  883,
+	2550, 3935, 1210,  775, 3645, 1754, 2522,  292, 3365,  752, 3028, 1072, 3758, 2842, 1514, 4092,
+	 119, 3331,  648, 2794, 3992,  572, 2046,  824, 3870, 1136,  349, 3336, 1723, 2371, 3677, 2770,
+	 125, 3510, 2266, 1269, 2748, 3981, 1407, 2622, 3814, 2171, 2831, 3507, 2629,   25, 3362, 1493,
+	3707,  709, 3493, 2215,  625, 2781, 1494,  764, 3821, 2909, 2071,  597, 3640, 1722, 3216, 3544,
+	  89, 1687, 3198, 2085, 1352,  554, 2149, 2885, 1249, 3885, 2574,    6, 2058, 3361,  330, 3114,
+	2692, 1579, 2419, 1898,  164, 3026, 1194, 3359, 1856, 3113, 1459, 3790,  148, 1246,  922, 2198,
+	3187, 1821,  840, 3036, 1926,  369, 3106,  691, 1815, 1241,  352,  915, 2049, 3838,  617, 1924,
+	1033, 3000, 1588, 1255, 3590, 1928,  275, 3313, 1775,   64,  935, 2578, 1388, 2838,  522, 1279,
+	2948, 2274,  385, 3422, 2807, 3971,  932, 3506, 1842,  477, 1625, 3566, 1282,  699, 2357, 1013,
+	3517,  458, 3796, 1076, 3426, 2236, 1546, 2607,   41, 2395,  772, 2756, 1994, 3245, 3872,  656,
+	1422, 4048,  281, 3600, 1511, 2449, 1059, 3631,   83, 2982, 4093, 1598, 3037, 1178, 2474, 2888,
+	 418, 2367, 3905,  167, 3055,  997, 3930, 2647, 1293, 2385, 3120, 3899,  224, 2291, 4010, 1998,
+	 707, 3801, 1061, 1637,  208, 2307, 1554,   96, 3206, 2354,  877, 3151, 2671, 1660, 3730, 1948,
+	 805, 2265, 2897, 1415,  731, 3896,  400, 3633, 1058, 4078, 1617, 3470,  516, 2520, 1788,  343,
+	2898, 2109, 1181, 2659,  604, 3846, 2148, 1636, 3345, 1968, 2433,  663, 3672,  280, 1736, 3949,
+	3396, 2042,  868, 2620, 1718, 2375,  463, 2041,  670, 3749, 1542, 1944,  762, 3332, 1025, 2591,
+	1467, 3138, 2664, 3652,  794, 3040, 3782, 2697, 1119, 3997, 1950,  274, 3855,  480, 2869, 1372,
+	3950, 1789,   82, 3214, 2541, 1829, 2818,  689, 2122, 2963,  334, 2254,  977, 1404, 3074, 3550,
+	2482,  781, 3384, 1794, 3212,  184, 2845,  740, 2586,  491, 1079, 3387, 2188, 2732,  813, 1423,
+	  86, 1217, 3273,  571, 3769, 1268, 3110, 3564, 2816,  345, 1100, 3546, 2786, 1780,  367, 3478,
+	 124, 1832,  471, 2392, 1955, 1170,  395, 2077,  700, 2925, 1466, 2478, 1146, 2183, 3322,  259,
+	3005, 1176, 3442, 2097,  321, 1003, 3154, 1442, 3333, 1787, 1239, 3622, 2873, 3967,    8, 1110,
+	1611, 3853,  123, 2263,  905, 1454, 3535, 1233, 3939, 1500, 2896,  205, 1371, 3210, 2011, 3632,
+	2558, 1804, 2905, 2103, 3391,   27, 1597,  822, 1813, 3253, 2549,  142, 2233, 1189, 2932, 3867,
+	2142,  956, 4076, 1363, 3207, 3558, 2538, 1504, 3704,  154, 3501,  643, 3104, 1752,  971, 2567,
+	 525, 2414,  837, 4000, 1624, 3596, 2328,  207, 3925,  574, 2612,  226, 1892,  785, 2350, 2031,
+	 539, 2734, 1308, 2956, 4014, 2492, 2036,  313, 3166, 2129, 3562, 1851, 3972,  991,  350, 2969,
+	 683, 4065,  302, 1402,  884, 2742, 2311, 4025, 1196, 2141,  619, 3973, 1449, 3240,  507, 1614,
+	2434, 3389, 2774,  674,   44, 1750,  871, 3290, 2282, 1236, 2630, 2057, 4050,   60, 3750, 1497,
+	2020, 3692, 1330, 2797,  636, 2624, 1248, 1963,  880, 2366, 3765, 3161, 1586, 3390, 2681, 3766,
+	3230, 1819, 3490,  632, 1689,  429, 3311,  980, 2405,   93,  856, 2709,  594, 2514, 3446, 1585,
+	2292, 1095, 3497, 2396, 3851, 1843,  541, 3003,  172, 3405, 1607, 2893,  833, 3740, 2533,  779,
+	1221,  320, 1549, 3701, 2221, 2935, 3969,  519, 1830, 3128,  373, 1578, 2829,  767, 2304, 3484,
+	 143, 3117,  351, 1937, 3317,   65, 3742, 3205, 2899, 1470, 1063, 2116,  587, 1228,  379, 1392,
+	 945,  251, 2175, 1147, 3729, 2874, 1322, 3866, 1755, 3012, 1275, 3772, 1653, 2207, 1185, 3809,
+	 196, 2832, 1707,  449, 3155, 1124, 3675, 1485, 2572, 3760, 1005, 2410, 1902,    1, 2054, 3570,
+	2881, 3178, 2001, 2598, 1049, 1447,  229, 2736, 1023, 3886,  810, 3620, 1292, 1901, 3247, 1089,
+	1785, 2603, 1476, 3792, 1083, 2225,  743, 1613,  348, 3427,  118, 2836, 4052, 2244, 3563, 2900,
+	2466, 3988, 3170, 2604,   37, 1912,  702, 2560,  470, 3667, 1996,  381, 2943,    4, 3135,  816,
+	2052, 3263,  719, 2611, 2039,  257, 2814,  809, 1979,  315, 3167,  472, 3460, 1080, 2706, 1701,
+	 198, 3928,  870,  465, 3239, 3763, 1962, 2432, 3461, 1641, 2235, 2999,  279, 2502,  576, 2880,
+	 806, 4062,  535, 2408, 3025, 1747, 2777, 4024, 2445, 2002, 3607, 1696,  924, 3088,   85, 1666,
+	1972,  520,  872, 1552, 3531, 2334, 3112, 1469, 3343, 1034, 2644, 3412, 1400, 4031, 1882, 2693,
+	1457, 3665, 1240, 3994, 1515, 3514, 2372, 3357, 1297, 2290, 1688, 3869, 1365, 2958, 4003,  616,
+	2316, 1331, 1820, 3496, 2355,  745, 1222, 3072,  640,   20, 2668, 1094, 3334, 3906, 1547, 3627,
+	1218, 2029, 3249,  950,  238, 3623, 1310,  445, 1156,  804, 2655,  473, 2415, 1435,  704, 3861,
+	1155, 3481, 3022, 2093,  391, 1055, 4051,  199, 2232, 1667,  668, 2150,  878, 2475,  499, 3381,
+	 365, 2258,   81, 2968,  953,  579, 1753,   53, 4089, 3051,  759, 2596, 2119,  270, 1560,  948,
+	3666, 3059, 2727,   74, 1495, 2916,  312, 4060, 1473, 2068, 3800, 1757,  722, 2089,  187, 2351,
+	 392, 2851, 1642, 3516, 2163,  657, 1980, 3321, 2879, 3895, 1362, 3243, 3793, 2018, 3328, 2582,
+	2234,  189, 1380, 2718, 3700, 1745, 2627,  881, 2942, 3910,  341, 3715, 3201, 1161, 1678, 3889,
+	1099, 3069, 1790, 2527, 2083, 3811, 2995, 1015, 2702,  398, 1231, 3418,  555, 3147, 2486, 3340,
+	2078,  407, 1039, 3901, 2156, 3609, 1814, 2331, 3257,  882, 3480,  347, 2808, 1376, 3035, 3369,
+	3678, 2488,    5, 1171, 2716, 3859, 2530, 1544,   51, 2217, 1881,  253, 1126, 2784,  362,  944,
+	2934, 1784, 3943,  727, 1238, 3169,  545, 1954, 3502, 1314, 2803, 1865,  141, 2861, 2197,  715,
+	2628, 3722,  841, 3489,  235, 1309, 2209, 3628, 1590, 2070, 3710, 1793,  999, 3804, 1896,  110,
+	1257, 2569, 1672, 3208,  864,  474, 2788, 1024,  179, 2477, 2923, 1219, 2322, 3984,  972, 1827,
+	1453,  893, 3954, 3158, 1487,  301,  983, 3052, 3696,  712, 3495, 2986,  631, 1759, 3465, 1491,
+	3643,  560, 3267, 2462,  116, 2140, 3394, 1539,   48, 2275,  802, 2510, 1519, 3625, 3250,  218,
+	1977, 1412,  530, 1618, 3227, 2675,  705,  411, 2506, 3252,  122, 2846, 2318, 1358,  797, 2927,
+	4071, 3454,  655, 2019, 2632, 1328, 3439, 1679, 3836, 1406,  543, 1866, 3549,   77, 2635,  568,
+	3093, 1969, 2285,  703, 1861, 3406, 2347,  561, 1716, 1056, 2335, 1512, 2483, 3892, 2155,   18,
+	2345, 1086, 2006, 1556, 2952, 3900,  979, 2722, 3779, 1121, 3278, 4088,  551,  955, 1296, 2480,
+	3400, 2919, 4038, 2298, 1001, 3876, 1899, 3434, 1160,  850, 1492, 3912,  412, 2690, 3614, 1702,
+	 532, 2313, 1446, 3694,  296, 3996, 2246,  662, 2990, 2032, 3716, 3204,  776, 1629, 2132, 3841,
+	 231, 2817,  459, 3639, 2959, 1295, 4084, 2027, 3335, 2738, 3963,  138, 3189, 1271,  827, 3134,
+	4073, 2761,  295, 3662,  786, 1399, 2359,  468, 3043, 2023,  263, 1732, 3075, 2069, 3920, 1711,
+	 456, 1177,   88, 1841, 3058,  323, 1417, 2928, 4007, 2164, 3062,  721, 1983, 3304,  181, 2151,
+	1012, 2810,   84, 3045, 1726, 1105, 3268,  335, 2543,  973,  140, 2599, 1144, 2866, 3307, 1198,
+	3542, 1359, 1656, 2498,  102,  826, 2780,  206, 1244,  430, 1913,  917, 3579,  455, 2666, 1835,
+	1320,  661, 3375, 2511, 1911,  249, 3525, 1792,  755, 2583, 3552, 1203, 2373,   63, 2793,  820,
+	3699, 2368, 2766, 3602,  769, 2555, 2241,   29, 1698,  492, 2467, 3524, 1601, 1107, 2479, 3185,
+	3829, 1301, 3411, 2411,  892, 2876, 1941, 1510, 3937, 3126, 1713, 2228, 4077,  304,  664, 2378,
+	 913, 3231, 3998, 1048, 2153, 3744, 1557, 3150, 2220, 3717, 1465, 2860, 2127, 1658, 3842,  245,
+	2946, 2201, 1683, 1138, 4002, 2698, 3228, 1263, 3884, 1480,  403, 2906, 3778,  647, 3457, 1379,
+	3177, 1947,  577, 1551, 1209, 3246, 3743, 1064, 2755, 3356, 1302,  272, 2821, 3975,  808, 1516,
+	 356, 1956,  734, 3878, 2099,  169, 3626,  800, 2332, 1286,  509, 3488, 1464, 2038, 3787, 1779,
+	 128, 1986,  603, 2701, 3469, 1905,  505, 2600,  844, 3428, 2428,  624, 3091, 1078, 2365, 3293,
+	 959, 3797,  338, 3023,  567,  920, 2104,   80, 2326, 3350, 1964,  814, 1538, 2143, 2595, 1769,
+	 268, 1029, 3824, 3358, 2090,  462, 1811,  679, 3604, 2009,  960, 3774, 1864,  529, 2096, 3636,
+	2996, 2711, 1620,  467, 3192, 1367, 2656, 3297,  239, 3762, 2913,  839, 3265, 1062, 3029, 2685,
+	3613, 2417, 3064,  290, 1391, 3236, 1132, 3934, 1686,  247, 1167, 4042,  100, 3527,  565, 1471,
+	2061, 2631, 3473, 1532, 2407, 3599, 1655, 2926,  609, 1047, 3987, 2678, 3229, 1128,  446, 4037,
+	2219, 2994, 2481,  195, 2651, 4075, 2973, 2416, 1550,  147, 2938, 2251, 1418, 3157, 2613,   12,
+	 993, 2321, 3560, 1190, 2495, 4061,  559, 1783, 1050, 2092, 2547, 1824,   68, 2305,  495, 1324,
+	 836, 1535, 3768, 1786,  798, 2382,   38, 2114, 2929, 3256, 1953, 2654, 1377, 1877, 2837, 3697,
+	  50,  748, 1201, 1978,  151, 3160, 1148, 3709, 2529, 3107,  355, 1758,  139, 3711, 2921,  859,
+	3415, 1351,  642, 1729,  966, 1432,  294, 1229, 3880, 2532, 3305,  799,  211, 3537, 1235, 1797,
+	4009,  610, 3063,  131, 1885,  846, 2208, 3053, 3663, 1563,  382, 3964, 2804, 3680, 1725, 3184,
+	 346, 2239, 1022, 2945, 3968, 2661, 3491,  726, 1356,  500, 3738,  770, 2243, 3182,  921, 2491,
+	1748, 3959, 3233, 2704, 3860,  706, 1918,  288, 1562, 2121, 1299, 2471, 3492, 1920, 1316, 2398,
+	   3, 2021, 3926, 2830, 3656, 3165, 1966, 3471,  912,  504, 1646, 4020, 2802, 2381,  863, 3235,
+	2152, 1289, 1738, 3753, 2726, 3483, 1463,   32, 2447,  714, 3203, 1097, 1431,  771, 2500, 4036,
+	2889, 3448,   90, 2100,  517, 1200, 1809, 3813, 2276, 2824, 1632, 3401,  390, 3874,  267, 1281,
+	3018, 2210,  401,  938, 1455, 2196, 2826, 4068,  869, 3325, 3810,  628,  954, 2795,  523, 3781,
+	1654, 3103,  895, 2182,  130, 2380,  588, 2723, 2192, 3044, 1930, 1070,  417, 1573, 3780,  246,
+	2674, 3347,  372, 2277, 1077,  457, 2844, 3326, 1298, 3858, 2719, 2226, 3443,  212, 2065, 1169,
+	1863, 2540, 1306, 3595, 1635, 3319,  192, 2991,  995,  264, 2509, 1112, 1503, 2695, 1823, 3447,
+	 629, 1553, 2519, 3642, 2997,  415, 3417, 1273, 2670,   34, 1680, 2933, 2231, 1472, 3292, 2609,
+	1066, 3594,  399, 1389, 3444, 1118, 1694, 3676,   39, 1270, 3424, 2333, 3641, 2045, 2882,  595,
+	1509, 3898,  812, 2957, 1569, 3915, 2048,  904, 1802,  322, 1952,  534, 1675, 3076, 3569,  552,
+	3820,  757, 3105, 2377,  939, 2759, 2000, 1458, 3283, 4032, 2026, 3078, 3654,  589, 2180, 4085,
+	1098, 3314,  193, 1862, 1159, 2430, 1704,  634, 2284, 3048, 1120, 3574,  324, 3883,  171, 1974,
+	 586, 2289, 2740, 1894, 2987, 4005,  818, 3190, 1507, 3945,  298, 2686,  710, 1252, 3125, 1826,
+	1041, 2484, 2004, 3603,  183, 2469,  626, 3712, 2557, 3410, 1008, 2856, 3757,  888, 2652, 1462,
+	3300, 1697,  233, 4049,  434, 3657,  693, 2435,  397, 1719,  835,   11, 2308,  985, 2915,  135,
+	2073, 2753, 3817,  611, 3223, 3933,  243, 3541, 1884, 3917,  488, 2024, 2507, 1771, 1197, 2998,
+	4063, 1478, 3323,  730,  283, 2501, 2101,  451, 2442, 2891,  968, 1763, 3258,  114, 4083, 2280,
+	3513,   49, 3168, 1254, 1844, 3248, 1180, 2992,  137, 1353, 4029, 2370,   45, 1262, 2272,  299,
+	1032, 2205, 2953, 1906, 1158, 2216, 3086, 3770, 1300, 3408, 2615, 3832, 1774, 3551, 1366, 3164,
+	1633,  897, 2340, 1405, 2060,  982, 2864, 1375,  823, 2566, 1496, 3149,  696, 2812, 3617,  862,
+	2470,   76, 1129, 3840, 1612, 2884, 1337, 3798, 1857,  645, 2184, 3815, 1386, 2465,  918,  484,
+	2768, 1440,  717, 2597,  533, 4053, 2249, 1605, 1987, 3183,  738, 1518, 3017, 1891, 3978, 2828,
+	3585,  566, 1378, 2593, 3376, 1564,   69,  970, 2840, 2133,  582, 1232, 2746,  297, 2422,  694,
+	3638,  433, 3407, 2975,   46, 2621, 3746, 2187, 3291,  134, 3511,  998, 3991, 1390,  386, 2126,
+	3487, 1776, 3100, 2050, 3534,  942,  215, 3414, 1123, 3033, 3474,  387, 2757, 3584, 1645, 2118,
+	3830, 3279, 1733, 3783, 2823,  987,  380, 3530,  592, 2687, 2147, 3575,  486, 3380,  713, 1584,
+	2427, 3226, 3795,  178,  793, 3942, 2703, 1875,  460, 3962, 1565, 3119,  891, 3355, 1942, 3914,
+	2626, 1812, 1137, 4017, 1594,  741, 1766,  436, 1173, 2887, 1671, 2213,  216, 2397, 3373, 1581,
+	 607, 2721,  339, 2546,  546, 2362, 3122, 1651, 2564,   92, 1559, 1051, 1957,  658, 3039, 1278,
+	 371,  981, 2374,  265, 2094, 1483, 2918, 2394, 1065, 3927,  173, 1756, 1046, 2588, 2075,   95,
+	 894, 1943, 1093, 1770, 3009, 2098, 1174, 3532, 3196, 2369,  133, 2008, 3764,  497, 1537, 1016,
+	  91, 2267, 2769,  357, 2161, 3472, 3098, 2485, 4043, 1967,  549, 3689, 2965, 1822, 1038, 2903,
+	3965, 1303, 3718, 1020, 1517, 4046, 1939,  627, 3616, 2088, 3923, 2402, 3142,  144, 3960, 2570,
+	1825, 3649, 2981, 1290, 3583, 3284,    0, 3771, 1873, 1311, 3274, 2843, 3728, 1387, 3141, 3837,
+	2782,  314, 2649, 3555,  553, 2451,  326, 1479,  718, 1081, 3581, 2920, 1333, 2204, 2724, 3020,
+	3508, 1355, 3298,  852, 3724, 1116,  177, 1481,  716, 3452, 2545, 1315,  784, 3844, 2561,  117,
+	 889, 2310, 1833, 2961, 3360,   55, 1188, 2833,  978,  464, 3264,  747, 1266, 3450, 2229,  821,
+	2850,   87, 2030,  866,  548, 1715, 2625,  758, 3102,  450, 2257,  861,  266, 2388,  466, 1245,
+	3083, 4079, 2139, 1321, 3202, 1615, 3702, 2962, 1945, 2576, 1673,  660, 2504,  221, 4055,  750,
+	2015,  479, 1710, 2960, 2429, 1908, 2775, 3306, 2329, 1071,   13, 3195, 1609,  327, 3316, 2040,
+	3131, 3522,  256,  761, 2062, 2619, 3503, 2247, 3786, 1409, 2653, 1880, 2809, 1599,  319, 1205,
+	3299, 1548, 4006, 3140, 2459, 3877, 1117, 2189, 1474, 3671, 2638, 1604, 4019, 1916, 3453, 1717,
+	 596, 1498,  843,   17, 3865,  964, 2689,  111, 4041, 3282,  384, 3834, 1035, 3217, 1724, 1211,
+	3679, 2539, 3940,  158, 1426,  639, 3828,  317, 1728, 3911, 2728, 1915, 3611, 2222, 1145, 1448,
+	 585, 1593, 2683, 3852, 1357,  564, 1669,  300, 3016, 1762,  162, 4022,  528, 3612, 1946, 3825,
+	2320,  650, 2601, 1395, 1925,  342, 3032, 3477,  186, 1984, 1014, 3315,  686, 2944,  975, 2278
+};
+
+static const int BLUE_NOISE_DITHERS_SCALE = 64 * 64 + 1;
+
 template <class T>
 float normalize_dither(T x, T min, T max)
 {
@@ -49,21 +311,17 @@ void get_ordered_dithers(float *p)
 	}
 }
 
-void get_random_dithers(float *p)
+void get_blue_noise_dithers(float *p)
 {
-	std::mt19937 mt;
-	uint_fast32_t mt_min = std::mt19937::min();
-	uint_fast32_t mt_max = std::mt19937::max();
-
-	// Dividing the random numbers by 4 chosen arbitrarily to limit noisiness.
-	std::generate_n(p, OrderedDither::NUM_DITHERS, [&]() { return normalize_dither(mt(), mt_min, mt_max) * 0.25; });
+	std::transform(BLUE_NOISE_DITHERS, BLUE_NOISE_DITHERS + OrderedDither::NUM_DITHERS, p,
+	               [](unsigned short x) { return normalize_dither((int)x + 1, 0, BLUE_NOISE_DITHERS_SCALE); });
 }
 
-class OrderedDitherC : public OrderedDither {
+class OrderedDitherC final : public DitherConvertPlane<OrderedDitherC, OrderedDither> {
 	template <class T, class U, class ToFloat, class FromFloat>
-	void dither(const ImageTile<const T> &src, const ImageTile<U> &dst, ToFloat to_float, FromFloat from_float) const
+	void dither(const ImageTile<const T> &src, const ImageTile<U> &dst, const float *tmp, ToFloat to_float, FromFloat from_float) const
 	{
-		const float *dither_data = m_dither.data();
+		const float *dither_data = dither_table(tmp);
 		int depth = dst.descriptor()->format.depth;
 
 		float scale = 1.0f / (float)(1 << (depth - 1));
@@ -78,62 +336,83 @@ class OrderedDitherC : public OrderedDither {
 		}
 	}
 public:
-	explicit OrderedDitherC(const float *dither) : OrderedDither(dither)
+	explicit OrderedDitherC(const float *dither) : DitherConvertPlane(dither)
 	{}
 
 	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void half_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, depth::half_to_float, make_float_to_integer<uint8_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, depth::half_to_float, make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void half_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, depth::half_to_float, make_float_to_integer<uint16_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, depth::half_to_float, make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void float_to_byte(const ImageTile<const float> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, identity<float>, make_float_to_integer<uint8_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, identity<float>, make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void float_to_word(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		dither(src, dst, identity<float>, make_float_to_integer<uint16_t>(dst.descriptor()->format));
+		dither(src, dst, tmp, identity<float>, make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 };
 
 } // namespace
 
 
-OrderedDither::OrderedDither(const float *dither) :
-	m_dither(dither, dither + NUM_DITHERS)
+OrderedDither::OrderedDither(const float *dither)
 {
+	if (dither)
+		m_dither.assign(dither, dither + NUM_DITHERS);
+}
+
+size_t OrderedDither::tile_tmp_size() const
+{
+	return m_dither.empty() ? NUM_DITHERS : 0;
+}
+
+void OrderedDither::prepare_tile(float *tmp, uint32_t seed, int i, int j) const
+{
+	if (!m_dither.empty())
+		return;
+
+	for (int ii = 0; ii < NUM_DITHERS_V; ++ii) {
+		uint32_t key = random_dither_row_key(seed, i + ii);
+
+		for (int jj = 0; jj < NUM_DITHERS_H; ++jj) {
+			tmp[ii * NUM_DITHERS_H + jj] = random_dither_value(key, j + jj);
+		}
+	}
 }
 
 DitherConvert *create_ordered_dither(DitherType type, CPUClass cpu)
 {
 	DitherConvert *ret = nullptr;
-	float dither[OrderedDither::NUM_DITHERS];
+	float dither_table[OrderedDither::NUM_DITHERS];
+	float *dither = dither_table;
 
 	switch (type) {
 	case DitherType::DITHER_NONE:
@@ -143,7 +422,10 @@ DitherConvert *create_ordered_dither(DitherType type, CPUClass cpu)
 		get_ordered_dithers(dither);
 		break;
 	case DitherType::DITHER_RANDOM:
-		get_random_dithers(dither);
+		dither = nullptr;
+		break;
+	case DitherType::DITHER_BLUE_NOISE:
+		get_blue_noise_dithers(dither);
 		break;
 	default:
 		throw ZimgIllegalArgument{ "unrecognized ordered dither type" };
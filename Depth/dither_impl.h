@@ -13,6 +13,48 @@ enum class CPUClass;
 
 namespace depth {;
 
+/**
+ * Integer hash used as a counter-based random number generator ("lowbias32" by Chris Wellons).
+ */
+inline uint32_t random_dither_hash(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7FEB352DUL;
+	x ^= x >> 15;
+	x *= 0x846CA68BUL;
+	x ^= x >> 16;
+	return x;
+}
+
+/**
+ * Get the counter base for a scanline of random dither.
+ *
+ * @param seed per-frame seed
+ * @param i row index in plane
+ * @return value to which the column index is added before hashing
+ */
+inline uint32_t random_dither_row_key(uint32_t seed, int i)
+{
+	return random_dither_hash(seed ^ random_dither_hash((uint32_t)i));
+}
+
+/**
+ * Get the random dither offset at a given column, using both halves of each hash.
+ * Columns 16n+k and 16n+k+8 (k < 8) share the hash of counter 8n+k, which maps to eight SIMD lanes.
+ * The offsets are divided by 4, as chosen arbitrarily to limit noisiness.
+ *
+ * @param key counter base of scanline (@see random_dither_row_key)
+ * @param j column index in plane
+ * @return dither offset
+ */
+inline float random_dither_value(uint32_t key, int j)
+{
+	uint32_t x = random_dither_hash(key + (uint32_t)(j >> 4) * 8 + (uint32_t)(j & 7));
+	uint32_t bits = (j & 8) ? x >> 16 : x & 0xFFFF;
+
+	return ((float)bits * (1.0f / 65536) - 0.5f) * 0.25f;
+}
+
 /**
  * Base class for ordered dither implementations.
  */
@@ -20,25 +62,40 @@ class OrderedDither : public DitherConvert {
 protected:	
 	/**
 	 * Array of fixed dither offsets to add (range -0.5 to 0.5).
-	 * This is a 64x64 array.
+	 * This is a 64x64 array, or empty if the offsets are generated for each tile.
 	 */
 	AlignedVector<float> m_dither;
 
 	/**
 	 * Initialize the implementation with the given coefficients.
 	 *
-	 * @param dither coefficient table
+	 * @param dither coefficient table, or nullptr to generate random offsets for each tile
 	 */
 	explicit OrderedDither(const float *dither);
+
+	/**
+	 * Get the dither offsets for the current tile.
+	 *
+	 * @param tmp temporary buffer passed to the conversion
+	 * @return 64x64 array of offsets
+	 */
+	const float *dither_table(const float *tmp) const
+	{
+		return m_dither.empty() ? tmp : m_dither.data();
+	}
 public:
 	static const int NUM_DITHERS = 64 * 64;
 	static const int NUM_DITHERS_H = 64;
 	static const int NUM_DITHERS_V = 64;
+
+	size_t tile_tmp_size() const override;
+
+	void prepare_tile(float *tmp, uint32_t seed, int i, int j) const override;
 };
 
 /**
  * Create a concrete OrderedDither.
- * Several dither modes are implemented through OrderedDither, including NONE, ORDERED, and RANDOM.
+ * Several dither modes are implemented through OrderedDither, including NONE, ORDERED, RANDOM, and BLUE_NOISE.
  *
  * @param type dither type
  * @param cpu create implementation optimized for given cpu
@@ -1,6 +1,7 @@
 #ifdef ZIMG_X86
 
 #include <immintrin.h>
+#include "Common/osdep.h"
 #include "Common/tile.h"
 #include "dither_impl.h"
 #include "dither_impl_x86.h"
@@ -24,63 +25,105 @@ struct DitherPolicyAVX2 {
 	__m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
 };
 
-class OrderedDitherAVX2 : public OrderedDitherX86 {
+inline FORCE_INLINE __m256i random_dither_hash_avx2(__m256i x)
+{
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7FEB352DUL));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+	x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x846CA68BUL));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+	return x;
+}
+
+class OrderedDitherAVX2 final : public DitherConvertPlane<OrderedDitherAVX2, OrderedDitherX86> {
 public:
-	explicit OrderedDitherAVX2(const float *dither) : OrderedDitherX86(dither)
+	explicit OrderedDitherAVX2(const float *dither) : DitherConvertPlane(dither)
 	{}
 
+	void prepare_tile(float *tmp, uint32_t seed, int i, int j) const override
+	{
+		if (!m_dither.empty())
+			return;
+
+		// The vector loop hashes whole groups of 16 columns, so a tile at any other column offset is prepared by the scalar code.
+		if (j % 16) {
+			OrderedDither::prepare_tile(tmp, seed, i, j);
+			return;
+		}
+
+		__m256i lane = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+		__m256i mask = _mm256_set1_epi32(0xFFFF);
+		__m256 scale = _mm256_set1_ps(0.25f / 65536);
+		__m256 offset = _mm256_set1_ps(-0.125f);
+
+		for (int ii = 0; ii < NUM_DITHERS_V; ++ii) {
+			uint32_t key = random_dither_row_key(seed, i + ii) + (uint32_t)(j >> 4) * 8;
+			__m256i counter = _mm256_add_epi32(_mm256_set1_epi32(key), lane);
+
+			for (int jj = 0; jj < NUM_DITHERS_H; jj += 16) {
+				__m256i x = random_dither_hash_avx2(counter);
+				__m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(x, mask));
+				__m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 16));
+
+				_mm256_store_ps(&tmp[ii * NUM_DITHERS_H + jj + 0], _mm256_fmadd_ps(lo, scale, offset));
+				_mm256_store_ps(&tmp[ii * NUM_DITHERS_H + jj + 8], _mm256_fmadd_ps(hi, scale, offset));
+				counter = _mm256_add_epi32(counter, _mm256_set1_epi32(8));
+			}
+		}
+	}
+
 	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackByteAVX2{}, PackByteAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackByteAVX2{}, PackByteAVX2{},
 		        make_integer_to_float_avx2(src.descriptor()->format), make_float_to_integer_avx2(dst.descriptor()->format),
 		        make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackByteAVX2{}, PackWordAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackByteAVX2{}, PackWordAVX2{},
 		        make_integer_to_float_avx2(src.descriptor()->format), make_float_to_integer_avx2(dst.descriptor()->format),
 		        make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackWordAVX2{}, PackByteAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackWordAVX2{}, PackByteAVX2{},
 		        make_integer_to_float_avx2(src.descriptor()->format), make_float_to_integer_avx2(dst.descriptor()->format),
 		        make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackWordAVX2{}, PackWordAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackWordAVX2{}, PackWordAVX2{},
 		        make_integer_to_float_avx2(src.descriptor()->format), make_float_to_integer_avx2(dst.descriptor()->format),
 		        make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void half_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackHalfAVX2{}, PackByteAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackHalfAVX2{}, PackByteAVX2{},
 		        half_to_float_avx2, make_float_to_integer_avx2(dst.descriptor()->format),
 		        depth::half_to_float, make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void half_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackHalfAVX2{}, PackWordAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackHalfAVX2{}, PackWordAVX2{},
 		        half_to_float_avx2, make_float_to_integer_avx2(dst.descriptor()->format),
 		        depth::half_to_float, make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void float_to_byte(const ImageTile<const float> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackFloatAVX2{}, PackByteAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackFloatAVX2{}, PackByteAVX2{},
 		        identity<__m256>, make_float_to_integer_avx2(dst.descriptor()->format),
 		        identity<float>, make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void float_to_word(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicyAVX2{}, UnpackFloatAVX2{}, PackWordAVX2{},
+		process(src, dst, tmp, DitherPolicyAVX2{}, UnpackFloatAVX2{}, PackWordAVX2{},
 		        identity<__m256>, make_float_to_integer_avx2(dst.descriptor()->format),
 		        identity<float>, make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
@@ -1,6 +1,7 @@
 #ifdef ZIMG_X86
 
 #include <emmintrin.h>
+#include "Common/osdep.h"
 #include "Common/tile.h"
 #include "dither_impl.h"
 #include "dither_impl_x86.h"
@@ -24,63 +25,119 @@ struct DitherPolicySSE2 {
 	__m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
 };
 
-class OrderedDitherSSE2 : public OrderedDitherX86 {
+inline FORCE_INLINE __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+	even = _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0));
+	odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0));
+
+	return _mm_unpacklo_epi32(even, odd);
+}
+
+inline FORCE_INLINE __m128i random_dither_hash_sse2(__m128i x)
+{
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+	x = mullo_epi32_sse2(x, _mm_set1_epi32(0x7FEB352DUL));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+	x = mullo_epi32_sse2(x, _mm_set1_epi32(0x846CA68BUL));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+	return x;
+}
+
+class OrderedDitherSSE2 final : public DitherConvertPlane<OrderedDitherSSE2, OrderedDitherX86> {
 public:
-	explicit OrderedDitherSSE2(const float *dither) : OrderedDitherX86(dither)
+	explicit OrderedDitherSSE2(const float *dither) : DitherConvertPlane(dither)
 	{}
 
+	void prepare_tile(float *tmp, uint32_t seed, int i, int j) const override
+	{
+		if (!m_dither.empty())
+			return;
+
+		// The vector loop hashes whole groups of 16 columns, so a tile at any other column offset is prepared by the scalar code.
+		if (j % 16) {
+			OrderedDither::prepare_tile(tmp, seed, i, j);
+			return;
+		}
+
+		__m128i lane = _mm_set_epi32(3, 2, 1, 0);
+		__m128i mask = _mm_set1_epi32(0xFFFF);
+		__m128 scale = _mm_set_ps1(0.25f / 65536);
+		__m128 offset = _mm_set_ps1(-0.125f);
+
+		for (int ii = 0; ii < NUM_DITHERS_V; ++ii) {
+			uint32_t key = random_dither_row_key(seed, i + ii) + (uint32_t)(j >> 4) * 8;
+			__m128i counter = _mm_add_epi32(_mm_set1_epi32(key), lane);
+
+			// Two vectors of hashes cover the eight counters of each group of 16 columns (@see random_dither_value).
+			for (int jj = 0; jj < NUM_DITHERS_H; jj += 16) {
+				for (int k = 0; k < 2; ++k) {
+					__m128i x = random_dither_hash_sse2(counter);
+					__m128 lo = _mm_cvtepi32_ps(_mm_and_si128(x, mask));
+					__m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(x, 16));
+
+					_mm_store_ps(&tmp[ii * NUM_DITHERS_H + jj + k * 4 + 0], _mm_add_ps(_mm_mul_ps(lo, scale), offset));
+					_mm_store_ps(&tmp[ii * NUM_DITHERS_H + jj + k * 4 + 8], _mm_add_ps(_mm_mul_ps(hi, scale), offset));
+					counter = _mm_add_epi32(counter, _mm_set1_epi32(4));
+				}
+			}
+		}
+	}
+
 	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackByteSSE2{}, PackByteSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackByteSSE2{}, PackByteSSE2{},
 		        make_integer_to_float_sse2(src.descriptor()->format), make_float_to_integer_sse2(dst.descriptor()->format),
 		        make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackByteSSE2{}, PackWordSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackByteSSE2{}, PackWordSSE2{},
 		        make_integer_to_float_sse2(src.descriptor()->format), make_float_to_integer_sse2(dst.descriptor()->format),
 		        make_integer_to_float<uint8_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackWordSSE2{}, PackByteSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackWordSSE2{}, PackByteSSE2{},
 		        make_integer_to_float_sse2(src.descriptor()->format), make_float_to_integer_sse2(dst.descriptor()->format),
 		        make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackWordSSE2{}, PackWordSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackWordSSE2{}, PackWordSSE2{},
 		        make_integer_to_float_sse2(src.descriptor()->format), make_float_to_integer_sse2(dst.descriptor()->format),
 		        make_integer_to_float<uint16_t>(src.descriptor()->format), make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void half_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process<uint16_t, uint8_t>(src, dst, DitherPolicySSE2{}, UnpackWordSSE2{}, PackByteSSE2{},
+		process<uint16_t, uint8_t>(src, dst, tmp, DitherPolicySSE2{}, UnpackWordSSE2{}, PackByteSSE2{},
 		        half_to_float_sse2, make_float_to_integer_sse2(dst.descriptor()->format),
 		        depth::half_to_float, make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void half_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackWordSSE2{}, PackWordSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackWordSSE2{}, PackWordSSE2{},
 		        half_to_float_sse2, make_float_to_integer_sse2(dst.descriptor()->format),
 		        depth::half_to_float, make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
 
 	void float_to_byte(const ImageTile<const float> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackFloatSSE2{}, PackByteSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackFloatSSE2{}, PackByteSSE2{},
 		        identity<__m128>, make_float_to_integer_sse2(dst.descriptor()->format),
 		        identity<float>, make_float_to_integer<uint8_t>(dst.descriptor()->format));
 	}
 
 	void float_to_word(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
 	{
-		process(src, dst, DitherPolicySSE2{}, UnpackFloatSSE2{}, PackWordSSE2{},
+		process(src, dst, tmp, DitherPolicySSE2{}, UnpackFloatSSE2{}, PackWordSSE2{},
 		        identity<__m128>, make_float_to_integer_sse2(dst.descriptor()->format),
 		        identity<float>, make_float_to_integer<uint16_t>(dst.descriptor()->format));
 	}
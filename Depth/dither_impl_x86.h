@@ -31,7 +31,7 @@ protected:
 	{}
 
 	template <class T, class U, class Policy, class Unpack, class Pack, class ToFloat, class FromFloat, class ToFloatScalar, class FromFloatScalar>
-	void process(const ImageTile<const T> &src, const ImageTile<U> &dst, Policy policy, Unpack unpack, Pack pack,
+	void process(const ImageTile<const T> &src, const ImageTile<U> &dst, const float *tmp, Policy policy, Unpack unpack, Pack pack,
 	             ToFloat to_float, FromFloat from_float, ToFloatScalar to_float_scalar, FromFloatScalar from_float_scalar) const
 	{
 		typedef typename Policy::type vector_type;
@@ -42,7 +42,7 @@ protected:
 		typedef Div<loop_step::value, Unpack::loop_step> loop_unroll_unpack;
 		typedef Div<loop_step::value, Pack::loop_step> loop_unroll_pack;
 
-		const float *dither_data = m_dither.data();
+		const float *dither_data = dither_table(tmp);
 		int depth = dst.descriptor()->format.depth;
 
 		float scale = 1.0f / (float)(1 << (depth - 1));
@@ -1,7 +1,7 @@
 #pragma once
 
 #ifndef ZIMG_DEPTH_ERROR_DIFFUSION_H_
-#define ZIMG_DEPTH_ERROR_DIFFISION_H_
+#define ZIMG_DEPTH_ERROR_DIFFUSION_H_
 
 namespace zimg {;
 
@@ -9,14 +9,27 @@ enum class CPUClass;
 
 namespace depth {;
 
+enum class DitherType;
+
 class DitherConvert;
 
+/**
+ * Check if a dither type is based on error diffusion.
+ * Error diffusion can not be applied on tiles smaller than a plane.
+ *
+ * @param type dither type
+ * @return true if error diffusion, else false
+ */
+bool is_error_diffusion(DitherType type);
+
 /**
  * Create a concrete DitherConvert based on error-diffusion.
  *
+ * @param type error diffusion dither type
  * @param cpu create implementation optimized for given cpu
+ * @throws ZimgIllegalArgument if type is not an error diffusion type
  */
-DitherConvert *create_error_diffusion(CPUClass cpu);
+DitherConvert *create_error_diffusion(DitherType type, CPUClass cpu);
 
 } // namespace depth
 } // namespace zimg
@@ -0,0 +1,219 @@
+#ifdef ZIMG_X86
+
+#include <immintrin.h>
+#include "Common/osdep.h"
+#include "Common/tile.h"
+#include "error_diffusion_impl.h"
+#include "error_diffusion_x86.h"
+#include "quantize_avx2.h"
+
+namespace zimg {;
+namespace depth {;
+
+namespace {;
+
+class ScaleClampAVX2 {
+	__m256 scale;
+	__m256 offset;
+	__m256 max;
+public:
+	ScaleClampAVX2(float scale, float offset, float max) :
+		scale(_mm256_set1_ps(scale)),
+		offset(_mm256_set1_ps(offset)),
+		max(_mm256_set1_ps(max))
+	{}
+
+	FORCE_INLINE __m256 operator()(__m256 x) const
+	{
+		x = _mm256_add_ps(_mm256_mul_ps(x, scale), offset);
+		x = _mm256_max_ps(x, _mm256_setzero_ps());
+		x = _mm256_min_ps(x, max);
+		return x;
+	}
+};
+
+inline FORCE_INLINE __m256i clamp_cvt_avx2(__m256 x, __m256 max)
+{
+	x = _mm256_max_ps(x, _mm256_setzero_ps());
+	x = _mm256_min_ps(x, max);
+	return _mm256_cvttps_epi32(x);
+}
+
+struct LoadAVX2 {
+	void operator()(const uint8_t *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampAVX2 cvt{ scale, offset, max };
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m256i lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&src[j + 0]));
+			__m256i hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&src[j + 8]));
+
+			_mm256_storeu_ps(&dst[j + 0], cvt(_mm256_cvtepi32_ps(lo)));
+			_mm256_storeu_ps(&dst[j + 8], cvt(_mm256_cvtepi32_ps(hi)));
+		}
+		error_diffusion_load(src + j, dst + j, width - j, scale, offset, max);
+	}
+
+	void operator()(const uint16_t *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampAVX2 cvt{ scale, offset, max };
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m256i lo = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&src[j + 0]));
+			__m256i hi = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&src[j + 8]));
+
+			_mm256_storeu_ps(&dst[j + 0], cvt(_mm256_cvtepi32_ps(lo)));
+			_mm256_storeu_ps(&dst[j + 8], cvt(_mm256_cvtepi32_ps(hi)));
+		}
+		error_diffusion_load(src + j, dst + j, width - j, scale, offset, max);
+	}
+
+	void operator()(const float *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampAVX2 cvt{ scale, offset, max };
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			_mm256_storeu_ps(&dst[j], cvt(_mm256_loadu_ps(&src[j])));
+		}
+		error_diffusion_load(src + j, dst + j, width - j, scale, offset, max);
+	}
+};
+
+struct LoadHalfAVX2 {
+	void operator()(const uint16_t *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampAVX2 cvt{ scale, offset, max };
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&src[j]);
+
+			_mm256_storeu_ps(&dst[j], cvt(half_to_float_avx2(x)));
+		}
+		error_diffusion_load_half(src + j, dst + j, width - j, scale, offset, max);
+	}
+};
+
+struct AddErrorAVX2 {
+	void operator()(float *line, const float *prev, int width, float w0, float w1, float w2) const
+	{
+		__m256 w0_ps = _mm256_set1_ps(w0);
+		__m256 w1_ps = _mm256_set1_ps(w1);
+		__m256 w2_ps = _mm256_set1_ps(w2);
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m256 x = _mm256_loadu_ps(&line[j]);
+
+			x = _mm256_add_ps(x, _mm256_mul_ps(w0_ps, _mm256_loadu_ps(&prev[j - 1])));
+			x = _mm256_add_ps(x, _mm256_mul_ps(w1_ps, _mm256_loadu_ps(&prev[j + 0])));
+			x = _mm256_add_ps(x, _mm256_mul_ps(w2_ps, _mm256_loadu_ps(&prev[j + 1])));
+
+			_mm256_storeu_ps(&line[j], x);
+		}
+		error_diffusion_add_error(line + j, prev + j, width - j, w0, w1, w2);
+	}
+};
+
+struct StoreAVX2 {
+	void operator()(const float *src, uint8_t *dst, int width, float max) const
+	{
+		__m256 max_ps = _mm256_set1_ps(max);
+		__m256i perm = _mm256_set_epi32(7, 3, 6, 2, 5, 1, 4, 0);
+		int j;
+
+		for (j = 0; j + 32 <= width; j += 32) {
+			__m256i x0 = clamp_cvt_avx2(_mm256_loadu_ps(&src[j + 0]), max_ps);
+			__m256i x1 = clamp_cvt_avx2(_mm256_loadu_ps(&src[j + 8]), max_ps);
+			__m256i x2 = clamp_cvt_avx2(_mm256_loadu_ps(&src[j + 16]), max_ps);
+			__m256i x3 = clamp_cvt_avx2(_mm256_loadu_ps(&src[j + 24]), max_ps);
+
+			__m256i lo = _mm256_packs_epi32(x0, x1);
+			__m256i hi = _mm256_packs_epi32(x2, x3);
+			__m256i x = _mm256_packus_epi16(lo, hi);
+
+			// Each 128-bit lane holds groups of four pixels from x0-x3 in order.
+			x = _mm256_permutevar8x32_epi32(x, perm);
+			_mm256_storeu_si256((__m256i *)&dst[j], x);
+		}
+		error_diffusion_store(src + j, dst + j, width - j, max);
+	}
+
+	void operator()(const float *src, uint16_t *dst, int width, float max) const
+	{
+		__m256 max_ps = _mm256_set1_ps(max);
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m256i lo = clamp_cvt_avx2(_mm256_loadu_ps(&src[j + 0]), max_ps);
+			__m256i hi = clamp_cvt_avx2(_mm256_loadu_ps(&src[j + 8]), max_ps);
+			__m256i x = _mm256_packus_epi32(lo, hi);
+
+			x = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 1, 2, 0));
+			_mm256_storeu_si256((__m256i *)&dst[j], x);
+		}
+		error_diffusion_store(src + j, dst + j, width - j, max);
+	}
+};
+
+class ErrorDiffusionAVX2 : public ErrorDiffusion {
+public:
+	explicit ErrorDiffusionAVX2(const ErrorDiffusionKernel &kernel) : ErrorDiffusion(kernel)
+	{}
+
+	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void half_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadHalfAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void half_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadHalfAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void float_to_byte(const ImageTile<const float> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+
+	void float_to_word(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadAVX2{}, AddErrorAVX2{}, StoreAVX2{});
+	}
+};
+
+} // namespace
+
+
+DitherConvert *create_error_diffusion_avx2(const ErrorDiffusionKernel &kernel)
+{
+	return new ErrorDiffusionAVX2{ kernel };
+}
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,250 @@
+#pragma once
+
+#ifndef ZIMG_DEPTH_ERROR_DIFFUSION_IMPL_H_
+#define ZIMG_DEPTH_ERROR_DIFFUSION_IMPL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "Common/pixel.h"
+#include "Common/tile.h"
+#include "dither.h"
+#include "quantize.h"
+
+namespace zimg {;
+namespace depth {;
+
+enum class DitherType;
+
+/**
+ * Weights of an error diffusion filter, as received by a pixel.
+ */
+struct ErrorDiffusionKernel {
+	/** Weight of the error of the previous pixel in scan order. */
+	float weight_curr;
+	/** Weights of the errors at columns j-1, j, j+1 of the previous scanline, if scanned left to right. */
+	float weight_prev[3];
+	/** Alternate the scan direction of each scanline. */
+	bool serpentine;
+};
+
+/**
+ * Get the error diffusion filter for a dither type.
+ *
+ * @param type error diffusion dither type
+ * @return filter weights
+ * @throws ZimgIllegalArgument if type is not an error diffusion type
+ */
+ErrorDiffusionKernel get_error_diffusion_kernel(DitherType type);
+
+/**
+ * Convert a scanline to units of the output format.
+ *
+ * @param src input scanline
+ * @param dst output line buffer
+ * @param width number of pixels
+ * @param scale scale to output units
+ * @param offset offset of output format, less the scaled offset of input format
+ * @param max maximum value of output format
+ */
+template <class T>
+void error_diffusion_load(const T *src, float *dst, int width, float scale, float offset, float max)
+{
+	for (int j = 0; j < width; ++j) {
+		dst[j] = clamp((float)src[j] * scale + offset, 0.0f, max);
+	}
+}
+
+/**
+ * @see error_diffusion_load
+ */
+inline void error_diffusion_load_half(const uint16_t *src, float *dst, int width, float scale, float offset, float max)
+{
+	for (int j = 0; j < width; ++j) {
+		dst[j] = clamp(half_to_float(src[j]) * scale + offset, 0.0f, max);
+	}
+}
+
+/**
+ * Add the error diffused from the previous scanline.
+ *
+ * @param line line buffer
+ * @param prev error of previous scanline, readable at indices -1 and width
+ * @param width number of pixels
+ * @param w0 weight of prev[j - 1]
+ * @param w1 weight of prev[j]
+ * @param w2 weight of prev[j + 1]
+ */
+inline void error_diffusion_add_error(float *line, const float *prev, int width, float w0, float w1, float w2)
+{
+	for (int j = 0; j < width; ++j) {
+		float x = line[j];
+
+		x += w0 * prev[j - 1];
+		x += w1 * prev[j + 0];
+		x += w2 * prev[j + 1];
+
+		line[j] = x;
+	}
+}
+
+/**
+ * Store a quantized scanline.
+ *
+ * @param src line buffer holding integral values
+ * @param dst output scanline
+ * @param width number of pixels
+ * @param max maximum value of output format
+ */
+template <class T>
+void error_diffusion_store(const float *src, T *dst, int width, float max)
+{
+	for (int j = 0; j < width; ++j) {
+		dst[j] = static_cast<T>(clamp(src[j], 0.0f, max));
+	}
+}
+
+/**
+ * Quantize a scanline, carrying the error along the scan direction.
+ * This is the only serial step of error diffusion.
+ *
+ * @param line scanline in units of the output format, overwritten with the quantized values
+ * @param err receives the quantization error of each pixel
+ * @param width number of pixels
+ * @param weight weight of the error carried to the next pixel
+ * @param reverse scan from right to left
+ */
+inline void error_diffusion_scanline(float *line, float *err, int width, float weight, bool reverse)
+{
+	// Adding and subtracting 1.5 * 2^23 rounds to nearest integer for |x| < 2^22.
+	const float magic = 12582912.0f;
+	float e = 0.0f;
+
+	for (int k = 0; k < width; ++k) {
+		int j = reverse ? width - k - 1 : k;
+		float x = line[j] + e * weight;
+		float q = (x + magic) - magic;
+
+		e = x - q;
+		err[j] = e;
+		line[j] = q;
+	}
+}
+
+/**
+ * Quantize N independent scanlines with an error carried only along the row.
+ * The scanlines are interleaved to overlap their dependency chains.
+ *
+ * @param line pointers to scanlines in units of the output format
+ * @param width number of pixels
+ */
+template <int N>
+void error_diffusion_scanline_row(float * const *line, int width)
+{
+	const float magic = 12582912.0f;
+	float e[N] = { 0 };
+
+	for (int j = 0; j < width; ++j) {
+		for (int n = 0; n < N; ++n) {
+			float x = line[n][j] + e[n];
+			float q = (x + magic) - magic;
+
+			e[n] = x - q;
+			line[n][j] = q;
+		}
+	}
+}
+
+/**
+ * Base class for error diffusion implementations.
+ *
+ * Each scanline is converted into a line buffer in units of the output format and clamped to its range,
+ * receives the error of the previous scanline, is quantized serially, and is stored.
+ * Implementations provide the per-scanline load, error and store routines.
+ */
+class ErrorDiffusion : public DitherConvert {
+	ErrorDiffusionKernel m_kernel;
+protected:
+	explicit ErrorDiffusion(const ErrorDiffusionKernel &kernel) : m_kernel(kernel)
+	{}
+
+	/**
+	 * Apply error diffusion to a plane.
+	 *
+	 * @param load load(src_row, line, width, scale, offset, max), computing clamp(x * scale + offset, 0, max)
+	 * @param add_error add_error(line, prev, width, w0, w1, w2), adding w0 * prev[j-1] + w1 * prev[j] + w2 * prev[j+1]
+	 * @param store store(line, dst_row, width, max), clamping integral values to [0, max]
+	 */
+	template <class T, class U, class Load, class AddError, class Store>
+	void process(const ImageTile<const T> &src, const ImageTile<U> &dst, float *tmp, Load load, AddError add_error, Store store) const
+	{
+		const PixelFormat &src_format = src.descriptor()->format;
+		const PixelFormat &dst_format = dst.descriptor()->format;
+		int width = src.descriptor()->width;
+		int height = src.descriptor()->height;
+
+		bool src_integer = src_format.type < PixelType::HALF;
+		float src_offset = src_integer ? (float)integer_offset(src_format.depth, src_format.fullrange, src_format.chroma) : 0.0f;
+		float src_range = src_integer ? (float)integer_range(src_format.depth, src_format.fullrange, src_format.chroma) : 1.0f;
+		float dst_offset = (float)integer_offset(dst_format.depth, dst_format.fullrange, dst_format.chroma);
+		float dst_range = (float)integer_range(dst_format.depth, dst_format.fullrange, dst_format.chroma);
+
+		float scale = dst_range / src_range;
+		float offset = dst_offset - src_offset * scale;
+		float max = (float)numeric_max(dst_format.depth);
+
+		size_t line_size = (size_t)width + 2;
+		const float *w = m_kernel.weight_prev;
+
+		std::fill_n(tmp, line_size * 4, 0.0f);
+
+		if (w[0] == 0.0f && w[1] == 0.0f && w[2] == 0.0f && m_kernel.weight_curr == 1.0f) {
+			float *lines[4] = { tmp, tmp + line_size, tmp + line_size * 2, tmp + line_size * 3 };
+			int i;
+
+			for (i = 0; i + 4 <= height; i += 4) {
+				for (int n = 0; n < 4; ++n) {
+					load(src[i + n], lines[n], width, scale, offset, max);
+				}
+				error_diffusion_scanline_row<4>(lines, width);
+				for (int n = 0; n < 4; ++n) {
+					store(lines[n], dst[i + n], width, max);
+				}
+			}
+			for (; i < height; ++i) {
+				load(src[i], lines[0], width, scale, offset, max);
+				error_diffusion_scanline_row<1>(lines, width);
+				store(lines[0], dst[i], width, max);
+			}
+			return;
+		}
+
+		float *line = tmp;
+		float *prev = tmp + line_size + 1;
+		float *curr = tmp + line_size * 2 + 1;
+
+		for (int i = 0; i < height; ++i) {
+			bool reverse = m_kernel.serpentine && (i % 2);
+
+			load(src[i], line, width, scale, offset, max);
+
+			// In serpentine order, the previous scanline was scanned in the opposite direction.
+			if (i) {
+				if (m_kernel.serpentine && !reverse)
+					add_error(line, prev, width, w[2], w[1], w[0]);
+				else
+					add_error(line, prev, width, w[0], w[1], w[2]);
+			}
+
+			error_diffusion_scanline(line, curr, width, m_kernel.weight_curr, reverse);
+			store(line, dst[i], width, max);
+
+			std::swap(prev, curr);
+		}
+	}
+};
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_DEPTH_ERROR_DIFFUSION_IMPL_H_
@@ -0,0 +1,219 @@
+#ifdef ZIMG_X86
+
+#include <emmintrin.h>
+#include "Common/osdep.h"
+#include "Common/tile.h"
+#include "error_diffusion_impl.h"
+#include "error_diffusion_x86.h"
+#include "quantize_sse2.h"
+
+namespace zimg {;
+namespace depth {;
+
+namespace {;
+
+class ScaleClampSSE2 {
+	__m128 scale;
+	__m128 offset;
+	__m128 max;
+public:
+	ScaleClampSSE2(float scale, float offset, float max) :
+		scale(_mm_set_ps1(scale)),
+		offset(_mm_set_ps1(offset)),
+		max(_mm_set_ps1(max))
+	{}
+
+	FORCE_INLINE __m128 operator()(__m128 x) const
+	{
+		x = _mm_add_ps(_mm_mul_ps(x, scale), offset);
+		x = _mm_max_ps(x, _mm_setzero_ps());
+		x = _mm_min_ps(x, max);
+		return x;
+	}
+};
+
+inline FORCE_INLINE __m128i clamp_cvt_sse2(__m128 x, __m128 max)
+{
+	x = _mm_max_ps(x, _mm_setzero_ps());
+	x = _mm_min_ps(x, max);
+	return _mm_cvttps_epi32(x);
+}
+
+struct LoadSSE2 {
+	void operator()(const uint8_t *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampSSE2 cvt{ scale, offset, max };
+		__m128i zero = _mm_setzero_si128();
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&src[j]);
+			__m128i lo = _mm_unpacklo_epi8(x, zero);
+			__m128i hi = _mm_unpackhi_epi8(x, zero);
+
+			_mm_storeu_ps(&dst[j + 0], cvt(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero))));
+			_mm_storeu_ps(&dst[j + 4], cvt(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero))));
+			_mm_storeu_ps(&dst[j + 8], cvt(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero))));
+			_mm_storeu_ps(&dst[j + 12], cvt(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero))));
+		}
+		error_diffusion_load(src + j, dst + j, width - j, scale, offset, max);
+	}
+
+	void operator()(const uint16_t *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampSSE2 cvt{ scale, offset, max };
+		__m128i zero = _mm_setzero_si128();
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&src[j]);
+
+			_mm_storeu_ps(&dst[j + 0], cvt(_mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero))));
+			_mm_storeu_ps(&dst[j + 4], cvt(_mm_cvtepi32_ps(_mm_unpackhi_epi16(x, zero))));
+		}
+		error_diffusion_load(src + j, dst + j, width - j, scale, offset, max);
+	}
+
+	void operator()(const float *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampSSE2 cvt{ scale, offset, max };
+		int j;
+
+		for (j = 0; j + 4 <= width; j += 4) {
+			_mm_storeu_ps(&dst[j], cvt(_mm_loadu_ps(&src[j])));
+		}
+		error_diffusion_load(src + j, dst + j, width - j, scale, offset, max);
+	}
+};
+
+struct LoadHalfSSE2 {
+	void operator()(const uint16_t *src, float *dst, int width, float scale, float offset, float max) const
+	{
+		ScaleClampSSE2 cvt{ scale, offset, max };
+		__m128i zero = _mm_setzero_si128();
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&src[j]);
+
+			_mm_storeu_ps(&dst[j + 0], cvt(half_to_float_sse2(_mm_unpacklo_epi16(x, zero))));
+			_mm_storeu_ps(&dst[j + 4], cvt(half_to_float_sse2(_mm_unpackhi_epi16(x, zero))));
+		}
+		error_diffusion_load_half(src + j, dst + j, width - j, scale, offset, max);
+	}
+};
+
+struct AddErrorSSE2 {
+	void operator()(float *line, const float *prev, int width, float w0, float w1, float w2) const
+	{
+		__m128 w0_ps = _mm_set_ps1(w0);
+		__m128 w1_ps = _mm_set_ps1(w1);
+		__m128 w2_ps = _mm_set_ps1(w2);
+		int j;
+
+		for (j = 0; j + 4 <= width; j += 4) {
+			__m128 x = _mm_loadu_ps(&line[j]);
+
+			x = _mm_add_ps(x, _mm_mul_ps(w0_ps, _mm_loadu_ps(&prev[j - 1])));
+			x = _mm_add_ps(x, _mm_mul_ps(w1_ps, _mm_loadu_ps(&prev[j + 0])));
+			x = _mm_add_ps(x, _mm_mul_ps(w2_ps, _mm_loadu_ps(&prev[j + 1])));
+
+			_mm_storeu_ps(&line[j], x);
+		}
+		error_diffusion_add_error(line + j, prev + j, width - j, w0, w1, w2);
+	}
+};
+
+struct StoreSSE2 {
+	void operator()(const float *src, uint8_t *dst, int width, float max) const
+	{
+		__m128 max_ps = _mm_set_ps1(max);
+		int j;
+
+		for (j = 0; j + 16 <= width; j += 16) {
+			__m128i x0 = clamp_cvt_sse2(_mm_loadu_ps(&src[j + 0]), max_ps);
+			__m128i x1 = clamp_cvt_sse2(_mm_loadu_ps(&src[j + 4]), max_ps);
+			__m128i x2 = clamp_cvt_sse2(_mm_loadu_ps(&src[j + 8]), max_ps);
+			__m128i x3 = clamp_cvt_sse2(_mm_loadu_ps(&src[j + 12]), max_ps);
+
+			__m128i lo = _mm_packs_epi32(x0, x1);
+			__m128i hi = _mm_packs_epi32(x2, x3);
+
+			_mm_storeu_si128((__m128i *)&dst[j], _mm_packus_epi16(lo, hi));
+		}
+		error_diffusion_store(src + j, dst + j, width - j, max);
+	}
+
+	void operator()(const float *src, uint16_t *dst, int width, float max) const
+	{
+		__m128 max_ps = _mm_set_ps1(max);
+		int j;
+
+		for (j = 0; j + 8 <= width; j += 8) {
+			__m128i lo = clamp_cvt_sse2(_mm_loadu_ps(&src[j + 0]), max_ps);
+			__m128i hi = clamp_cvt_sse2(_mm_loadu_ps(&src[j + 4]), max_ps);
+
+			_mm_storeu_si128((__m128i *)&dst[j], packus_epi32_sse2(lo, hi));
+		}
+		error_diffusion_store(src + j, dst + j, width - j, max);
+	}
+};
+
+class ErrorDiffusionSSE2 : public ErrorDiffusion {
+public:
+	explicit ErrorDiffusionSSE2(const ErrorDiffusionKernel &kernel) : ErrorDiffusion(kernel)
+	{}
+
+	void byte_to_byte(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void byte_to_word(const ImageTile<const uint8_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void word_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void word_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void half_to_byte(const ImageTile<const uint16_t> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadHalfSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void half_to_word(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadHalfSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void float_to_byte(const ImageTile<const float> &src, const ImageTile<uint8_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+
+	void float_to_word(const ImageTile<const float> &src, const ImageTile<uint16_t> &dst, float *tmp) const override
+	{
+		process(src, dst, tmp, LoadSSE2{}, AddErrorSSE2{}, StoreSSE2{});
+	}
+};
+
+} // namespace
+
+
+DitherConvert *create_error_diffusion_sse2(const ErrorDiffusionKernel &kernel)
+{
+	return new ErrorDiffusionSSE2{ kernel };
+}
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_X86
@@ -0,0 +1,35 @@
+#ifdef ZIMG_X86
+
+#include "Common/cpuinfo.h"
+#include "error_diffusion_x86.h"
+
+namespace zimg {;
+namespace depth {;
+
+DitherConvert *create_error_diffusion_x86(const ErrorDiffusionKernel &kernel, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	DitherConvert *ret;
+
+	if (cpu == CPUClass::CPU_X86_AUTO) {
+		if (caps.avx2)
+			ret = create_error_diffusion_avx2(kernel);
+		else if (caps.sse2)
+			ret = create_error_diffusion_sse2(kernel);
+		else
+			ret = nullptr;
+	} else if (cpu >= CPUClass::CPU_X86_AVX2) {
+		ret = create_error_diffusion_avx2(kernel);
+	} else if (cpu >= CPUClass::CPU_X86_SSE2) {
+		ret = create_error_diffusion_sse2(kernel);
+	} else {
+		ret = nullptr;
+	}
+
+	return ret;
+}
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_X86
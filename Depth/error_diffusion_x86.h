@@ -0,0 +1,26 @@
+#pragma once
+
+#ifdef ZIMG_X86
+
+#ifndef ZIMG_DEPTH_ERROR_DIFFUSION_X86_H_
+#define ZIMG_DEPTH_ERROR_DIFFUSION_X86_H_
+
+namespace zimg {;
+
+enum class CPUClass;
+
+namespace depth {;
+
+class DitherConvert;
+struct ErrorDiffusionKernel;
+
+DitherConvert *create_error_diffusion_sse2(const ErrorDiffusionKernel &kernel);
+DitherConvert *create_error_diffusion_avx2(const ErrorDiffusionKernel &kernel);
+
+DitherConvert *create_error_diffusion_x86(const ErrorDiffusionKernel &kernel, CPUClass cpu);
+
+} // namespace depth
+} // namespace zimg
+
+#endif // ZIMG_DEPTH_ERROR_DIFFUSION_X86_H_
+#endif // ZIMG_X86
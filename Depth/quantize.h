@@ -3,6 +3,7 @@
 #ifndef ZIMG_DEPTH_QUANTIZE_H_
 #define ZIMG_DEPTH_QUANTIZE_H_
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -155,6 +156,99 @@ public:
 	}
 };
 
+/**
+ * Fixed-point parameters for converting directly between integer formats.
+ * The result is clamp(((x * mul + add) >> shift) + offset, 0, max).
+ */
+struct IntegerConversionParams {
+	int32_t mul;
+	int32_t add;
+	int shift;
+	int32_t offset;
+	int32_t max;
+};
+
+/**
+ * Find fixed-point parameters giving the exactly rounded result of scaling
+ * between the ranges of two integer formats, for every input value.
+ *
+ * The exact result is floor((A * x + B) / D) with A = 2 * range_out, D = 2 * range_in, and B = range_in - A * offset_in,
+ * to which offset_out is added. The division is replaced by a multiplication and shift if the error bound
+ * of the reciprocal is below 1/D over the input range (Granlund and Montgomery).
+ *
+ * @param src input format
+ * @param dst output format
+ * @param params receives parameters on success
+ * @return true if suitable parameters exist, else false
+ */
+inline bool get_integer_conversion_params(const PixelFormat &src, const PixelFormat &dst, IntegerConversionParams *params)
+{
+	int64_t offset_in = integer_offset(src.depth, src.fullrange, src.chroma);
+	int64_t range_in = integer_range(src.depth, src.fullrange, src.chroma);
+	int64_t offset_out = integer_offset(dst.depth, dst.fullrange, dst.chroma);
+	int64_t range_out = integer_range(dst.depth, dst.fullrange, dst.chroma);
+
+	int64_t a = 2 * range_out;
+	int64_t d = 2 * range_in;
+	int64_t b = range_in - a * offset_in;
+	int64_t bias = 0;
+
+	// Make the numerator non-negative, subtracting the excess from the result.
+	if (b < 0) {
+		bias = (-b + d - 1) / d;
+		b += bias * d;
+	}
+
+	int64_t g = a;
+	int64_t r = d;
+
+	while (r) {
+		std::swap(g, r);
+		r %= g;
+	}
+
+	a /= g;
+	d /= g;
+	b /= g;
+
+	int64_t x_max = numeric_max(src.depth);
+	int64_t n_max = a * x_max + b;
+
+	for (int shift = 0; shift < 32; ++shift) {
+		int64_t m = ((1LL << shift) + d - 1) / d;
+		int64_t err = m * d - (1LL << shift);
+
+		if (n_max * err >= (1LL << shift))
+			continue;
+		if (a * m >= (1LL << 16) || n_max * m >= (1LL << 31))
+			return false;
+
+		params->mul = (int32_t)(a * m);
+		params->add = (int32_t)(b * m);
+		params->shift = shift;
+		params->offset = (int32_t)(offset_out - bias);
+		params->max = numeric_max(dst.depth);
+		return true;
+	}
+
+	return false;
+}
+
+template <class T, class U>
+class IntegerToInteger {
+	IntegerConversionParams params;
+public:
+	explicit IntegerToInteger(const IntegerConversionParams &params) : params(params)
+	{}
+
+	U operator()(T x) const
+	{
+		int32_t y = (int32_t)(((uint32_t)x * params.mul + params.add) >> params.shift) + params.offset;
+
+		return static_cast<U>(clamp(y, (int32_t)0, params.max));
+	}
+};
+
 template <class T>
 IntegerToFloat<T> make_integer_to_float(const PixelFormat &fmt)
 {
@@ -189,6 +189,45 @@ public:
 	}
 };
 
+class IntegerToIntegerAVX2 {
+	IntegerConversionParams params;
+public:
+	explicit IntegerToIntegerAVX2(const IntegerConversionParams &params) : params(params)
+	{}
+
+	/**
+	 * Convert sixteen unsigned 16-bit samples.
+	 *
+	 * @see IntegerToIntegerSSE2
+	 */
+	FORCE_INLINE __m256i operator()(__m256i x) const
+	{
+		__m256i mul = _mm256_set1_epi16((uint16_t)params.mul);
+		__m256i add = _mm256_set1_epi32(params.add);
+		__m128i shift = _mm_cvtsi32_si128(params.shift);
+		__m256i bias = _mm256_set1_epi16(INT16_MIN);
+		__m256i offset = _mm256_set1_epi32(params.offset + INT16_MIN);
+		__m256i max = _mm256_set1_epi16((int16_t)(params.max + INT16_MIN));
+
+		__m256i lo = _mm256_mullo_epi16(x, mul);
+		__m256i hi = _mm256_mulhi_epu16(x, mul);
+		__m256i x0 = _mm256_unpacklo_epi16(lo, hi);
+		__m256i x1 = _mm256_unpackhi_epi16(lo, hi);
+
+		x0 = _mm256_srl_epi32(_mm256_add_epi32(x0, add), shift);
+		x1 = _mm256_srl_epi32(_mm256_add_epi32(x1, add), shift);
+
+		x0 = _mm256_add_epi32(x0, offset);
+		x1 = _mm256_add_epi32(x1, offset);
+
+		x = _mm256_packs_epi32(x0, x1);
+		x = _mm256_min_epi16(x, max);
+		x = _mm256_xor_si256(x, bias);
+
+		return x;
+	}
+};
+
 inline IntegerToFloatAVX2 make_integer_to_float_avx2(const PixelFormat &fmt)
 {
 	return{ fmt.depth, fmt.fullrange, fmt.chroma };
@@ -243,6 +243,45 @@ public:
 	}
 };
 
+class IntegerToIntegerSSE2 {
+	IntegerConversionParams params;
+public:
+	explicit IntegerToIntegerSSE2(const IntegerConversionParams &params) : params(params)
+	{}
+
+	/**
+	 * Convert eight unsigned 16-bit samples.
+	 */
+	FORCE_INLINE __m128i operator()(__m128i x) const
+	{
+		__m128i mul = _mm_set1_epi16((uint16_t)params.mul);
+		__m128i add = _mm_set1_epi32(params.add);
+		__m128i shift = _mm_cvtsi32_si128(params.shift);
+		__m128i bias = _mm_set1_epi16(INT16_MIN);
+
+		// Offset and clamp in the signed domain so that saturation handles the lower bound.
+		__m128i offset = _mm_set1_epi32(params.offset + INT16_MIN);
+		__m128i max = _mm_set1_epi16((int16_t)(params.max + INT16_MIN));
+
+		__m128i lo = _mm_mullo_epi16(x, mul);
+		__m128i hi = _mm_mulhi_epu16(x, mul);
+		__m128i x0 = _mm_unpacklo_epi16(lo, hi);
+		__m128i x1 = _mm_unpackhi_epi16(lo, hi);
+
+		x0 = _mm_srl_epi32(_mm_add_epi32(x0, add), shift);
+		x1 = _mm_srl_epi32(_mm_add_epi32(x1, add), shift);
+
+		x0 = _mm_add_epi32(x0, offset);
+		x1 = _mm_add_epi32(x1, offset);
+
+		x = _mm_packs_epi32(x0, x1);
+		x = _mm_min_epi16(x, max);
+		x = _mm_xor_si128(x, bias);
+
+		return x;
+	}
+};
+
 inline IntegerToFloatSSE2 make_integer_to_float_sse2(const PixelFormat &fmt)
 {
 	return{ fmt.depth, fmt.fullrange, fmt.chroma };
@@ -29,6 +29,58 @@ double cube(double x)
 	return x * x * x;
 }
 
+bool rows_equal(const std::vector<double> &coeffs, size_t width, size_t a, size_t b)
+{
+	// Allow for rounding error in the computation of the sample positions.
+	const double epsilon = 1e-9;
+
+	for (size_t j = 0; j < width; ++j) {
+		if (std::abs(coeffs[a * width + j] - coeffs[b * width + j]) > epsilon)
+			return false;
+	}
+	return true;
+}
+
+std::vector<int> find_phases(const std::vector<double> &coeffs, size_t rows, size_t width)
+{
+	const size_t max_period = 256;
+
+	std::vector<int> phase(rows);
+
+	for (size_t i = 0; i < rows; ++i) {
+		phase[i] = (int)i;
+	}
+
+	// Search for the shortest period in the interior of the image.
+	// Rows near the edges are affected by mirroring and are stored separately.
+	for (size_t p = 1; p <= std::min(max_period, rows / 2); ++p) {
+		size_t mid = (rows - p) / 2;
+		size_t lo = mid;
+		size_t hi = mid;
+
+		if (!rows_equal(coeffs, width, mid, mid + p))
+			continue;
+
+		while (lo > 0 && rows_equal(coeffs, width, lo - 1, lo - 1 + p)) {
+			--lo;
+		}
+		while (hi + p < rows && rows_equal(coeffs, width, hi, hi + p)) {
+			++hi;
+		}
+
+		// Rows in the range [lo, hi + p) repeat with period p.
+		for (size_t i = lo; i < hi + p; ++i) {
+			phase[i] = (int)(lo + (i - lo) % p);
+		}
+		for (size_t i = hi + p; i < rows; ++i) {
+			phase[i] = (int)(lo + i - hi);
+		}
+		break;
+	}
+
+	return phase;
+}
+
 EvaluatedFilter matrix_to_filter(const RowMatrix<double> &m)
 {
 	size_t width = 0;
@@ -37,22 +89,43 @@ EvaluatedFilter matrix_to_filter(const RowMatrix<double> &m)
 		width = std::max(width, m.row_right(i) - m.row_left(i));
 	}
 
-	EvaluatedFilter e{ (int)width, (int)m.rows() };
+	std::vector<double> coeffs(m.rows() * width);
+	std::vector<int> left(m.rows());
 
 	for (size_t i = 0; i < m.rows(); ++i) {
-		int left = (int)std::min(m.row_left(i), m.cols() - width);
+		left[i] = (int)std::min(m.row_left(i), m.cols() - width);
 
 		for (size_t j = 0; j < width; ++j) {
-			float coeff = (float)m[i][left + j];
-			int16_t coeff_i16 = (int16_t)std::round(coeff * (float)(1 << 14));
+			coeffs[i * width + j] = m[i][left[i] + j];
+		}
+	}
+
+	std::vector<int> phase = find_phases(coeffs, m.rows(), width);
+	int phases = *std::max_element(phase.begin(), phase.end()) + 1;
 
-			e.data()[(ptrdiff_t)i * e.stride() + j] = coeff;
-			e.data_i16()[(ptrdiff_t)i * e.stride_i16() + j] = coeff_i16;
+	EvaluatedFilter e{ (int)width, (int)m.rows(), phases };
+	int next_phase = 0;
+
+	for (size_t i = 0; i < m.rows(); ++i) {
+		int n = phase[i];
+
+		// Phases are numbered in order of first occurrence.
+		if (n == next_phase) {
+			for (size_t j = 0; j < width; ++j) {
+				float coeff = (float)coeffs[i * width + j];
+				int16_t coeff_i16 = (int16_t)std::round(coeff * (float)(1 << 14));
+
+				e.data()[(ptrdiff_t)n * e.stride() + j] = coeff;
+				e.data_i16()[(ptrdiff_t)n * e.stride_i16() + j] = coeff_i16;
+			}
+			++next_phase;
 		}
-		e.left()[i] = left;
+		e.left()[i] = left[i];
+		e.phase()[i] = n;
 	}
 	for (size_t i = m.rows(); i < ceil_n(m.rows(), 64); ++i) {
 		e.left()[i] = e.left()[m.rows() - 1];
+		e.phase()[i] = e.phase()[m.rows() - 1];
 	}
 
 	return e;
@@ -170,13 +243,16 @@ double LanczosFilter::operator()(double x) const
 }
 
 
-EvaluatedFilter::EvaluatedFilter(int width, int height) :
+EvaluatedFilter::EvaluatedFilter(int width, int height, int phases) :
 	m_width{ width },
+	m_height{ height },
 	m_stride{ ceil_n(width, AlignmentOf<float>::value) },
 	m_stride_i16{ ceil_n(width, AlignmentOf<int16_t>::value) },
-	m_data((size_t)m_stride * ceil_n(height, 64)),
-	m_data_i16((size_t)m_stride_i16 * ceil_n(height, 64)),
-	m_left(ceil_n(height, 64))
+	m_phases{ phases },
+	m_data((size_t)m_stride * phases),
+	m_data_i16((size_t)m_stride_i16 * phases),
+	m_left(ceil_n(height, 64)),
+	m_phase(ceil_n(height, 64))
 {
 }
 
@@ -185,6 +261,11 @@ int EvaluatedFilter::width() const
 	return m_width;
 }
 
+int EvaluatedFilter::height() const
+{
+	return m_height;
+}
+
 int EvaluatedFilter::stride() const
 {
 	return m_stride;
@@ -195,6 +276,11 @@ int EvaluatedFilter::stride_i16() const
 	return m_stride_i16;
 }
 
+int EvaluatedFilter::phases() const
+{
+	return m_phases;
+}
+
 float *EvaluatedFilter::data()
 {
 	return m_data.data();
@@ -225,8 +311,23 @@ const int *EvaluatedFilter::left() const
 	return m_left.data();
 }
 
+int *EvaluatedFilter::phase()
+{
+	return m_phase.data();
+}
+
+const int *EvaluatedFilter::phase() const
+{
+	return m_phase.data();
+}
+
 
 EvaluatedFilter compute_filter(const Filter &f, int src_dim, int dst_dim, double shift, double width)
+{
+	return matrix_to_filter(compute_filter_matrix(f, src_dim, dst_dim, shift, width));
+}
+
+RowMatrix<double> compute_filter_matrix(const Filter &f, int src_dim, int dst_dim, double shift, double width)
 {
 	double scale = (double)dst_dim / width;
 	double step = std::min(scale, 1.0);
@@ -271,7 +372,7 @@ EvaluatedFilter compute_filter(const Filter &f, int src_dim, int dst_dim, double
 		}
 	}
 
-	return matrix_to_filter(m);
+	return m;
 }
 
 } // namespace resize
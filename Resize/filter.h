@@ -8,6 +8,10 @@
 #include "Common/align.h"
 
 namespace zimg {;
+
+template <class T>
+class RowMatrix;
+
 namespace resize {;
 
 /**
@@ -112,14 +116,21 @@ public:
 
 /**
  * Computed filter taps for a given scale and shift.
+ *
+ * Rows with identical taps share a single row of coefficients. At rational
+ * scale factors, the taps repeat with a short period, so the coefficient
+ * table holds only one period of phases, plus any rows near the image edges.
  */
 class EvaluatedFilter {
 	int m_width;
+	int m_height;
 	int m_stride;
 	int m_stride_i16;
+	int m_phases;
 	AlignedVector<float> m_data;
 	AlignedVector<int16_t> m_data_i16;
 	AlignedVector<int> m_left;
+	AlignedVector<int> m_phase;
 public:
 	/**
 	 * Initialize an empty EvaluatedFilter.
@@ -131,14 +142,20 @@ public:
 	 *
 	 * @param width filter (not matrix) width
 	 * @param height matrix height
+	 * @param phases number of distinct coefficient rows
 	 */
-	EvaluatedFilter(int width, int height);
+	EvaluatedFilter(int width, int height, int phases);
 
 	/**
 	 * @return filter width
 	 */
 	int width() const;
 
+	/**
+	 * @return matrix height
+	 */
+	int height() const;
+
 	/**
 	 * @return distance betwen filter rows in floats
 	 */
@@ -149,6 +166,11 @@ public:
 	 */
 	int stride_i16() const;
 
+	/**
+	 * @return number of distinct coefficient rows
+	 */
+	int phases() const;
+
 	/**
 	 * @return pointer to filter coefficients
 	 */
@@ -178,6 +200,16 @@ public:
 	 * @see EvaluatedFilter::left()
 	 */
 	const int *left() const;
+
+	/**
+	 * @return pointer to coefficient row index for each matrix row
+	 */
+	int *phase();
+
+	/**
+	 * @see EvaluatedFilter::phase()
+	 */
+	const int *phase() const;
 };
 
 /**
@@ -194,6 +226,13 @@ public:
  */
 EvaluatedFilter compute_filter(const Filter &f, int src_dim, int dst_dim, double shift, double width);
 
+/**
+ * Compute the resizing matrix of dimension (dst_dim, src_dim) without packing it into an EvaluatedFilter.
+ *
+ * @see compute_filter
+ */
+RowMatrix<double> compute_filter_matrix(const Filter &f, int src_dim, int dst_dim, double shift, double width);
+
 } // namespace resize
 } // namespace zimg
 
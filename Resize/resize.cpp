@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cstddef>
+#include "Common/align.h"
 #include "Common/except.h"
 #include "Common/pixel.h"
 #include "Common/tile.h"
@@ -31,6 +32,9 @@ void Resize::dependent_rect(int dst_top, int dst_left, int dst_bottom, int dst_r
 void Resize::process(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j) const
 {
 	switch (src.descriptor()->format.type) {
+	case PixelType::BYTE:
+		m_impl->process_u8(tile_cast<const uint8_t>(src), tile_cast<uint8_t>(dst), i, j);
+		break;
 	case PixelType::WORD:
 		m_impl->process_u16(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), i, j);
 		break;
@@ -41,7 +45,88 @@ void Resize::process(const ImageTile<const void> &src, const ImageTile<void> &ds
 		m_impl->process_f32(tile_cast<const float>(src), tile_cast<float>(dst), i, j);
 		break;
 	default:
-		throw ZimgUnsupportedError{ "only WORD, HALF, and FLOAT are supported for resize" };
+		throw ZimgUnsupportedError{ "unknown pixel type" };
+	}
+}
+
+void Resize::process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int top, int left, int bottom, int right) const
+{
+	switch (src.descriptor()->format.type) {
+	case PixelType::BYTE:
+		m_impl->process_plane_u8(tile_cast<const uint8_t>(src), tile_cast<uint8_t>(dst), top, left, bottom, right);
+		break;
+	case PixelType::WORD:
+		m_impl->process_plane_u16(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), top, left, bottom, right);
+		break;
+	case PixelType::HALF:
+		m_impl->process_plane_f16(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), top, left, bottom, right);
+		break;
+	case PixelType::FLOAT:
+		m_impl->process_plane_f32(tile_cast<const float>(src), tile_cast<float>(dst), top, left, bottom, right);
+		break;
+	default:
+		throw ZimgUnsupportedError{ "unknown pixel type" };
+	}
+}
+
+int Resize::tmp_input_stride() const
+{
+	int cols = m_horizontal ? m_impl->max_dependent_extent() : TILE_WIDTH;
+
+	// Allow the kernels to read past the end of each scanline.
+	return ceil_n(cols + TILE_WIDTH, AlignmentOf<float>::value);
+}
+
+size_t Resize::tmp_size_input() const
+{
+	int rows = m_horizontal ? TILE_HEIGHT : m_impl->max_dependent_extent();
+	return (size_t)rows * tmp_input_stride();
+}
+
+void Resize::process_alpha(const ImageTile<const void> &src, const ImageTile<const void> *src_alpha,
+                           const ImageTile<void> &dst, const ImageTile<const void> *dst_alpha, int i, int j, void *tmp) const
+{
+	if (src.descriptor()->format.type != PixelType::FLOAT || dst.descriptor()->format.type != PixelType::FLOAT)
+		throw ZimgUnsupportedError{ "only FLOAT is supported for alpha resize" };
+
+	ImageTile<const float> src_tile = tile_cast<const float>(src);
+	ImageTile<float> dst_tile = tile_cast<float>(dst);
+
+	if (src_alpha) {
+		PlaneDescriptor tmp_desc{ PixelType::FLOAT };
+		ImageTile<float> tmp_tile{ static_cast<float *>(tmp), &tmp_desc, tmp_input_stride() * (int)sizeof(float) };
+		ImageTile<const float> alpha_tile = tile_cast<const float>(*src_alpha);
+		int top, left, bottom, right;
+
+		dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &top, &left, &bottom, &right);
+
+		for (int ii = 0; ii < bottom - top; ++ii) {
+			const float *src_ptr = src_tile[ii];
+			const float *alpha_ptr = alpha_tile[ii];
+			float *tmp_ptr = tmp_tile[ii];
+
+			for (int jj = 0; jj < right - left; ++jj) {
+				tmp_ptr[jj] = src_ptr[jj] * alpha_ptr[jj];
+			}
+		}
+
+		m_impl->process_f32(tmp_tile, dst_tile, i, j);
+	} else {
+		m_impl->process_f32(src_tile, dst_tile, i, j);
+	}
+
+	if (dst_alpha) {
+		ImageTile<const float> alpha_tile = tile_cast<const float>(*dst_alpha);
+
+		for (int ii = 0; ii < TILE_HEIGHT; ++ii) {
+			const float *alpha_ptr = alpha_tile[ii];
+			float *dst_ptr = dst_tile[ii];
+
+			for (int jj = 0; jj < TILE_WIDTH; ++jj) {
+				float a = alpha_ptr[jj];
+				dst_ptr[jj] = a > 0.0f ? dst_ptr[jj] / a : 0.0f;
+			}
+		}
 	}
 }
 
@@ -81,6 +81,53 @@ public:
 	 * @throws ZimgUnsupportedError if pixel type not supported
 	 */
 	void process(const ImageTile<const void> &src, const ImageTile<void> &dst, int i, int j) const;
+
+	/**
+	 * Process a rectangle of output tiles, selecting the pixel type once for the whole rectangle.
+	 * The input tile must correspond to the input sub-rectangle of the output rectangle (@see Resize::dependent_rect).
+	 *
+	 * @param src input tile
+	 * @param dst output tile at the top-left of the output rectangle
+	 * @param top row index of output rectangle
+	 * @param left column index of output rectangle
+	 * @param bottom bottom row index of output rectangle, such that the height is a multiple of TILE_HEIGHT
+	 * @param right right column index of output rectangle, such that the width is a multiple of TILE_WIDTH
+	 * @throws ZimgUnsupportedError if pixel type not supported
+	 */
+	void process_plane(const ImageTile<const void> &src, const ImageTile<void> &dst, int top, int left, int bottom, int right) const;
+
+	/**
+	 * Get the stride of a FLOAT tile able to hold the input rectangle of any output tile,
+	 * including the padding read past the end of each scanline by the kernels.
+	 *
+	 * @return stride in units of floats
+	 */
+	int tmp_input_stride() const;
+
+	/**
+	 * Get the size of the temporary buffer required to stage an input tile in FLOAT,
+	 * as used by Resize::process_alpha.
+	 *
+	 * @return the size of the temporary buffer in units of floats
+	 */
+	size_t tmp_size_input() const;
+
+	/**
+	 * Process a color tile with associated (straight) alpha, filtering the color premultiplied by alpha to avoid halos.
+	 * For a two pass resize, the first pass premultiplies and the second pass unpremultiplies,
+	 * with the intermediate image remaining premultiplied. Only FLOAT is supported.
+	 *
+	 * @param src input tile, as in Resize::process
+	 * @param src_alpha alpha tile covering the same pixels as src, or nullptr if src is already premultiplied
+	 * @param dst output tile
+	 * @param dst_alpha resized alpha tile at the position of dst, or nullptr to keep dst premultiplied
+	 * @param i row index of output tile
+	 * @param j column index of output tile
+	 * @param tmp temporary buffer (@see Resize::tmp_size_input)
+	 * @throws ZimgUnsupportedError if pixel type not supported
+	 */
+	void process_alpha(const ImageTile<const void> &src, const ImageTile<const void> *src_alpha,
+	                   const ImageTile<void> &dst, const ImageTile<const void> *dst_alpha, int i, int j, void *tmp) const;
 };
 
 /**
@@ -16,7 +16,7 @@ struct ScalarPolicy_U16 {
 
 	int32_t coeff(const EvaluatedFilter &filter, int row, int k)
 	{
-		return filter.data_i16()[row * filter.stride_i16() + k];
+		return filter.data_i16()[filter.phase()[row] * filter.stride_i16() + k];
 	}
 
 	int32_t load(const uint16_t *src)
@@ -42,7 +42,7 @@ struct ScalarPolicy_F32 {
 
 	float coeff(const EvaluatedFilter &filter, int row, int k)
 	{
-		return filter.data()[row * filter.stride() + k];
+		return filter.data()[filter.phase()[row] * filter.stride() + k];
 	}
 
 	float load(const float *src) { return *src; }
@@ -102,10 +102,43 @@ void resize_tile_v_scalar(const EvaluatedFilter &filter, const ImageTile<const T
 	}
 }
 
+template <class T>
+void resize_tile_h_point(const EvaluatedFilter &filter, const ImageTile<const T> &src, const ImageTile<T> &dst, int n)
+{
+	const int *filter_left = &filter.left()[n];
+	int left_base = filter_left[0];
+	int offset[TILE_WIDTH];
+
+	for (int j = 0; j < TILE_WIDTH; ++j) {
+		offset[j] = filter_left[j] - left_base;
+	}
+
+	for (int i = 0; i < TILE_HEIGHT; ++i) {
+		const T *src_ptr = src[i];
+		T *dst_ptr = dst[i];
+
+		for (int j = 0; j < TILE_WIDTH; ++j) {
+			dst_ptr[j] = src_ptr[offset[j]];
+		}
+	}
+}
+
+template <class T>
+void resize_tile_v_point(const EvaluatedFilter &filter, const ImageTile<const T> &src, const ImageTile<T> &dst, int n)
+{
+	const int *filter_left = &filter.left()[n];
+	int top_base = filter_left[0];
+
+	for (int i = 0; i < TILE_HEIGHT; ++i) {
+		const T *src_ptr = src[filter_left[i] - top_base];
+		std::copy_n(src_ptr, TILE_WIDTH, dst[i]);
+	}
+}
 
-class ResizeImplH_C final : public ResizeImpl {
+
+class ResizeImplH_C final : public ResizeImplPlane<ResizeImplH_C> {
 public:
-	ResizeImplH_C(const EvaluatedFilter &filter) : ResizeImpl(filter, true)
+	ResizeImplH_C(const EvaluatedFilter &filter) : ResizeImplPlane(filter, true)
 	{
 	}
 
@@ -132,9 +165,9 @@ public:
 	}
 };
 
-class ResizeImplV_C final : public ResizeImpl {
+class ResizeImplV_C final : public ResizeImplPlane<ResizeImplV_C> {
 public:
-	ResizeImplV_C(const EvaluatedFilter &filter) : ResizeImpl(filter, false)
+	ResizeImplV_C(const EvaluatedFilter &filter) : ResizeImplPlane(filter, false)
 	{
 	}
 
@@ -161,6 +194,52 @@ public:
 	}
 };
 
+/**
+ * Point resize. Each output pixel is a copy of exactly one input pixel,
+ * so pixels are moved without arithmetic and every pixel type is supported.
+ */
+class ResizeImplPoint final : public ResizeImplPlane<ResizeImplPoint> {
+	bool m_horizontal;
+
+	template <class T>
+	void process(const ImageTile<const T> &src, const ImageTile<T> &dst, int i, int j) const
+	{
+		if (m_horizontal)
+			resize_tile_h_point(m_filter, src, dst, j);
+		else
+			resize_tile_v_point(m_filter, src, dst, i);
+	}
+public:
+	ResizeImplPoint(const EvaluatedFilter &filter, bool horizontal) : ResizeImplPlane(filter, horizontal), m_horizontal{ horizontal }
+	{
+	}
+
+	bool pixel_supported(PixelType type) const override
+	{
+		return true;
+	}
+
+	void process_u8(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, int i, int j) const override
+	{
+		process(src, dst, i, j);
+	}
+
+	void process_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
+	{
+		process(src, dst, i, j);
+	}
+
+	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
+	{
+		process(src, dst, i, j);
+	}
+
+	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const override
+	{
+		process(src, dst, i, j);
+	}
+};
+
 } // namespace
 
 
@@ -172,6 +251,11 @@ ResizeImpl::~ResizeImpl()
 {
 }
 
+void ResizeImpl::process_u8(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, int i, int j) const
+{
+	throw ZimgUnsupportedError{ "u8 not supported in resize impl" };
+}
+
 void ResizeImpl::dependent_rect(int dst_top, int dst_left, int dst_bottom, int dst_right, int *src_top, int *src_left, int *src_bottom, int *src_right) const
 {
 	if (m_horizontal) {
@@ -193,13 +277,32 @@ void ResizeImpl::dependent_rect(int dst_top, int dst_left, int dst_bottom, int d
 	}
 }
 
+int ResizeImpl::max_dependent_extent() const
+{
+	int extent = 0;
+
+	for (int n = 0; n < m_filter.height(); n += TILE_WIDTH) {
+		extent = std::max(extent, m_filter.left()[n + TILE_WIDTH - 1] + m_filter.width() - m_filter.left()[n]);
+	}
+
+	return extent;
+}
+
 ResizeImpl *create_resize_impl(const Filter &f, bool horizontal, int src_dim, int dst_dim, double shift, double width, CPUClass cpu)
 {
 	EvaluatedFilter filter = compute_filter(f, src_dim, dst_dim, shift, width);
 	ResizeImpl *ret = nullptr;
 
+	// A single tap filter selects one input pixel with unit weight, so the pass reduces to a copy.
+	if (filter.width() == 1)
+		return new ResizeImplPoint(filter, horizontal);
+
 #ifdef ZIMG_X86
-	ret = create_resize_impl_x86(filter, horizontal, cpu);
+	// Exact 2x and 4x horizontal downscaling has the same coefficients for every pixel away from the edges.
+	if (horizontal && width == src_dim && (src_dim == dst_dim * 2 || src_dim == dst_dim * 4))
+		ret = create_resize_impl_decimate_x86(filter, src_dim / dst_dim, cpu);
+	if (!ret)
+		ret = create_resize_impl_x86(filter, horizontal, cpu);
 #endif
 	if (!ret)
 		ret = horizontal ? (ResizeImpl *)new ResizeImplH_C(filter) : (ResizeImpl *)new ResizeImplV_C(filter);
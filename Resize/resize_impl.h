@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cstdint>
 #include "Common/osdep.h"
+#include "Common/tile.h"
 #include "filter.h"
 
 namespace zimg {;
@@ -13,9 +14,6 @@ namespace zimg {;
 enum class CPUClass;
 enum class PixelType;
 
-template <class T>
-class ImageTile;
-
 namespace resize {;
 
 /**
@@ -36,6 +34,7 @@ protected:
 	 * @param horizontal whether filter is a horizontal resize
 	 */
 	ResizeImpl(const EvaluatedFilter &filter, bool horizontal);
+
 public:
 	/**
 	 * Destroy implementation.
@@ -56,6 +55,13 @@ public:
 	 */
 	void dependent_rect(int dst_top, int dst_left, int dst_bottom, int dst_right, int *src_top, int *src_left, int *src_bottom, int *src_right) const;
 
+	/**
+	 * Get the largest number of input pixels required to process an output tile, in the direction of the filter.
+	 *
+	 * @return input extent
+	 */
+	int max_dependent_extent() const;
+
 	/**
 	 * Check if conversion supports the given pixel type.
 	 *
@@ -64,6 +70,14 @@ public:
 	 */
 	virtual bool pixel_supported(PixelType type) const = 0;
 
+	/**
+	 * Execute filter pass on an unsigned 8-bit image.
+	 * Only implementations which do not perform arithmetic on pixels support bytes.
+	 *
+	 * @see ResizeImpl::process_u16_h
+	 */
+	virtual void process_u8(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, int i, int j) const;
+
 	/**
 	 * Execute filter pass on an unsigned 16-bit image.
 	 *
@@ -89,6 +103,115 @@ public:
 	 * @see ResizeImpl::process_u16_h
 	 */
 	virtual void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const = 0;
+
+	/**
+	 * Execute filter pass on a rectangle of output tiles of an unsigned 8-bit image.
+	 *
+	 * @see ResizeImpl::process_plane_u16
+	 */
+	virtual void process_plane_u8(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, int top, int left, int bottom, int right) const = 0;
+
+	/**
+	 * Execute filter pass on a rectangle of output tiles of an unsigned 16-bit image.
+	 * The pixel type is selected once for the rectangle, and the tiles are processed in a loop within the implementation.
+	 *
+	 * @param src input tile containing the input rectangle of the output rectangle (@see ResizeImpl::dependent_rect)
+	 * @param dst output tile at the top-left of the output rectangle
+	 * @param top row index of output rectangle
+	 * @param left column index of output rectangle
+	 * @param bottom bottom row index of output rectangle, such that the height is a multiple of TILE_HEIGHT
+	 * @param right right column index of output rectangle, such that the width is a multiple of TILE_WIDTH
+	 * @throws ZimgUnsupportedError if not supported
+	 */
+	virtual void process_plane_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int top, int left, int bottom, int right) const = 0;
+
+	/**
+	 * Execute filter pass on a rectangle of output tiles of a half precision 16-bit image.
+	 *
+	 * @see ResizeImpl::process_plane_u16
+	 */
+	virtual void process_plane_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int top, int left, int bottom, int right) const = 0;
+
+	/**
+	 * Execute filter pass on a rectangle of output tiles of a single precision 32-bit image.
+	 *
+	 * @see ResizeImpl::process_plane_u16
+	 */
+	virtual void process_plane_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int top, int left, int bottom, int right) const = 0;
+};
+
+/**
+ * Helper for concrete implementations, providing the rectangle functions as loops over the tile functions of Derived,
+ * each tile reading its own input rectangle from the input tile of the rectangle (@see for_each_tile).
+ *
+ * @param Derived concrete implementation
+ */
+template <class Derived>
+class ResizeImplPlane : public ResizeImpl {
+	const Derived &derived() const
+	{
+		return static_cast<const Derived &>(*this);
+	}
+
+	/**
+	 * Apply a tile function to each output tile of a rectangle consisting of whole tiles,
+	 * passing each function call the input tile given by ResizeImpl::dependent_rect for its output tile.
+	 *
+	 * @param src input tile containing the input rectangle of the output rectangle
+	 * @param dst output tile at the top-left of the output rectangle
+	 * @param top row index of output rectangle
+	 * @param left column index of output rectangle
+	 * @param bottom bottom row index of output rectangle
+	 * @param right right column index of output rectangle
+	 * @param func func(src_tile, dst_tile, i, j), as in ResizeImpl::process_u16
+	 */
+	template <class T, class Func>
+	void for_each_dependent_tile(const ImageTile<const T> &src, const ImageTile<T> &dst, int top, int left, int bottom, int right, Func func) const
+	{
+		int src_top, src_left, src_bottom, src_right;
+
+		dependent_rect(top, left, bottom, right, &src_top, &src_left, &src_bottom, &src_right);
+
+		for (int i = top; i < bottom; i += TILE_HEIGHT) {
+			for (int j = left; j < right; j += TILE_WIDTH) {
+				int tile_top, tile_left, tile_bottom, tile_right;
+
+				dependent_rect(i, j, i + TILE_HEIGHT, j + TILE_WIDTH, &tile_top, &tile_left, &tile_bottom, &tile_right);
+				func(src.sub_tile(tile_top - src_top, tile_left - src_left), dst.sub_tile(i - top, j - left), i, j);
+			}
+		}
+	}
+protected:
+	/**
+	 * @see ResizeImpl::ResizeImpl
+	 */
+	ResizeImplPlane(const EvaluatedFilter &filter, bool horizontal) : ResizeImpl(filter, horizontal)
+	{
+	}
+public:
+	void process_plane_u8(const ImageTile<const uint8_t> &src, const ImageTile<uint8_t> &dst, int top, int left, int bottom, int right) const override
+	{
+		for_each_dependent_tile(src, dst, top, left, bottom, right,
+		                        [this](const ImageTile<const uint8_t> &s, const ImageTile<uint8_t> &d, int i, int j) { derived().process_u8(s, d, i, j); });
+	}
+
+	void process_plane_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int top, int left, int bottom, int right) const override
+	{
+		for_each_dependent_tile(src, dst, top, left, bottom, right,
+		                        [this](const ImageTile<const uint16_t> &s, const ImageTile<uint16_t> &d, int i, int j) { derived().process_u16(s, d, i, j); });
+	}
+
+	void process_plane_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int top, int left, int bottom, int right) const override
+	{
+		for_each_dependent_tile(src, dst, top, left, bottom, right,
+		                        [this](const ImageTile<const uint16_t> &s, const ImageTile<uint16_t> &d, int i, int j) { derived().process_f16(s, d, i, j); });
+	}
+
+	void process_plane_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int top, int left, int bottom, int right) const override
+	{
+		for_each_dependent_tile(src, dst, top, left, bottom, right,
+		                        [this](const ImageTile<const float> &s, const ImageTile<float> &d, int i, int j) { derived().process_f32(s, d, i, j); });
+	}
 };
 
 /**
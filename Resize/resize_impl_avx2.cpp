@@ -112,14 +112,15 @@ inline FORCE_INLINE __m256i pack_i30_epi32(__m256i lo, __m256i hi)
 	return  _mm256_packs_epi32(lo, hi);
 }
 
-template <bool DoLoop>
+template <int Taps>
 void resize_tile_u16_h_avx2(const EvaluatedFilter &filter, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int n)
 {
 	__m256i INT16_MIN_EPI16 = _mm256_set1_epi16(INT16_MIN);
 
 	int filter_stride = filter.stride_i16();
 
-	const int16_t *filter_data = &filter.data_i16()[n * filter_stride];
+	const int16_t *filter_data = filter.data_i16();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int left_base = filter_left[0];
@@ -147,10 +148,10 @@ void resize_tile_u16_h_avx2(const EvaluatedFilter &filter, const ImageTile<const
 			__m256i accum = _mm256_setzero_si256();
 			__m256i cached[16];
 
-			const int16_t *filter_row = &filter_data[j * filter_stride];
+			const int16_t *filter_row = &filter_data[filter_phase[j] * filter_stride];
 			int left = filter_left[j] - left_base;
 
-			for (int k = 0; k < (DoLoop ? filter.width() : 16); k += 16) {
+			for (int k = 0; k < (Taps ? Taps : filter.width()); k += 16) {
 				__m256i coeff = _mm256_load_si256((const __m256i *)&filter_row[k]);
 				__m256i x0, x1, x2, x3, x4, x5, x6, x7;
 
@@ -244,12 +245,13 @@ void resize_tile_u16_h_avx2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
-template <bool DoLoop, class T, class Policy>
+template <int Taps, class T, class Policy>
 void resize_tile_fp_h_avx2(const EvaluatedFilter &filter, const ImageTile<const T> &src, const ImageTile<T> &dst, int n, Policy policy)
 {
 	int filter_stride = filter.stride();
 
-	const float *filter_data = &filter.data()[n * filter_stride];
+	const float *filter_data = filter.data();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int left_base = filter_left[0];
@@ -277,10 +279,10 @@ void resize_tile_fp_h_avx2(const EvaluatedFilter &filter, const ImageTile<const
 			__m256 accum = _mm256_setzero_ps();
 			__m256 cached[8];
 
-			const float *filter_row = &filter_data[j * filter_stride];
+			const float *filter_row = &filter_data[filter_phase[j] * filter_stride];
 			int left = filter_left[j] - left_base;
 
-			for (int k = 0; k < (DoLoop ? filter.width() : 8); k += 8) {
+			for (int k = 0; k < (Taps ? Taps : filter.width()); k += 8) {
 				__m256 coeff = _mm256_load_ps(filter_row + k);
 				__m256 x0, x1, x2, x3, x4, x5, x6, x7;
 
@@ -341,25 +343,28 @@ void resize_tile_fp_h_avx2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
+template <int Taps>
 void resize_tile_u16_v_avx2(const EvaluatedFilter &filter, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int n)
 {
 	__m256i INT16_MIN_EPI16 = _mm256_set1_epi16(INT16_MIN);
-	__m256i tmp_m256i[TILE_WIDTH / 8];
+	__m256i tmp_m256i[TILE_WIDTH / 4];
 	uint32_t *tmp = (uint32_t *)tmp_m256i;
 
+	int filter_width = Taps ? Taps : filter.width();
 	int filter_stride = filter.stride_i16();
 
-	const int16_t *filter_data = &filter.data_i16()[n * filter_stride];
+	const int16_t *filter_data = filter.data_i16();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int top_base = filter_left[0];
 
 	for (int i = 0; i < TILE_HEIGHT; ++i) {
-		const int16_t *filter_row = &filter_data[i * filter_stride];
+		const int16_t *filter_row = &filter_data[filter_phase[i] * filter_stride];
 		int top = filter_left[i] - top_base;
 		uint16_t *dst_ptr = dst[i];
 
-		for (int k = 0; k < floor_n(filter.width(), 8); k += 8) {
+		for (int k = 0; k < floor_n(filter_width, 8); k += 8) {
 			const uint16_t *src_ptr0 = src[top + k + 0];
 			const uint16_t *src_ptr1 = src[top + k + 1];
 			const uint16_t *src_ptr2 = src[top + k + 2];
@@ -424,7 +429,7 @@ void resize_tile_u16_v_avx2(const EvaluatedFilter &filter, const ImageTile<const
 					accum0h = _mm256_add_epi32(accum0h, _mm256_load_si256((const __m256i *)&tmp[j * 2 + 8]));
 				}
 
-				if (k == filter.width() - 8) {					
+				if (k == filter_width - 8) {					
 					packed = pack_i30_epi32(accum0l, accum0h);
 					packed = _mm256_sub_epi16(packed, INT16_MIN_EPI16);
 					_mm256_store_si256((__m256i *)&dst_ptr[j], packed);
@@ -434,9 +439,9 @@ void resize_tile_u16_v_avx2(const EvaluatedFilter &filter, const ImageTile<const
 				}
 			}
 		}
-		if (filter.width() % 8) {
-			int m = filter.width() % 8;
-			int k = filter.width() - m;
+		if (filter_width % 8) {
+			int m = filter_width % 8;
+			int k = filter_width - m;
 
 			const uint16_t *src_ptr0 = src[top + k + 0];
 			const uint16_t *src_ptr1 = src[top + k + 1];
@@ -515,22 +520,24 @@ void resize_tile_u16_v_avx2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
-template <class T, class Policy>
+template <int Taps, class T, class Policy>
 void resize_tile_fp_v_avx2(const EvaluatedFilter &filter, const ImageTile<const T> &src, const ImageTile<T> &dst, int n, Policy policy)
 {
+	int filter_width = Taps ? Taps : filter.width();
 	int filter_stride = filter.stride();
 
-	const float *filter_data = &filter.data()[n * filter_stride];
+	const float *filter_data = filter.data();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int top_base = filter_left[0];
 
 	for (int i = 0; i < TILE_HEIGHT; ++i) {
-		const float *filter_row = &filter_data[i * filter_stride];
+		const float *filter_row = &filter_data[filter_phase[i] * filter_stride];
 		int top = filter_left[i] - top_base;
 		T *dst_ptr = dst[i];
 
-		for (int k = 0; k < floor_n(filter.width(), 8); k += 8) {
+		for (int k = 0; k < floor_n(filter_width, 8); k += 8) {
 			const T *src_ptr0 = src[top + k + 0];
 			const T *src_ptr1 = src[top + k + 1];
 			const T *src_ptr2 = src[top + k + 2];
@@ -587,9 +594,9 @@ void resize_tile_fp_v_avx2(const EvaluatedFilter &filter, const ImageTile<const
 				policy.store_8(&dst_ptr[j], accum0);
 			}
 		}
-		if (filter.width() % 8) {
-			int m = filter.width() % 8;
-			int k = filter.width() - m;
+		if (filter_width % 8) {
+			int m = filter_width % 8;
+			int k = filter_width - m;
 
 			const T *src_ptr0 = src[top + k + 0];
 			const T *src_ptr1 = src[top + k + 1];
@@ -652,9 +659,120 @@ void resize_tile_fp_v_avx2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
-class ResizeImplH_AVX2 final : public ResizeImpl {
+// Performs 2x or 4x horizontal decimation with the same coefficients for every output pixel.
+// The coefficients are stored as one group of N taps per vector, repeated across the vector.
+template <int N>
+void decimate_tile_u16_h_avx2(const EvaluatedFilter &filter, const int16_t *coeffs, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst)
+{
+	__m256i INT16_MIN_EPI16 = _mm256_set1_epi16(INT16_MIN);
+	int groups = filter.width() / N;
+
+	for (int i = 0; i < TILE_HEIGHT; ++i) {
+		const uint16_t *src_ptr = src[i];
+		uint16_t *dst_ptr = dst[i];
+
+		for (int j = 0; j < TILE_WIDTH; j += 16) {
+			__m256i accum[2];
+
+			for (int jj = 0; jj < 2; ++jj) {
+				const uint16_t *src_p = &src_ptr[(j + jj * 8) * N];
+				__m256i accum0 = _mm256_setzero_si256();
+				__m256i accum1 = _mm256_setzero_si256();
+
+				for (int m = 0; m < groups; ++m) {
+					__m256i coeff = _mm256_load_si256((const __m256i *)&coeffs[m * 16]);
+					__m256i x0, x1;
+
+					x0 = _mm256_loadu_si256((const __m256i *)&src_p[m * N + 0]);
+					x0 = _mm256_add_epi16(x0, INT16_MIN_EPI16);
+					x0 = _mm256_madd_epi16(coeff, x0);
+
+					if (N == 4) {
+						x1 = _mm256_loadu_si256((const __m256i *)&src_p[m * N + 16]);
+						x1 = _mm256_add_epi16(x1, INT16_MIN_EPI16);
+						x1 = _mm256_madd_epi16(coeff, x1);
+
+						accum1 = _mm256_add_epi32(accum1, x1);
+					}
+					accum0 = _mm256_add_epi32(accum0, x0);
+				}
+
+				// Sum adjacent pairs and restore pixel order: [0 1 4 5 2 3 6 7].
+				if (N == 4) {
+					accum0 = _mm256_hadd_epi32(accum0, accum1);
+					accum0 = _mm256_permute4x64_epi64(accum0, _MM_SHUFFLE(3, 1, 2, 0));
+				}
+				accum[jj] = accum0;
+			}
+
+			__m256i packed = pack_i30_epi32(accum[0], accum[1]);
+			packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+			packed = _mm256_sub_epi16(packed, INT16_MIN_EPI16);
+			_mm256_store_si256((__m256i *)&dst_ptr[j], packed);
+		}
+	}
+}
+
+template <int N, class T, class Policy>
+void decimate_tile_fp_h_avx2(const EvaluatedFilter &filter, const float *coeffs, const ImageTile<const T> &src, const ImageTile<T> &dst, Policy policy)
+{
+	const __m256i PERMUTE_N4 = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int groups = filter.width() / N;
+
+	for (int i = 0; i < TILE_HEIGHT; ++i) {
+		const T *src_ptr = src[i];
+		T *dst_ptr = dst[i];
+
+		for (int j = 0; j < TILE_WIDTH; j += 8) {
+			const T *src_p = &src_ptr[j * N];
+
+			__m256 accum0 = _mm256_setzero_ps();
+			__m256 accum1 = _mm256_setzero_ps();
+			__m256 accum2 = _mm256_setzero_ps();
+			__m256 accum3 = _mm256_setzero_ps();
+			__m256 result;
+
+			for (int m = 0; m < groups; ++m) {
+				__m256 coeff = _mm256_load_ps(&coeffs[m * 8]);
+				__m256 x0, x1, x2, x3;
+
+				x0 = policy.loadu_8(&src_p[m * N + 0]);
+				accum0 = _mm256_fmadd_ps(coeff, x0, accum0);
+
+				x1 = policy.loadu_8(&src_p[m * N + 8]);
+				accum1 = _mm256_fmadd_ps(coeff, x1, accum1);
+
+				if (N == 4) {
+					x2 = policy.loadu_8(&src_p[m * N + 16]);
+					accum2 = _mm256_fmadd_ps(coeff, x2, accum2);
+
+					x3 = policy.loadu_8(&src_p[m * N + 24]);
+					accum3 = _mm256_fmadd_ps(coeff, x3, accum3);
+				}
+			}
+
+			// Sum adjacent taps and restore pixel order.
+			if (N == 2) {
+				// [0 1 4 5 2 3 6 7]
+				result = _mm256_hadd_ps(accum0, accum1);
+				result = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(result), _MM_SHUFFLE(3, 1, 2, 0)));
+			} else {
+				// [0 2 4 6 1 3 5 7]
+				accum0 = _mm256_hadd_ps(accum0, accum1);
+				accum2 = _mm256_hadd_ps(accum2, accum3);
+				result = _mm256_hadd_ps(accum0, accum2);
+				result = _mm256_permutevar8x32_ps(result, PERMUTE_N4);
+			}
+
+			policy.store_8(&dst_ptr[j], result);
+		}
+	}
+}
+
+template <int TapsU16, int TapsFP>
+class ResizeImplH_AVX2 final : public ResizeImplPlane<ResizeImplH_AVX2<TapsU16, TapsFP>> {
 public:
-	ResizeImplH_AVX2(const EvaluatedFilter &filter) : ResizeImpl(filter, true)
+	ResizeImplH_AVX2(const EvaluatedFilter &filter) : ResizeImplPlane<ResizeImplH_AVX2<TapsU16, TapsFP>>(filter, true)
 	{
 	}
 
@@ -665,33 +783,82 @@ public:
 
 	void process_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
 	{
-		if (m_filter.width() > 16)
-			resize_tile_u16_h_avx2<true>(m_filter, src, dst, j);
-		else
-			resize_tile_u16_h_avx2<false>(m_filter, src, dst, j);
+		resize_tile_u16_h_avx2<TapsU16>(this->m_filter, src, dst, j);
 	}
 
 	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
 	{
-		if (m_filter.width() > 8)
-			resize_tile_fp_h_avx2<true>(m_filter, src, dst, j, VectorPolicy_F16{});
-		else
-			resize_tile_fp_h_avx2<false>(m_filter, src, dst, j, VectorPolicy_F16{});
+		resize_tile_fp_h_avx2<TapsFP>(this->m_filter, src, dst, j, VectorPolicy_F16{});
 	}
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const override
 	{
-		if (m_filter.width() >= 8)
-			resize_tile_fp_h_avx2<true>(m_filter, src, dst, j, VectorPolicy_F32{});
-		else
-			resize_tile_fp_h_avx2<false>(m_filter, src, dst, j, VectorPolicy_F32{});
+		resize_tile_fp_h_avx2<TapsFP>(this->m_filter, src, dst, j, VectorPolicy_F32{});
+	}
+};
+
+template <int Taps>
+class ResizeImplV_AVX2 final : public ResizeImplPlane<ResizeImplV_AVX2<Taps>> {
+public:
+	ResizeImplV_AVX2(const EvaluatedFilter &filter) : ResizeImplPlane<ResizeImplV_AVX2<Taps>>(filter, false)
+	{
+	}
+
+	bool pixel_supported(PixelType type) const override
+	{
+		return type == PixelType::WORD || type == PixelType::HALF || type == PixelType::FLOAT;
+	}
+
+	void process_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
+	{
+		resize_tile_u16_v_avx2<Taps>(this->m_filter, src, dst, i);
+	}
+	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
+	{
+		resize_tile_fp_v_avx2<Taps>(this->m_filter, src, dst, i, VectorPolicy_F16{});
+	}
+
+	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const override
+	{
+		resize_tile_fp_v_avx2<Taps>(this->m_filter, src, dst, i, VectorPolicy_F32{});
 	}
 };
 
-class ResizeImplV_AVX2 final : public ResizeImpl {
+template <int N>
+class ResizeImplDecimateH_AVX2 final : public ResizeImplPlane<ResizeImplDecimateH_AVX2<N>> {
+	AlignedVector<float> m_coeffs;
+	AlignedVector<int16_t> m_coeffs_i16;
+	int m_phase;
+
+	bool tile_uniform(int n) const
+	{
+		const int *filter_phase = &this->m_filter.phase()[n];
+		const int *filter_left = &this->m_filter.left()[n];
+
+		for (int j = 0; j < TILE_WIDTH; ++j) {
+			if (filter_phase[j] != m_phase || filter_left[j] != filter_left[0] + j * N)
+				return false;
+		}
+		return true;
+	}
 public:
-	ResizeImplV_AVX2(const EvaluatedFilter &filter) : ResizeImpl(filter, false)
+	ResizeImplDecimateH_AVX2(const EvaluatedFilter &filter) :
+		ResizeImplPlane<ResizeImplDecimateH_AVX2<N>>(filter, true),
+		m_coeffs((size_t)filter.width() / N * 8),
+		m_coeffs_i16((size_t)filter.width() / N * 16),
+		m_phase{ filter.phase()[filter.height() / 2] }
 	{
+		const float *filter_row = &filter.data()[m_phase * filter.stride()];
+		const int16_t *filter_row_i16 = &filter.data_i16()[m_phase * filter.stride_i16()];
+
+		for (int m = 0; m < filter.width() / N; ++m) {
+			for (int k = 0; k < 8; ++k) {
+				m_coeffs[m * 8 + k] = filter_row[m * N + k % N];
+			}
+			for (int k = 0; k < 16; ++k) {
+				m_coeffs_i16[m * 16 + k] = filter_row_i16[m * N + k % N];
+			}
+		}
 	}
 
 	bool pixel_supported(PixelType type) const override
@@ -701,16 +868,26 @@ public:
 
 	void process_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
 	{
-		resize_tile_u16_v_avx2(m_filter, src, dst, i);
+		if (tile_uniform(j))
+			decimate_tile_u16_h_avx2<N>(this->m_filter, m_coeffs_i16.data(), src, dst);
+		else
+			resize_tile_u16_h_avx2<0>(this->m_filter, src, dst, j);
 	}
+
 	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
 	{
-		resize_tile_fp_v_avx2(m_filter, src, dst, i, VectorPolicy_F16{});
+		if (tile_uniform(j))
+			decimate_tile_fp_h_avx2<N>(this->m_filter, m_coeffs.data(), src, dst, VectorPolicy_F16{});
+		else
+			resize_tile_fp_h_avx2<0>(this->m_filter, src, dst, j, VectorPolicy_F16{});
 	}
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const override
 	{
-		resize_tile_fp_v_avx2(m_filter, src, dst, i, VectorPolicy_F32{});
+		if (tile_uniform(j))
+			decimate_tile_fp_h_avx2<N>(this->m_filter, m_coeffs.data(), src, dst, VectorPolicy_F32{});
+		else
+			resize_tile_fp_h_avx2<0>(this->m_filter, src, dst, j, VectorPolicy_F32{});
 	}
 };
 
@@ -719,12 +896,48 @@ public:
 
 ResizeImpl *create_resize_impl_h_avx2(const EvaluatedFilter &filter)
 {
-	return new ResizeImplH_AVX2{ filter };
+	// Horizontal coefficients are zero-padded to the row stride, so any shorter filter can use a wider kernel.
+	// The u16 kernel consumes 16 taps per step and the fp kernel 8, so only those multiples are instantiated.
+	if (filter.width() <= 8)
+		return new ResizeImplH_AVX2<16, 8>{ filter };
+	else if (filter.width() <= 12)
+		return new ResizeImplH_AVX2<16, 16>{ filter };
+	else
+		return new ResizeImplH_AVX2<0, 0>{ filter };
 }
 
 ResizeImpl *create_resize_impl_v_avx2(const EvaluatedFilter &filter)
 {
-	return new ResizeImplV_AVX2{ filter };
+	switch (filter.width()) {
+	case 2:
+		return new ResizeImplV_AVX2<2>{ filter };
+	case 4:
+		return new ResizeImplV_AVX2<4>{ filter };
+	case 6:
+		return new ResizeImplV_AVX2<6>{ filter };
+	case 8:
+		return new ResizeImplV_AVX2<8>{ filter };
+	case 12:
+		return new ResizeImplV_AVX2<12>{ filter };
+	default:
+		return new ResizeImplV_AVX2<0>{ filter };
+	}
+}
+
+ResizeImpl *create_resize_impl_decimate_h_avx2(const EvaluatedFilter &filter, int factor)
+{
+	// The kernels process whole groups of taps, one group per source pixel step.
+	if (filter.width() % factor)
+		return nullptr;
+
+	switch (factor) {
+	case 2:
+		return new ResizeImplDecimateH_AVX2<2>{ filter };
+	case 4:
+		return new ResizeImplDecimateH_AVX2<4>{ filter };
+	default:
+		return nullptr;
+	}
 }
 
 } // namespace resize;
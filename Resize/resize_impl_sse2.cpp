@@ -87,14 +87,15 @@ inline FORCE_INLINE __m128i pack_i30_epi32(__m128i lo, __m128i hi)
 	return  _mm_packs_epi32(lo, hi);
 }
 
-template <bool DoLoop>
+template <int Taps>
 void resize_tile_u16_h_sse2(const EvaluatedFilter &filter, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int n)
 {
 	__m128i INT16_MIN_EPI16 = _mm_set1_epi16(INT16_MIN);
 
 	int filter_stride = filter.stride_i16();
 
-	const int16_t *filter_data = &filter.data_i16()[n * filter_stride];
+	const int16_t *filter_data = filter.data_i16();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int left_base = filter_left[0];
@@ -114,10 +115,10 @@ void resize_tile_u16_h_sse2(const EvaluatedFilter &filter, const ImageTile<const
 			__m128i accum = _mm_setzero_si128();
 			__m128i cached[8];
 
-			const int16_t *filter_row = &filter_data[j * filter_stride];
+			const int16_t *filter_row = &filter_data[filter_phase[j] * filter_stride];
 			int left = filter_left[j] - left_base;
 
-			for (int k = 0; k < (DoLoop ? filter.width() : 8); k += 8) {
+			for (int k = 0; k < (Taps ? Taps : filter.width()); k += 8) {
 				__m128i coeff = _mm_load_si128((const __m128i *)&filter_row[k]);
 				__m128i x0, x1, x2, x3;
 
@@ -174,12 +175,13 @@ void resize_tile_u16_h_sse2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
-template <bool DoLoop>
+template <int Taps>
 void resize_tile_fp_h_sse2(const EvaluatedFilter &filter, const ImageTile<const float> &src, const ImageTile<float> &dst, int n)
 {
 	int filter_stride = filter.stride();
 
-	const float *filter_data = &filter.data()[n * filter_stride];
+	const float *filter_data = filter.data();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int left_base = filter_left[0];
@@ -199,10 +201,10 @@ void resize_tile_fp_h_sse2(const EvaluatedFilter &filter, const ImageTile<const
 			__m128 accum = _mm_setzero_ps();
 			__m128 cached[4];
 
-			const float *filter_row = &filter_data[j * filter_stride];
+			const float *filter_row = &filter_data[filter_phase[j] * filter_stride];
 			int left = filter_left[j] - left_base;
 
-			for (int k = 0; k < (DoLoop ? filter.width() : 4); k += 4) {
+			for (int k = 0; k < (Taps ? Taps : filter.width()); k += 4) {
 				__m128 coeff = _mm_load_ps(filter_row + k);
 				__m128 x0, x1, x2, x3;
 
@@ -242,25 +244,28 @@ void resize_tile_fp_h_sse2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
+template <int Taps>
 void resize_tile_u16_v_sse2(const EvaluatedFilter &filter, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int n)
 {
 	__m128i INT16_MIN_EPI16 = _mm_set1_epi16(INT16_MIN);
-	__m128i tmp_m128i[TILE_WIDTH / 4];
+	__m128i tmp_m128i[TILE_WIDTH / 2];
 	uint32_t *tmp = (uint32_t *)tmp_m128i;
 
+	int filter_width = Taps ? Taps : filter.width();
 	int filter_stride = filter.stride_i16();
 
-	const int16_t *filter_data = &filter.data_i16()[filter_stride * n];
+	const int16_t *filter_data = filter.data_i16();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int top_base = filter_left[0];
 
 	for (int i = 0; i < TILE_HEIGHT; ++i) {
-		const int16_t *filter_row = &filter_data[i * filter_stride];
+		const int16_t *filter_row = &filter_data[filter_phase[i] * filter_stride];
 		int top = filter_left[i] - top_base;
 		uint16_t *dst_ptr = dst[i];
 
-		for (int k = 0; k < floor_n(filter.width(), 4); k += 4) {
+		for (int k = 0; k < floor_n(filter_width, 4); k += 4) {
 			const uint16_t *src_ptr0 = src[top + k + 0];
 			const uint16_t *src_ptr1 = src[top + k + 1];
 			const uint16_t *src_ptr2 = src[top + k + 2];
@@ -304,7 +309,7 @@ void resize_tile_u16_v_sse2(const EvaluatedFilter &filter, const ImageTile<const
 					accum0h = _mm_add_epi32(accum0h, _mm_load_si128((const __m128i *)&tmp[j * 2 + 4]));
 				}
 
-				if (k == filter.width() - 4) {
+				if (k == filter_width - 4) {
 					packed = pack_i30_epi32(accum0l, accum0h);
 					packed = _mm_sub_epi16(packed, INT16_MIN_EPI16);
 					_mm_store_si128((__m128i *)&dst_ptr[j], packed);
@@ -314,9 +319,9 @@ void resize_tile_u16_v_sse2(const EvaluatedFilter &filter, const ImageTile<const
 				}
 			}
 		}
-		if (filter.width() % 4) {
-			int m = filter.width() % 4;
-			int k = filter.width() - m;
+		if (filter_width % 4) {
+			int m = filter_width % 4;
+			int k = filter_width - m;
 
 			const uint16_t *src_ptr0 = src[top + k + 0];
 			const uint16_t *src_ptr1 = src[top + k + 1];
@@ -367,21 +372,24 @@ void resize_tile_u16_v_sse2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
+template <int Taps>
 void resize_tile_fp_v_sse2(const EvaluatedFilter &filter, const ImageTile<const float> &src, const ImageTile<float> &dst, int n)
 {
+	int filter_width = Taps ? Taps : filter.width();
 	int filter_stride = filter.stride();
 
-	const float *filter_data = &filter.data()[n * filter_stride];
+	const float *filter_data = filter.data();
+	const int *filter_phase = &filter.phase()[n];
 	const int *filter_left = &filter.left()[n];
 
 	int top_base = filter_left[0];
 
 	for (int i = 0; i < TILE_HEIGHT; ++i) {
-		const float *filter_row = &filter_data[i * filter_stride];
+		const float *filter_row = &filter_data[filter_phase[i] * filter_stride];
 		int top = filter_left[i] - top_base;
 		float *dst_ptr = dst[i];
 
-		for (int k = 0; k < floor_n(filter.width(), 4); k += 4) {
+		for (int k = 0; k < floor_n(filter_width, 4); k += 4) {
 			const float *src_ptr0 = src[top + k + 0];
 			const float *src_ptr1 = src[top + k + 1];
 			const float *src_ptr2 = src[top + k + 2];
@@ -418,9 +426,9 @@ void resize_tile_fp_v_sse2(const EvaluatedFilter &filter, const ImageTile<const
 				_mm_store_ps(&dst_ptr[j], accum0);
 			}
 		}
-		if (filter.width() % 4) {
-			int m = filter.width() % 4;
-			int k = filter.width() - m;
+		if (filter_width % 4) {
+			int m = filter_width % 4;
+			int k = filter_width - m;
 
 			const float *src_ptr0 = src[top + k + 0];
 			const float *src_ptr1 = src[top + k + 1];
@@ -460,9 +468,10 @@ void resize_tile_fp_v_sse2(const EvaluatedFilter &filter, const ImageTile<const
 	}
 }
 
-class ResizeImplH_SSE2 : public ResizeImpl {
+template <int TapsU16, int TapsFP>
+class ResizeImplH_SSE2 final : public ResizeImplPlane<ResizeImplH_SSE2<TapsU16, TapsFP>> {
 public:
-	ResizeImplH_SSE2(const EvaluatedFilter &filter) : ResizeImpl(filter, true)
+	ResizeImplH_SSE2(const EvaluatedFilter &filter) : ResizeImplPlane<ResizeImplH_SSE2<TapsU16, TapsFP>>(filter, true)
 	{
 	}
 
@@ -473,10 +482,7 @@ public:
 
 	void process_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
 	{
-		if (m_filter.width() > 8)
-			resize_tile_u16_h_sse2<true>(m_filter, src, dst, j);
-		else
-			resize_tile_u16_h_sse2<false>(m_filter, src, dst, j);
+		resize_tile_u16_h_sse2<TapsU16>(this->m_filter, src, dst, j);
 	}
 
 	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
@@ -486,16 +492,14 @@ public:
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const override
 	{
-		if (m_filter.width() > 4)
-			resize_tile_fp_h_sse2<true>(m_filter, src, dst, j);
-		else
-			resize_tile_fp_h_sse2<false>(m_filter, src, dst, j);
+		resize_tile_fp_h_sse2<TapsFP>(this->m_filter, src, dst, j);
 	}
 };
 
-class ResizeImplV_SSE2 : public ResizeImpl {
+template <int Taps>
+class ResizeImplV_SSE2 final : public ResizeImplPlane<ResizeImplV_SSE2<Taps>> {
 public:
-	ResizeImplV_SSE2(const EvaluatedFilter &filter) : ResizeImpl(filter, false)
+	ResizeImplV_SSE2(const EvaluatedFilter &filter) : ResizeImplPlane<ResizeImplV_SSE2<Taps>>(filter, false)
 	{
 	}
 
@@ -506,7 +510,7 @@ public:
 
 	void process_u16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
 	{
-		resize_tile_u16_v_sse2(m_filter, src, dst, i);
+		resize_tile_u16_v_sse2<Taps>(this->m_filter, src, dst, i);
 	}
 
 	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int i, int j) const override
@@ -516,7 +520,7 @@ public:
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int i, int j) const override
 	{
-		resize_tile_fp_v_sse2(m_filter, src, dst, i);
+		resize_tile_fp_v_sse2<Taps>(this->m_filter, src, dst, i);
 	}
 };
 
@@ -525,12 +529,34 @@ public:
 
 ResizeImpl *create_resize_impl_h_sse2(const EvaluatedFilter &filter)
 {
-	return new ResizeImplH_SSE2{ filter };
+	// Horizontal coefficients are zero-padded to the row stride, so any shorter filter can use a wider kernel.
+	// The u16 kernel consumes 8 taps per step and the fp kernel 4, so only those multiples are instantiated.
+	if (filter.width() <= 4)
+		return new ResizeImplH_SSE2<8, 4>{ filter };
+	else if (filter.width() <= 8)
+		return new ResizeImplH_SSE2<8, 8>{ filter };
+	else if (filter.width() <= 12)
+		return new ResizeImplH_SSE2<16, 12>{ filter };
+	else
+		return new ResizeImplH_SSE2<0, 0>{ filter };
 }
 
 ResizeImpl *create_resize_impl_v_sse2(const EvaluatedFilter &filter)
 {
-	return new ResizeImplV_SSE2{ filter };
+	switch (filter.width()) {
+	case 2:
+		return new ResizeImplV_SSE2<2>{ filter };
+	case 4:
+		return new ResizeImplV_SSE2<4>{ filter };
+	case 6:
+		return new ResizeImplV_SSE2<6>{ filter };
+	case 8:
+		return new ResizeImplV_SSE2<8>{ filter };
+	case 12:
+		return new ResizeImplV_SSE2<12>{ filter };
+	default:
+		return new ResizeImplV_SSE2<0>{ filter };
+	}
 }
 
 } // namespace resize
@@ -46,6 +46,25 @@ ResizeImpl *create_resize_impl_x86(const EvaluatedFilter &filter, bool horizonta
 	return ret;
 }
 
+ResizeImpl *create_resize_impl_decimate_x86(const EvaluatedFilter &filter, int factor, CPUClass cpu)
+{
+	X86Capabilities caps = query_x86_capabilities();
+	ResizeImpl *ret;
+
+	if (cpu == CPUClass::CPU_X86_AUTO) {
+		if (caps.avx2)
+			ret = create_resize_impl_decimate_h_avx2(filter, factor);
+		else
+			ret = nullptr;
+	} else if (cpu >= CPUClass::CPU_X86_AVX2) {
+		ret = create_resize_impl_decimate_h_avx2(filter, factor);
+	} else {
+		ret = nullptr;
+	}
+
+	return ret;
+}
+
 } // namespace resize
 } // namespace zimg
 
@@ -22,6 +22,8 @@ ResizeImpl *create_resize_impl_v_sse2(const EvaluatedFilter &filter);
 
 ResizeImpl *create_resize_impl_v_avx2(const EvaluatedFilter &filter);
 
+ResizeImpl *create_resize_impl_decimate_h_avx2(const EvaluatedFilter &filter, int factor);
+
 /**
  * Create an appropriate x86 optimized ResizeImpl for the given CPU.
  *
@@ -29,6 +31,16 @@ ResizeImpl *create_resize_impl_v_avx2(const EvaluatedFilter &filter);
  */
 ResizeImpl *create_resize_impl_x86(const EvaluatedFilter &filter, bool horizontal, CPUClass cpu);
 
+/**
+ * Create an x86 optimized ResizeImpl for exact integer horizontal downscaling.
+ *
+ * @param filter coefficients
+ * @param factor decimation factor
+ * @param cpu create kernel optimized for given cpu
+ * @return implementation, or nullptr if not supported
+ */
+ResizeImpl *create_resize_impl_decimate_x86(const EvaluatedFilter &filter, int factor, CPUClass cpu);
+
 } // namespace resize
 } // namespace zimg
 
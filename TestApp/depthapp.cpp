@@ -49,6 +49,14 @@ int select_dither(const char **opt, const char **lastopt, void *p, void *user)
 		c->dither = depth::DitherType::DITHER_RANDOM;
 	else if (!strcmp(dither, "error_diffusion"))
 		c->dither = depth::DitherType::DITHER_ERROR_DIFFUSION;
+	else if (!strcmp(dither, "blue_noise"))
+		c->dither = depth::DitherType::DITHER_BLUE_NOISE;
+	else if (!strcmp(dither, "sierra_lite"))
+		c->dither = depth::DitherType::DITHER_SIERRA_LITE;
+	else if (!strcmp(dither, "error_diffusion_row"))
+		c->dither = depth::DitherType::DITHER_ERROR_DIFFUSION_ROW;
+	else if (!strcmp(dither, "error_diffusion_serpentine"))
+		c->dither = depth::DitherType::DITHER_ERROR_DIFFUSION_SERPENTINE;
 	else
 		throw std::invalid_argument{ "unsupported dither type" };
 
@@ -114,7 +122,7 @@ void execute(const depth::Depth &depth, const Frame &in, Frame &out, int times,
 			if (depth.tile_supported(pxl_in, pxl_out)) {
 				for (int i = 0; i < height; i += TILE_HEIGHT) {
 					for (int j = 0; j < width; j += TILE_WIDTH) {
-						depth.process_tile(src_tile.sub_tile(i, j), dst_tile.sub_tile(i, j), tmp.data());
+						depth.process_tile(src_tile.sub_tile(i, j), dst_tile.sub_tile(i, j), i, j, 0, tmp.data());
 					}
 				}
 			} else {
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <iostream>
 #include <iterator>
@@ -22,21 +24,23 @@ struct AppContext {
 	double shift_w;
 	double shift_h;
 	int times;
+	int partitions;
 	CPUClass cpu;
 	PixelType pixtype;
 };
 
 const AppOption OPTIONS[] = {
-	{ "shift-w", OptionType::OPTION_FLOAT,     offsetof(AppContext, shift_w) },
-	{ "shift-h", OptionType::OPTION_FLOAT,     offsetof(AppContext, shift_h) },
-	{ "times",   OptionType::OPTION_INTEGER,   offsetof(AppContext, times) },
-	{ "cpu",     OptionType::OPTION_CPUCLASS,  offsetof(AppContext, cpu) },
-	{ "pixtype", OptionType::OPTION_PIXELTYPE, offsetof(AppContext, pixtype) }
+	{ "shift-w",    OptionType::OPTION_FLOAT,     offsetof(AppContext, shift_w) },
+	{ "shift-h",    OptionType::OPTION_FLOAT,     offsetof(AppContext, shift_h) },
+	{ "times",      OptionType::OPTION_INTEGER,   offsetof(AppContext, times) },
+	{ "partitions", OptionType::OPTION_INTEGER,   offsetof(AppContext, partitions) },
+	{ "cpu",        OptionType::OPTION_CPUCLASS,  offsetof(AppContext, cpu) },
+	{ "pixtype",    OptionType::OPTION_PIXELTYPE, offsetof(AppContext, pixtype) }
 };
 
 void usage()
 {
-	std::cout << "unresize infile outfile width height [--shift-w shift] [--shift-h shift] [--times n] [--cpu cpu] [--pixtype type]\n";
+	std::cout << "unresize infile outfile width height [--shift-w shift] [--shift-h shift] [--times n] [--partitions n] [--cpu cpu] [--pixtype type]\n";
 	std::cout << "    infile              input BMP file\n";
 	std::cout << "    outfile             output BMP file\n";
 	std::cout << "    w                   output width\n";
@@ -44,6 +48,7 @@ void usage()
 	std::cout << "    --shift-w           horizontal shift\n";
 	std::cout << "    --shift-h           vertical shift\n";
 	std::cout << "    --times             number of cycles\n";
+	std::cout << "    --partitions        check the vertical pass against a solve in n partitions\n";
 	std::cout << "    --cpu               select CPU type\n";
 	std::cout << "    --pixtype           select pixel format\n";
 }
@@ -123,6 +128,65 @@ void execute(const unresize::Unresize *unresize_h, const unresize::Unresize *unr
 	convert_frame(dst, out, type, PixelType::BYTE, true, false);
 }
 
+/**
+ * Get the largest difference between the direct and the partitioned solution of the vertical pass.
+ */
+double partition_error(unresize::Unresize unresize_v, const Frame &in, int height, int partitions)
+{
+	int pxsize = (int)sizeof(float);
+	int planes = in.planes();
+
+	Frame src{ in.width(), in.height(), pxsize, planes };
+	Frame direct{ in.width(), height, pxsize, planes };
+	Frame partitioned{ in.width(), height, pxsize, planes };
+
+	PlaneDescriptor src_desc{ PixelType::FLOAT, src.width(), src.height() };
+	PlaneDescriptor dst_desc{ PixelType::FLOAT, direct.width(), direct.height() };
+
+	auto tmp_buffer = allocate_buffer(unresize_v.tmp_size(PixelType::FLOAT), PixelType::FLOAT);
+	double err = 0.0;
+
+	convert_frame(in, src, PixelType::BYTE, PixelType::FLOAT, true, false);
+
+	for (int p = 0; p < planes; ++p) {
+		ImageTile<const void> src_tile{ src.data(p), &src_desc, src.stride() * pxsize };
+		ImageTile<void> dst_tile{ direct.data(p), &dst_desc, direct.stride() * pxsize };
+
+		unresize_v.process(src_tile, dst_tile, tmp_buffer.data());
+	}
+
+	unresize_v.set_partitions(partitions);
+
+	for (int p = 0; p < planes; ++p) {
+		ImageTile<const void> src_tile{ src.data(p), &src_desc, src.stride() * pxsize };
+		ImageTile<void> dst_tile{ partitioned.data(p), &dst_desc, partitioned.stride() * pxsize };
+
+		for (int k = 0; k < unresize_v.num_partitions(); ++k) {
+			int dst_top, dst_bottom;
+			int src_top, src_bottom;
+
+			unresize_v.partition_rows(k, &dst_top, &dst_bottom);
+			unresize_v.dependent_rows(dst_top, dst_bottom, &src_top, &src_bottom);
+			unresize_v.process_partition(src_tile.sub_tile(src_top, 0), dst_tile, k);
+		}
+		unresize_v.process_partition_reduce(dst_tile);
+		for (int k = 0; k < unresize_v.num_partitions(); ++k) {
+			unresize_v.process_partition_fixup(dst_tile, k);
+		}
+
+		for (int i = 0; i < height; ++i) {
+			const float *direct_row = reinterpret_cast<const float *>(direct.row_ptr(p, i));
+			const float *partitioned_row = reinterpret_cast<const float *>(partitioned.row_ptr(p, i));
+
+			for (int j = 0; j < in.width(); ++j) {
+				err = std::max(err, (double)std::abs(direct_row[j] - partitioned_row[j]));
+			}
+		}
+	}
+
+	return err;
+}
+
 } // namespace
 
 
@@ -135,15 +199,16 @@ int unresize_main(int argc, const char **argv)
 
 	AppContext c{};
 
-	c.infile  = argv[1];
-	c.outfile = argv[2];
-	c.width   = std::stoi(argv[3]);
-	c.height  = std::stoi(argv[4]);
-	c.shift_w = 0.0;
-	c.shift_h = 0.0;
-	c.times   = 1;
-	c.cpu     = CPUClass::CPU_NONE;
-	c.pixtype = PixelType::FLOAT;
+	c.infile     = argv[1];
+	c.outfile    = argv[2];
+	c.width      = std::stoi(argv[3]);
+	c.height     = std::stoi(argv[4]);
+	c.shift_w    = 0.0;
+	c.shift_h    = 0.0;
+	c.times      = 1;
+	c.partitions = 1;
+	c.cpu        = CPUClass::CPU_NONE;
+	c.pixtype    = PixelType::FLOAT;
 
 	parse_opts(argv + 5, argv + argc, std::begin(OPTIONS), std::end(OPTIONS), &c, nullptr);
 
@@ -161,8 +226,11 @@ int unresize_main(int argc, const char **argv)
 	if (!skip_v)
 		unresize_v = unresize::Unresize{ false, in.height(), out.height(), c.shift_h, c.cpu };
 
-	execute(&unresize_h, &unresize_v, in, out, c.times, c.pixtype);
+	execute(skip_h ? nullptr : &unresize_h, skip_v ? nullptr : &unresize_v, in, out, c.times, c.pixtype);
 	write_frame_bmp(out, c.outfile);
 
+	if (c.partitions > 1 && !skip_v)
+		std::cout << "partitioned max error: " << partition_error(unresize_v, in, out.height(), c.partitions) << '\n';
+
 	return 0;
 }
@@ -1,8 +1,12 @@
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <list>
+#include <mutex>
+#include <tuple>
 #include <vector>
 #include "Common/matrix.h"
+#include "Resize/filter.h"
 #include "bilinear.h"
 
 namespace zimg {;
@@ -17,40 +21,127 @@ T epsilon()
 }
 
 template <class T>
-struct TridiagonalLU {
+struct BandedLU {
 	std::vector<T> l;
 	std::vector<T> u;
 	std::vector<T> c;
+	int bandwidth;
 
-	TridiagonalLU(size_t n) : l(n), u(n), c(n)
+	BandedLU(size_t n, int bandwidth) : l(n), u(n * bandwidth), c(n * bandwidth), bandwidth{ bandwidth }
 	{}
 };
 
+/**
+ * Decompose the diagonal block [begin, end) of a tridiagonal matrix,
+ * ignoring the elements coupling it to the rest of the matrix.
+ */
 template <class T>
-TridiagonalLU<T> tridiagonal_decompose(const RowMatrix<T> &m)
+void tridiagonal_decompose_block(const RowMatrix<T> &m, BandedLU<T> &lu, size_t begin, size_t end)
 {
-	size_t n = m.rows();
-	TridiagonalLU<T> lu{ n };
 	T zero = static_cast<T>(0);
 	T eps = epsilon<T>();
 
-	lu.c[0] = zero;
-	lu.l[0] = m[0][0];
-	lu.u[0] = m[0][1] / (m[0][0] + eps);
+	lu.c[begin] = zero;
+	lu.l[begin] = m[begin][begin];
+	lu.u[begin] = m[begin][begin + 1] / (m[begin][begin] + eps);
 
-	for (size_t i = 1; i < n - 1; ++i) {
+	for (size_t i = begin + 1; i < end - 1; ++i) {
 		lu.c[i] = m[i][i - 1];
 		lu.l[i] = m[i][i] - lu.c[i] * lu.u[i - 1];
 		lu.u[i] = m[i][i + 1] / (lu.l[i] + eps);
 	}
 
-	lu.c[n - 1] = m[n - 1][n - 2];
-	lu.l[n - 1] = m[n - 1][n - 1] - lu.c[n - 1] * lu.u[n - 2];
-	lu.u[n - 1] = zero;
+	lu.c[end - 1] = m[end - 1][end - 2];
+	lu.l[end - 1] = m[end - 1][end - 1] - lu.c[end - 1] * lu.u[end - 2];
+	lu.u[end - 1] = zero;
+}
 
+template <class T>
+BandedLU<T> tridiagonal_decompose(const RowMatrix<T> &m)
+{
+	BandedLU<T> lu{ m.rows(), 1 };
+	tridiagonal_decompose_block(m, lu, 0, m.rows());
 	return lu;
 }
 
+/**
+ * Get the number of diagonals on either side of the main diagonal of a symmetric matrix.
+ */
+template <class T>
+int matrix_bandwidth(const RowMatrix<T> &m)
+{
+	int q = 0;
+
+	for (size_t i = 0; i < m.rows(); ++i) {
+		for (size_t j = i + 1; j < m.row_right(i); ++j) {
+			if (m[i][j] != static_cast<T>(0))
+				q = std::max(q, (int)(j - i));
+		}
+	}
+	return q;
+}
+
+/**
+ * Crout decomposition of a band matrix into a lower triangular L and unit upper triangular U.
+ * No pivoting is done, which is stable for the symmetric positive definite (A' A).
+ */
+template <class T>
+BandedLU<T> banded_decompose(const RowMatrix<T> &m, int q)
+{
+	int n = (int)m.rows();
+	BandedLU<T> lu{ (size_t)n, q };
+	T eps = epsilon<T>();
+
+	auto L = [&](int i, int j) { return i == j ? lu.l[i] : lu.c[i * q + (i - j - 1)]; };
+	auto U = [&](int i, int j) { return lu.u[i * q + (j - i - 1)]; };
+
+	for (int i = 0; i < n; ++i) {
+		int lo = std::max(i - q, 0);
+		int hi = std::min(i + q, n - 1);
+
+		for (int j = lo; j <= i; ++j) {
+			T x = m[i][j];
+
+			for (int k = std::max(lo, j - q); k < j; ++k) {
+				x -= L(i, k) * U(k, j);
+			}
+
+			if (j == i)
+				lu.l[i] = x;
+			else
+				lu.c[i * q + (i - j - 1)] = x;
+		}
+		for (int j = i + 1; j <= hi; ++j) {
+			T x = m[i][j];
+
+			for (int k = std::max(lo, j - q); k < i; ++k) {
+				x -= L(i, k) * U(k, j);
+			}
+
+			lu.u[i * q + (j - i - 1)] = x / (lu.l[i] + eps);
+		}
+	}
+
+	return lu;
+}
+
+/**
+ * Solve the diagonal block [begin, end) in place, given its decomposition.
+ */
+template <class T>
+void tridiagonal_solve_block(const BandedLU<T> &lu, std::vector<T> &x, size_t begin, size_t end)
+{
+	T eps = epsilon<T>();
+
+	x[begin] = x[begin] / (lu.l[begin] + eps);
+	for (size_t i = begin + 1; i < end; ++i) {
+		x[i] = (x[i] - lu.c[i] * x[i - 1]) / (lu.l[i] + eps);
+	}
+	for (size_t i = end - 1; i > begin; --i) {
+		x[i - 1] = x[i - 1] - lu.u[i - 1] * x[i];
+	}
+}
+
 /**
  * Compute the coefficients for a bilinear scaling matrix.
  *
@@ -99,19 +190,62 @@ RowMatrix<double> bilinear_weights(int in, int out, double shift)
 	return m;
 }
 
-} // namespace
+/**
+ * Compute (A' A) directly in banded form. Each row of A contributes the outer
+ * product of its stored range, so the cost is proportional to the number of
+ * rows times the square of the filter width, rather than to the dimension squared.
+ * The terms are summed in the same order as RowMatrix multiplication.
+ */
+RowMatrix<double> normal_equations(const RowMatrix<double> &m)
+{
+	size_t n = m.cols();
 
+	std::vector<size_t> left(n, n);
+	std::vector<size_t> right(n, 0);
 
-BilinearContext create_bilinear_context(int in, int out, double shift)
+	// Extent of each row of (A' A).
+	for (size_t r = 0; r < m.rows(); ++r) {
+		for (size_t j = m.row_left(r); j < m.row_right(r); ++j) {
+			left[j] = std::min(left[j], m.row_left(r));
+			right[j] = std::max(right[j], m.row_right(r));
+		}
+	}
+
+	std::vector<std::vector<double>> band(n);
+	for (size_t j = 0; j < n; ++j) {
+		if (left[j] < right[j])
+			band[j].resize(right[j] - left[j]);
+	}
+
+	for (size_t r = 0; r < m.rows(); ++r) {
+		for (size_t j = m.row_left(r); j < m.row_right(r); ++j) {
+			double a = m[r][j];
+
+			for (size_t k = m.row_left(r); k < m.row_right(r); ++k) {
+				band[j][k - left[j]] += a * m[r][k];
+			}
+		}
+	}
+
+	RowMatrix<double> p{ n, n };
+
+	for (size_t j = 0; j < n; ++j) {
+		for (size_t k = 0; k < band[j].size(); ++k) {
+			p[j][left[j] + k] = band[j][k];
+		}
+	}
+
+	p.compress();
+	return p;
+}
+
+/**
+ * Pack the transposed scaling matrix and a decomposition of (A' A) into a context.
+ */
+BilinearContext pack_bilinear_context(const RowMatrix<double> &transpose_m, const BandedLU<double> &lu)
 {
 	BilinearContext ctx;
 
-	// Map output shift to input shift.
-	RowMatrix<double> m = bilinear_weights(in, out, -shift * (double)in / (double)out);
-	RowMatrix<double> transpose_m = transpose(m);
-	RowMatrix<double> pinv_m = transpose_m * m;
-	TridiagonalLU<double> lu = tridiagonal_decompose(pinv_m);
-
 	size_t rows = transpose_m.rows();
 	size_t cols = transpose_m.cols();
 
@@ -134,17 +268,217 @@ BilinearContext create_bilinear_context(int in, int out, double shift)
 		ctx.matrix_row_offsets[i] = (int)left;
 	}
 
-	ctx.lu_c.resize(rows);
+	ctx.lu_bandwidth = lu.bandwidth;
+	ctx.lu_c.resize(lu.c.size());
 	ctx.lu_l.resize(rows);
-	ctx.lu_u.resize(rows);
+	ctx.lu_u.resize(lu.u.size());
 	for (size_t i = 0; i < rows; ++i) {
-		ctx.lu_c[i] = (float)lu.c[i];
 		ctx.lu_l[i] = (float)(1.0 / (lu.l[i] + epsilon<float>())); // Pre-invert this value, as it is used in division.
+	}
+	for (size_t i = 0; i < lu.c.size(); ++i) {
+		ctx.lu_c[i] = (float)lu.c[i];
 		ctx.lu_u[i] = (float)lu.u[i];
 	}
 
 	return ctx;
 }
 
+/**
+ * Build a BilinearContext without consulting the cache.
+ */
+BilinearContext compute_bilinear_context(int in, int out, double shift)
+{
+	// Map output shift to input shift.
+	RowMatrix<double> m = bilinear_weights(in, out, -shift * (double)in / (double)out);
+	RowMatrix<double> transpose_m = transpose(m);
+	RowMatrix<double> pinv_m = normal_equations(m);
+
+	return pack_bilinear_context(transpose_m, tridiagonal_decompose(pinv_m));
+}
+
+/**
+ * Most recently used bilinear contexts, as the same geometry tends to be unresized repeatedly.
+ */
+class BilinearContextCache {
+	typedef std::tuple<int, int, double> key_type;
+
+	static const size_t MAX_ENTRIES = 8;
+
+	std::list<std::pair<key_type, BilinearContext>> m_entries;
+	std::mutex m_mutex;
+public:
+	BilinearContext get(int in, int out, double shift)
+	{
+		key_type key{ in, out, shift };
+
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+
+			for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+				if (it->first == key) {
+					m_entries.splice(m_entries.begin(), m_entries, it);
+					return it->second;
+				}
+			}
+		}
+
+		// Build outside of the lock. Concurrent misses on the same key may insert duplicates, which age out.
+		BilinearContext ctx = compute_bilinear_context(in, out, shift);
+
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+
+			m_entries.emplace_front(key, ctx);
+			if (m_entries.size() > MAX_ENTRIES)
+				m_entries.pop_back();
+		}
+
+		return ctx;
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_entries.clear();
+	}
+};
+
+/**
+ * Get the process-wide cache. It is never destroyed, so that no buffer is released
+ * through user allocation hooks during static destruction.
+ */
+BilinearContextCache &bilinear_context_cache()
+{
+	static BilinearContextCache *cache = new BilinearContextCache{};
+	return *cache;
+}
+
+} // namespace
+
+
+BilinearContext create_bilinear_context(int in, int out, double shift)
+{
+	return bilinear_context_cache().get(in, out, shift);
+}
+
+void clear_bilinear_context_cache()
+{
+	bilinear_context_cache().clear();
+}
+
+BilinearContext create_filter_context(const resize::Filter &filter, int in, int out, double shift)
+{
+	// Map output shift to input shift.
+	RowMatrix<double> m = resize::compute_filter_matrix(filter, in, out, shift * (double)in / (double)out, in);
+	RowMatrix<double> transpose_m = transpose(m);
+	RowMatrix<double> pinv_m = normal_equations(m);
+
+	return pack_bilinear_context(transpose_m, banded_decompose(pinv_m, matrix_bandwidth(pinv_m)));
+}
+
+BilinearPartition create_bilinear_partition(int in, int out, double shift, int num_partitions)
+{
+	BilinearPartition part;
+
+	RowMatrix<double> m = bilinear_weights(in, out, -shift * (double)in / (double)out);
+	RowMatrix<double> transpose_m = transpose(m);
+	RowMatrix<double> pinv_m = normal_equations(m);
+
+	size_t n = pinv_m.rows();
+	size_t partition_size = n / num_partitions;
+	BandedLU<double> lu{ n, 1 };
+
+	std::vector<size_t> begin(num_partitions);
+	std::vector<size_t> end(num_partitions);
+
+	for (int k = 0; k < num_partitions; ++k) {
+		begin[k] = k * partition_size;
+		end[k] = k == num_partitions - 1 ? n : begin[k] + partition_size;
+
+		tridiagonal_decompose_block(pinv_m, lu, begin[k], end[k]);
+	}
+
+	part.context = pack_bilinear_context(transpose_m, lu);
+	part.partition_size = (int)partition_size;
+	part.num_partitions = num_partitions;
+
+	// Solve each block against its coupling to the neighbouring blocks.
+	std::vector<double> v(n);
+	std::vector<double> w(n);
+
+	for (int k = 0; k < num_partitions; ++k) {
+		if (k != 0) {
+			v[begin[k]] = pinv_m[begin[k]][begin[k] - 1];
+			tridiagonal_solve_block(lu, v, begin[k], end[k]);
+		}
+		if (k != num_partitions - 1) {
+			w[end[k] - 1] = pinv_m[end[k] - 1][end[k]];
+			tridiagonal_solve_block(lu, w, begin[k], end[k]);
+		}
+	}
+
+	part.spike_v.resize(n);
+	part.spike_w.resize(n);
+	part.spike_v_len.resize(num_partitions);
+	part.spike_w_len.resize(num_partitions);
+
+	for (size_t i = 0; i < n; ++i) {
+		part.spike_v[i] = (float)v[i];
+		part.spike_w[i] = (float)w[i];
+	}
+
+	// Truncate the spikes where their contribution is below the precision of the result.
+	for (int k = 0; k < num_partitions; ++k) {
+		size_t v_len = end[k] - begin[k];
+		size_t w_len = end[k] - begin[k];
+
+		while (v_len && std::abs(v[begin[k] + v_len - 1]) < epsilon<float>()) {
+			--v_len;
+		}
+		while (w_len && std::abs(w[end[k] - w_len]) < epsilon<float>()) {
+			--w_len;
+		}
+
+		part.spike_v_len[k] = (int)v_len;
+		part.spike_w_len[k] = (int)w_len;
+	}
+
+	// Block LU decomposition of the reduced system.
+	double upper0_prev = 0.0;
+
+	for (int t = 0; t < num_partitions - 1; ++t) {
+		size_t last = end[t] - 1;
+		size_t first = end[t];
+
+		double alpha = v[last];
+		double d00 = 1.0;
+		double d01 = w[last] - alpha * upper0_prev;
+		double d10 = v[first];
+		double d11 = 1.0;
+		double det = d00 * d11 - d01 * d10;
+
+		double inv00 = d11 / det;
+		double inv01 = -d01 / det;
+		double inv10 = -d10 / det;
+		double inv11 = d00 / det;
+
+		double delta = w[first];
+
+		BilinearInterface iface;
+		iface.alpha = (float)alpha;
+		iface.pivot_inv[0] = (float)inv00;
+		iface.pivot_inv[1] = (float)inv01;
+		iface.pivot_inv[2] = (float)inv10;
+		iface.pivot_inv[3] = (float)inv11;
+		iface.upper[0] = (float)(delta * inv01);
+		iface.upper[1] = (float)(delta * inv11);
+
+		part.interfaces.push_back(iface);
+		upper0_prev = delta * inv01;
+	}
+
+	return part;
+}
+
 } // namespace unresize
 } // namespace zimg
@@ -3,9 +3,15 @@
 #ifndef ZIMG_UNRESIZE_BILINEAR_H_
 #define ZIMG_UNRESIZE_BILINEAR_H_
 
+#include <vector>
 #include "Common/align.h"
 
 namespace zimg {;
+
+namespace resize {;
+class Filter;
+} // namespace resize
+
 namespace unresize {;
 
 /**
@@ -36,17 +42,21 @@ struct BilinearContext {
 	int matrix_row_stride;
 
 	/**
-	 * LU decomposition of (A' A) stored as three arrays of dimension (N).
+	 * LU decomposition of (A' A), which is a band matrix with (Q) diagonals
+	 * on either side of the main diagonal. For the bilinear filter, Q is 1.
 	 *
-	 * The relationship to L and U is given by the following.
+	 * The relationship to L and U is given by the following, for k = 1 ... Q.
 	 *
-	 * lu_c(i) = L(i, i - 1)
+	 * lu_c(i, k) = L(i, i - k)
 	 * lu_l(i) = 1 / L(i, i)
-	 * lu_u(i) = U(i, i + 1)
+	 * lu_u(i, k) = U(i, i + k)
 	 *
-	 * lu_c(1) and lu_u(N) are set to 0 to simplify the execution loop.
+	 * lu_c and lu_u are stored as arrays of dimension (N, Q), and lu_l as an array of dimension (N).
+	 * Elements referring to indices outside of the matrix are set to 0 to simplify the execution loop.
+	 * The neighbouring element is not accessed where lu_c or lu_u is 0.
 	 * lu_l is stored inverted as it is used in forward substitution as a divisor.
 	 */
+	int lu_bandwidth;
 	AlignedVector<float> lu_c;
 	AlignedVector<float> lu_l;
 	AlignedVector<float> lu_u;
@@ -54,6 +64,8 @@ struct BilinearContext {
 
 /**
  * Initialize a BilinearContext for a given scaling factor.
+ * Recently created contexts are cached, so repeated calls with the same arguments are cheap.
+ * This function is thread-safe.
  *
  * @param in dimension of original vector
  * @param out dimension of upscaled vector
@@ -62,6 +74,95 @@ struct BilinearContext {
  */
 BilinearContext create_bilinear_context(int in, int out, double shift);
 
+/**
+ * Release the contexts cached by create_bilinear_context.
+ * Must be called before replacing the allocator hooks.
+ */
+void clear_bilinear_context_cache();
+
+/**
+ * Initialize a BilinearContext to invert the scaling performed by a resampling filter.
+ * The scaling matrix is that of the resize module, including its treatment of the image borders.
+ *
+ * @param filter resampling filter
+ * @param in dimension of original vector
+ * @param out dimension of upscaled vector
+ * @param shift center shift relative to upscaled vector
+ * @return an initialized context
+ * @throws ZimgIllegalArgument on unsupported parameter combinations
+ */
+BilinearContext create_filter_context(const resize::Filter &filter, int in, int out, double shift);
+
+/**
+ * Coefficients of the reduced system at the interface between two partitions.
+ *
+ * The unknowns at interface t are the last row of partition t and the first row
+ * of partition t + 1. The reduced system is block tridiagonal with 2x2 blocks,
+ * and is solved by block LU decomposition.
+ */
+struct BilinearInterface {
+	/** Coupling of the last row of partition t to the last row of partition t - 1. */
+	float alpha;
+	/** Inverse of the pivot block, stored in row-major order. */
+	float pivot_inv[4];
+	/** Multipliers of the first row of partition t + 2 in back substitution. */
+	float upper[2];
+};
+
+/**
+ * Partitioned solver for (A' A) x = y', after the SPIKE algorithm.
+ * Only tridiagonal systems, as produced by the bilinear filter, are supported.
+ *
+ * The system is divided into diagonal blocks, one per partition. First, each
+ * block is solved independently with its own LU decomposition, ignoring the
+ * coupling to its neighbours. By linearity, the true solution within partition k
+ * spanning rows [s, e) is then
+ *
+ * x(i) = g(i) - v(i) * x(s - 1) - w(i) * x(e)
+ *
+ * g is the independent solution
+ * v is the "left spike", the solution with P(s, s - 1) at row s as right-hand side
+ * w is the "right spike", the solution with P(e - 1, e) at row e - 1 as right-hand side
+ *
+ * Evaluating this at the first and last row of each partition yields a reduced
+ * system of two unknowns per interface, which is solved sequentially. The spikes
+ * decay rapidly away from the end they originate from, so only their leading and
+ * trailing elements need to be applied to correct the interior of each partition.
+ */
+struct BilinearPartition {
+	/**
+	 * Context with the LU decomposition of each block in place of the whole system.
+	 * lu_c is 0 at the first and lu_u at the last row of each partition.
+	 */
+	BilinearContext context;
+
+	/** Number of rows in each partition. The last partition also holds the remainder. */
+	int partition_size;
+	int num_partitions;
+
+	/** Spikes v and w, indexed by row. */
+	AlignedVector<float> spike_v;
+	AlignedVector<float> spike_w;
+
+	/** Number of rows at the top (v) and bottom (w) of each partition where the spikes are not negligible. */
+	std::vector<int> spike_v_len;
+	std::vector<int> spike_w_len;
+
+	/** Reduced system, one entry per interface. */
+	std::vector<BilinearInterface> interfaces;
+};
+
+/**
+ * Initialize a BilinearPartition for a given scaling factor.
+ *
+ * @param in dimension of original vector
+ * @param out dimension of upscaled vector
+ * @param shift center shift relative to upscaled vector
+ * @param num_partitions number of partitions, each of which must hold at least two rows
+ * @return an initialized partition
+ */
+BilinearPartition create_bilinear_partition(int in, int out, double shift, int num_partitions);
+
 } // namespace unresize
 } // namespace zimg
 
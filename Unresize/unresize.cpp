@@ -1,19 +1,230 @@
 #include <algorithm>
+#include <cstdint>
 #include "Common/align.h"
 #include "Common/cpuinfo.h"
 #include "Common/except.h"
 #include "Common/pixel.h"
 #include "Common/tile.h"
+#include "bilinear.h"
 #include "unresize.h"
 #include "unresize_impl.h"
 
 namespace zimg {;
 namespace unresize {;
 
+namespace {;
+
+/**
+ * Number of scanlines converted at a time when unresizing WORD horizontally.
+ */
+const int WORD_BLOCK_ROWS = 32;
+
+/**
+ * Number of columns converted at a time when unresizing WORD vertically.
+ */
+const int WORD_BLOCK_COLS = 64;
+
+void load_word(const uint16_t *src, float *dst, int width)
+{
+	for (int j = 0; j < width; ++j) {
+		dst[j] = src[j];
+	}
+}
+
+/**
+ * Get the largest value representable in a WORD plane, falling back to 16 bits if the depth is not set.
+ */
+float word_max(const PlaneDescriptor *desc)
+{
+	int depth = desc->format.depth;
+	return depth > 0 && depth < 16 ? (float)((1 << depth) - 1) : (float)UINT16_MAX;
+}
+
+void store_word(const float *src, uint16_t *dst, int width, float max)
+{
+	for (int j = 0; j < width; ++j) {
+		float x = std::min(std::max(src[j], 0.0f), max);
+		dst[j] = (uint16_t)(x + 0.5f);
+	}
+}
+
+/**
+ * Unresize a WORD plane horizontally by converting blocks of scanlines to FLOAT around the FLOAT kernel.
+ */
+void process_word_h(const UnresizeImpl &impl, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp)
+{
+	int src_width = src.descriptor()->width;
+	int dst_width = dst.descriptor()->width;
+	int height = dst.descriptor()->height;
+	float max = word_max(dst.descriptor());
+
+	int src_stride = ceil_n(src_width, AlignmentOf<float>::value);
+	int dst_stride = ceil_n(dst_width, AlignmentOf<float>::value);
+
+	float *src_buf = tmp;
+	float *dst_buf = src_buf + (size_t)src_stride * WORD_BLOCK_ROWS;
+	float *line_buf = dst_buf + (size_t)dst_stride * WORD_BLOCK_ROWS;
+
+	PlaneDescriptor src_desc{ PixelType::FLOAT, src_width };
+	PlaneDescriptor dst_desc{ PixelType::FLOAT, dst_width };
+
+	for (int i = 0; i < height; i += WORD_BLOCK_ROWS) {
+		int n = std::min(height - i, WORD_BLOCK_ROWS);
+
+		src_desc.height = n;
+		dst_desc.height = n;
+
+		for (int ii = 0; ii < n; ++ii) {
+			load_word(src[i + ii], src_buf + (size_t)ii * src_stride, src_width);
+		}
+		impl.process_f32(ImageTile<const float>{ src_buf, &src_desc, src_stride * (int)sizeof(float) },
+		                 ImageTile<float>{ dst_buf, &dst_desc, dst_stride * (int)sizeof(float) }, line_buf);
+		for (int ii = 0; ii < n; ++ii) {
+			store_word(dst_buf + (size_t)ii * dst_stride, dst[i + ii], dst_width, max);
+		}
+	}
+}
+
+/**
+ * Unresize a WORD plane vertically by converting blocks of columns to FLOAT around the FLOAT kernel.
+ */
+void process_word_v(const UnresizeImpl &impl, const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, float *tmp)
+{
+	int src_height = src.descriptor()->height;
+	int dst_height = dst.descriptor()->height;
+	int width = dst.descriptor()->width;
+	float max = word_max(dst.descriptor());
+
+	float *src_buf = tmp;
+	float *dst_buf = src_buf + (size_t)src_height * WORD_BLOCK_COLS;
+
+	PlaneDescriptor src_desc{ PixelType::FLOAT, 0, src_height };
+	PlaneDescriptor dst_desc{ PixelType::FLOAT, 0, dst_height };
+
+	for (int j = 0; j < width; j += WORD_BLOCK_COLS) {
+		int n = std::min(width - j, WORD_BLOCK_COLS);
+
+		src_desc.width = n;
+		dst_desc.width = n;
+
+		for (int i = 0; i < src_height; ++i) {
+			load_word(src[i] + j, src_buf + (size_t)i * WORD_BLOCK_COLS, n);
+		}
+		impl.process_f32(ImageTile<const float>{ src_buf, &src_desc, WORD_BLOCK_COLS * (int)sizeof(float) },
+		                 ImageTile<float>{ dst_buf, &dst_desc, WORD_BLOCK_COLS * (int)sizeof(float) }, nullptr);
+		for (int i = 0; i < dst_height; ++i) {
+			store_word(dst_buf + (size_t)i * WORD_BLOCK_COLS, dst[i] + j, n, max);
+		}
+	}
+}
+
+void check_partition_type(PixelType type)
+{
+	if (type != PixelType::FLOAT)
+		throw ZimgUnsupportedError{ "only FLOAT supported for partitioned unresize" };
+}
+
+void partition_reduce(const BilinearPartition &part, const ImageTile<float> &dst)
+{
+	int width = dst.descriptor()->width;
+	int size = part.partition_size;
+
+	// Forward elimination, overwriting each boundary pair with its reduced right-hand side.
+	for (int t = 0; t < part.num_partitions - 1; ++t) {
+		const BilinearInterface &iface = part.interfaces[t];
+		const float *p = iface.pivot_inv;
+
+		const float *last_prev = t ? dst[t * size - 1] : nullptr;
+		float *last = dst[(t + 1) * size - 1];
+		float *first = dst[(t + 1) * size];
+
+		for (int j = 0; j < width; ++j) {
+			float r0 = last[j];
+			float r1 = first[j];
+
+			if (last_prev)
+				r0 -= iface.alpha * last_prev[j];
+
+			last[j] = p[0] * r0 + p[1] * r1;
+			first[j] = p[2] * r0 + p[3] * r1;
+		}
+	}
+
+	// Back substitution. The pair of the final interface is already solved.
+	for (int t = part.num_partitions - 3; t >= 0; --t) {
+		const BilinearInterface &iface = part.interfaces[t];
+
+		const float *first_next = dst[(t + 2) * size];
+		float *last = dst[(t + 1) * size - 1];
+		float *first = dst[(t + 1) * size];
+
+		for (int j = 0; j < width; ++j) {
+			last[j] -= iface.upper[0] * first_next[j];
+			first[j] -= iface.upper[1] * first_next[j];
+		}
+	}
+}
+
+void partition_fixup(const BilinearPartition &part, const ImageTile<float> &dst, int top, int bottom, int k)
+{
+	int width = dst.descriptor()->width;
+
+	// The reduced system solved the first row of every partition but the first,
+	// and the last row of every partition but the last. All other rows are corrected here.
+	int first = k != 0 ? top + 1 : top;
+	int last = k != part.num_partitions - 1 ? bottom - 1 : bottom;
+
+	if (k != 0) {
+		const float *prev = dst[top - 1];
+		int end = std::min(top + part.spike_v_len[k], last);
+
+		for (int i = first; i < end; ++i) {
+			float v = part.spike_v[i];
+			float *dst_ptr = dst[i];
+
+			for (int j = 0; j < width; ++j) {
+				dst_ptr[j] -= v * prev[j];
+			}
+		}
+	}
+	if (k != part.num_partitions - 1) {
+		const float *next = dst[bottom];
+		int begin = std::max(bottom - part.spike_w_len[k], first);
+
+		for (int i = begin; i < last; ++i) {
+			float w = part.spike_w[i];
+			float *dst_ptr = dst[i];
+
+			for (int j = 0; j < width; ++j) {
+				dst_ptr[j] -= w * next[j];
+			}
+		}
+	}
+}
+
+} // namespace
+
+
 Unresize::Unresize(bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu) try :
 	m_impl{ create_unresize_impl(horizontal, src_dim, dst_dim, shift, cpu) },
+	m_src_dim{ src_dim },
 	m_dst_dim{ dst_dim },
-	m_horizontal{ horizontal }
+	m_shift{ shift },
+	m_horizontal{ horizontal },
+	m_cpu{ cpu }
+{
+}
+catch (const std::bad_alloc &) {
+	throw ZimgOutOfMemory{};
+}
+
+Unresize::Unresize(const resize::Filter &filter, bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu) try :
+	m_impl{ create_unresize_impl(filter, horizontal, src_dim, dst_dim, shift, cpu) },
+	m_src_dim{ src_dim },
+	m_dst_dim{ dst_dim },
+	m_shift{ shift },
+	m_horizontal{ horizontal },
+	m_cpu{ cpu }
 {
 }
 catch (const std::bad_alloc &) {
@@ -32,23 +243,172 @@ size_t Unresize::tmp_size(PixelType type) const
 	if (m_horizontal)
 		size += (size_t)m_dst_dim * 8;
 
+	// Blocks of input and output converted from WORD, counted in floats until the end.
+	if (type == PixelType::WORD) {
+		if (m_horizontal)
+			size += (size_t)(ceil_n(m_src_dim, AlignmentOf<float>::value) + ceil_n(m_dst_dim, AlignmentOf<float>::value)) * WORD_BLOCK_ROWS;
+		else
+			size += (size_t)(m_src_dim + m_dst_dim) * WORD_BLOCK_COLS;
+
+		size *= sizeof(float) / sizeof(uint16_t);
+	}
+
 	return size;
 }
 
 void Unresize::process(const ImageTile<const void> &src, const ImageTile<void> &dst, void *tmp) const
 {
 	switch (src.descriptor()->format.type) {
+	case PixelType::WORD:
+		if (m_horizontal)
+			process_word_h(*m_impl, tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), (float *)tmp);
+		else
+			process_word_v(*m_impl, tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), (float *)tmp);
+		break;
 	case PixelType::HALF:
 		m_impl->process_f16(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), tmp);
 		break;
 	case PixelType::FLOAT:
 		m_impl->process_f32(tile_cast<const float>(src), tile_cast<float>(dst), tmp);
 		break;
+	default:
+		throw ZimgUnsupportedError{ "only WORD, HALF and FLOAT supported for unresize" };
+	}
+}
+
+void Unresize::dependent_rows(int dst_top, int dst_bottom, int *src_top, int *src_bottom) const
+{
+	if (m_horizontal) {
+		*src_top = dst_top;
+		*src_bottom = dst_bottom;
+	} else {
+		m_impl->dependent_interval(dst_top, dst_bottom, src_top, src_bottom);
+	}
+}
+
+void Unresize::process_strip(const ImageTile<const void> &src, const ImageTile<void> &dst, int dst_top, int dst_bottom, void *tmp) const
+{
+	PixelType type = src.descriptor()->format.type;
+
+	if (type != PixelType::HALF && type != PixelType::FLOAT)
+		throw ZimgUnsupportedError{ "only HALF and FLOAT supported for unresize" };
+
+	if (m_horizontal) {
+		PlaneDescriptor src_desc = *src.descriptor();
+		PlaneDescriptor dst_desc = *dst.descriptor();
+
+		src_desc.height = dst_bottom - dst_top;
+		dst_desc.height = dst_bottom - dst_top;
+
+		process(ImageTile<const void>{ src.data(), &src_desc, src.byte_stride() },
+		        ImageTile<void>{ dst.sub_tile(dst_top, 0).data(), &dst_desc, dst.byte_stride() }, tmp);
+	} else {
+		int src_top, src_bottom;
+
+		dependent_rows(dst_top, dst_bottom, &src_top, &src_bottom);
+
+		if (type == PixelType::HALF)
+			m_impl->forward_f16(tile_cast<const uint16_t>(src), tile_cast<uint16_t>(dst), src_top, dst_top, dst_bottom);
+		else
+			m_impl->forward_f32(tile_cast<const float>(src), tile_cast<float>(dst), src_top, dst_top, dst_bottom);
+	}
+}
+
+void Unresize::process_strip_back(const ImageTile<void> &dst, int dst_top, int dst_bottom) const
+{
+	if (m_horizontal)
+		return;
+
+	switch (dst.descriptor()->format.type) {
+	case PixelType::HALF:
+		m_impl->back_f16(tile_cast<uint16_t>(dst), dst_top, dst_bottom);
+		break;
+	case PixelType::FLOAT:
+		m_impl->back_f32(tile_cast<float>(dst), dst_top, dst_bottom);
+		break;
 	default:
 		throw ZimgUnsupportedError{ "only HALF and FLOAT supported for unresize" };
 	}
 }
 
+void Unresize::set_partitions(int count)
+{
+	if (m_horizontal)
+		throw ZimgUnsupportedError{ "partitioning only supported for vertical unresize" };
+	if (m_impl->bandwidth() != 1)
+		throw ZimgUnsupportedError{ "partitioning only supported for bilinear unresize" };
+	if (count < 1 || m_dst_dim / count < 2)
+		throw ZimgIllegalArgument{ "partitions must hold at least two rows" };
+
+	try {
+		if (count == 1) {
+			m_partition.reset();
+			m_partition_impl.reset();
+		} else {
+			std::shared_ptr<BilinearPartition> partition{ new BilinearPartition{ create_bilinear_partition(m_dst_dim, m_src_dim, m_shift, count) } };
+
+			m_partition_impl.reset(create_unresize_impl(partition->context, false, m_cpu));
+			m_partition = std::move(partition);
+		}
+	} catch (const std::bad_alloc &) {
+		throw ZimgOutOfMemory{};
+	}
+}
+
+int Unresize::num_partitions() const
+{
+	return m_partition ? m_partition->num_partitions : 1;
+}
+
+void Unresize::partition_rows(int k, int *dst_top, int *dst_bottom) const
+{
+	if (!m_partition) {
+		*dst_top = 0;
+		*dst_bottom = m_dst_dim;
+	} else {
+		*dst_top = k * m_partition->partition_size;
+		*dst_bottom = k == m_partition->num_partitions - 1 ? m_dst_dim : *dst_top + m_partition->partition_size;
+	}
+}
+
+void Unresize::process_partition(const ImageTile<const void> &src, const ImageTile<void> &dst, int k) const
+{
+	const UnresizeImpl *impl = m_partition ? m_partition_impl.get() : m_impl.get();
+	int dst_top, dst_bottom;
+	int src_top, src_bottom;
+
+	check_partition_type(src.descriptor()->format.type);
+
+	if (m_horizontal)
+		throw ZimgUnsupportedError{ "partitioning only supported for vertical unresize" };
+
+	partition_rows(k, &dst_top, &dst_bottom);
+	dependent_rows(dst_top, dst_bottom, &src_top, &src_bottom);
+
+	impl->forward_f32(tile_cast<const float>(src), tile_cast<float>(dst), src_top, dst_top, dst_bottom);
+	impl->back_f32(tile_cast<float>(dst), dst_top, dst_bottom);
+}
+
+void Unresize::process_partition_reduce(const ImageTile<void> &dst) const
+{
+	check_partition_type(dst.descriptor()->format.type);
+
+	if (m_partition)
+		partition_reduce(*m_partition, tile_cast<float>(dst));
+}
+
+void Unresize::process_partition_fixup(const ImageTile<void> &dst, int k) const
+{
+	int dst_top, dst_bottom;
+
+	check_partition_type(dst.descriptor()->format.type);
+
+	if (m_partition) {
+		partition_rows(k, &dst_top, &dst_bottom);
+		partition_fixup(*m_partition, tile_cast<float>(dst), dst_top, dst_bottom, k);
+	}
+}
+
 bool unresize_horizontal_first(double xscale, double yscale)
 {
 	// Downscaling cost is proportional to input size, whereas upscaling cost is proportional to output size.
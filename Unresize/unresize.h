@@ -14,12 +14,18 @@ enum class PixelType;
 template <class T>
 class ImageTile;
 
+namespace resize {;
+class Filter;
+} // namespace resize
+
 namespace unresize {;
 
 class UnresizeImpl;
+struct BilinearPartition;
 
 /**
- * Unresize: reverses the effect of the bilinear scaling method.
+ * Unresize: reverses the effect of the bilinear scaling method, or of another
+ * resampling filter.
  *
  * Linear interpolation in one dimension from an input dimension N to an
  * output dimension M can be represented as the matrix product:
@@ -49,7 +55,9 @@ class UnresizeImpl;
  *
  * Given the width of the bilinear filter, P is a tridiagonal matrix of
  * dimension N, and so the system can be solved by simple substitution after
- * LU factorization.
+ * LU factorization. For wider filters, such as bicubic or lanczos, P is a
+ * banded matrix, and c and u below are generalized to the Q off-diagonals of
+ * the factors, where Q is the bandwidth of P (see bilinear.h).
  *
  * Using a convention that U has a main diagonal of ones, the factoization is
  * given by the following.
@@ -94,14 +102,29 @@ class UnresizeImpl;
  *
  * Generalization to two dimensions is done by processing each dimension.
  *
+ * In the vertical direction, each row of z depends only on the preceding
+ * row and a band of input rows, and each row of x only on the following row.
+ * An image can therefore be processed in strips of rows, computing z over the
+ * strips from top to bottom, followed by x over the strips from bottom to top.
+ * Only the output plane and the input rows of the current strip are needed.
+ *
+ * Alternatively, the rows can be divided into partitions that are solved
+ * concurrently, followed by a small reduced system across the partition
+ * boundaries and an independent correction of each partition (see bilinear.h).
+ *
  *
  * In the class comments below, "input" refers to the upsampled image
  * and "output" refers to the unresized image.
  */
 class Unresize {
 	std::shared_ptr<UnresizeImpl> m_impl;
+	std::shared_ptr<UnresizeImpl> m_partition_impl;
+	std::shared_ptr<BilinearPartition> m_partition;
+	int m_src_dim;
 	int m_dst_dim;
+	double m_shift;
 	bool m_horizontal;
+	CPUClass m_cpu;
 public:
 	/**
 	 * Initialize a null context. Cannot be used for execution.
@@ -121,6 +144,14 @@ public:
 	 */
 	Unresize(bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu);
 
+	/**
+	 * Initialize a context to unresize a resampling with an arbitrary filter.
+	 *
+	 * @param filter resampling filter
+	 * @see Unresize::Unresize
+	 */
+	Unresize(const resize::Filter &filter, bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu);
+
 	/**
 	 * Destroy context.
 	 */
@@ -138,12 +169,110 @@ public:
 	 * Process an image. The input and output pixel formats must match.
 	 * The tile must span an entire plane.
 	 *
+	 * WORD is converted to FLOAT on load and back on store in blocks held in the
+	 * temporary buffer, so no intermediate FLOAT plane is needed. Values are
+	 * rounded and clamped to the range of a 16-bit integer.
+	 *
 	 * @param src input tile
 	 * @param dst output tile
 	 * @param tmp temporary buffer (@see Unresize::tmp_size)
 	 * @throws ZimgUnsupportedError if pixel type not supported
 	 */
 	void process(const ImageTile<const void> &src, const ImageTile<void> &dst, void *tmp) const;
+
+	/**
+	 * Get the range of input scanlines required to process a strip of output scanlines.
+	 *
+	 * @param dst_top first output row
+	 * @param dst_bottom one past last output row
+	 * @param src_top receives first input row
+	 * @param src_bottom receives one past last input row
+	 */
+	void dependent_rows(int dst_top, int dst_bottom, int *src_top, int *src_bottom) const;
+
+	/**
+	 * Process a strip of output scanlines. The input and output pixel formats must match.
+	 * Only HALF and FLOAT are supported.
+	 *
+	 * For horizontal unresizing, the strip is complete after this call. For vertical unresizing,
+	 * this applies the forward substitution, and the strips of a plane must be processed from
+	 * top to bottom, then passed to Unresize::process_strip_back from bottom to top.
+	 * Tiles spanning a range of columns may be processed independently when unresizing vertically.
+	 *
+	 * @param src input tile, starting at the first row given by Unresize::dependent_rows
+	 * @param dst output tile spanning the entire height of the plane
+	 * @param dst_top first output row
+	 * @param dst_bottom one past last output row
+	 * @param tmp temporary buffer (@see Unresize::tmp_size)
+	 * @throws ZimgUnsupportedError if pixel type not supported
+	 */
+	void process_strip(const ImageTile<const void> &src, const ImageTile<void> &dst, int dst_top, int dst_bottom, void *tmp) const;
+
+	/**
+	 * Complete a strip of output scanlines. Does nothing for horizontal unresizing.
+	 *
+	 * @see Unresize::process_strip
+	 */
+	void process_strip_back(const ImageTile<void> &dst, int dst_top, int dst_bottom) const;
+
+	/**
+	 * Divide the output rows of a vertical unresize into partitions that can be solved concurrently.
+	 * Must not be called while the context is being used for processing.
+	 *
+	 * A plane is processed by calling Unresize::process_partition for every partition,
+	 * then Unresize::process_partition_reduce once, then Unresize::process_partition_fixup
+	 * for every partition. Calls within each step may be made in any order and from any thread.
+	 *
+	 * @param count number of partitions, each of which must hold at least two rows
+	 * @throws ZimgIllegalArgument on invalid count
+	 * @throws ZimgUnsupportedError if the context is horizontal or not bilinear
+	 * @throws ZimgOutOfMemory if out of memory
+	 */
+	void set_partitions(int count);
+
+	/**
+	 * Get the number of partitions.
+	 *
+	 * @return number of partitions, or 1 if not partitioned
+	 */
+	int num_partitions() const;
+
+	/**
+	 * Get the output rows of a partition.
+	 *
+	 * @param k partition index
+	 * @param dst_top receives first output row
+	 * @param dst_bottom receives one past last output row
+	 */
+	void partition_rows(int k, int *dst_top, int *dst_bottom) const;
+
+	/**
+	 * Solve a partition independently of its neighbours. Only FLOAT is supported.
+	 *
+	 * @param src input tile, starting at the first row given by Unresize::dependent_rows for the partition
+	 * @param dst output tile spanning the entire plane
+	 * @param k partition index
+	 * @throws ZimgUnsupportedError if pixel type not supported
+	 */
+	void process_partition(const ImageTile<const void> &src, const ImageTile<void> &dst, int k) const;
+
+	/**
+	 * Solve the reduced system at the partition boundaries.
+	 * Tiles spanning a range of columns may be processed independently.
+	 *
+	 * @param dst output tile spanning the entire height of the plane
+	 * @throws ZimgUnsupportedError if pixel type not supported
+	 */
+	void process_partition_reduce(const ImageTile<void> &dst) const;
+
+	/**
+	 * Correct the interior of a partition with the solution at its boundaries.
+	 *
+	 * @param dst output tile spanning the entire height of the plane
+	 * @param k partition index
+	 * @throws ZimgUnsupportedError if pixel type not supported
+	 */
+	void process_partition_fixup(const ImageTile<void> &dst, int k) const;
 };
 
 /**
@@ -42,10 +42,20 @@ public:
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, void *tmp) const override
 	{
-		for (int i = 0; i < dst.descriptor()->height; ++i) {
-			filter_scanline_v_forward(m_context, src, dst, i, 0, dst.descriptor()->width, ScalarPolicy_F32{});
+		forward_f32(src, dst, 0, 0, dst.descriptor()->height);
+		back_f32(dst, 0, dst.descriptor()->height);
+	}
+
+	void forward_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int src_offset, int i_begin, int i_end) const override
+	{
+		for (int i = i_begin; i < i_end; ++i) {
+			filter_scanline_v_forward(m_context, src, dst, i, src_offset, 0, dst.descriptor()->width, ScalarPolicy_F32{});
 		}
-		for (int i = dst.descriptor()->height; i > 0; --i) {
+	}
+
+	void back_f32(const ImageTile<float> &dst, int i_begin, int i_end) const override
+	{
+		for (int i = i_end; i > i_begin; --i) {
 			filter_scanline_v_back(m_context, dst, i, 0, dst.descriptor()->width, ScalarPolicy_F32{});
 		}
 	}
@@ -63,18 +73,36 @@ UnresizeImpl::~UnresizeImpl()
 {
 }
 
-UnresizeImpl *create_unresize_impl(bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu)
+void UnresizeImpl::dependent_interval(int dst_begin, int dst_end, int *src_begin, int *src_end) const
 {
-	BilinearContext context;
-	BilinearContext vcontext;
-	UnresizeImpl *ret = nullptr;
+	*src_begin = m_context.matrix_row_offsets[dst_begin];
+	*src_end = m_context.matrix_row_offsets[dst_end - 1] + m_context.matrix_row_size;
+}
 
-	if (dst_dim == src_dim)
-		throw ZimgIllegalArgument("input dimensions must differ from output");
-	if (dst_dim > src_dim)
-		throw ZimgIllegalArgument("input dimension must be greater than output");
+void UnresizeImpl::forward_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int src_offset, int i_begin, int i_end) const
+{
+	throw ZimgUnsupportedError{ "f16 not supported in impl" };
+}
+
+void UnresizeImpl::forward_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int src_offset, int i_begin, int i_end) const
+{
+	throw ZimgUnsupportedError{ "strip processing not supported in impl" };
+}
+
+void UnresizeImpl::back_f16(const ImageTile<uint16_t> &dst, int i_begin, int i_end) const
+{
+	throw ZimgUnsupportedError{ "f16 not supported in impl" };
+}
+
+void UnresizeImpl::back_f32(const ImageTile<float> &dst, int i_begin, int i_end) const
+{
+	throw ZimgUnsupportedError{ "strip processing not supported in impl" };
+}
+
+UnresizeImpl *create_unresize_impl(const BilinearContext &context, bool horizontal, CPUClass cpu)
+{
+	UnresizeImpl *ret = nullptr;
 
-	context = create_bilinear_context(dst_dim, src_dim, shift);
 #ifdef ZIMG_X86
 	ret = create_unresize_impl_x86(context, horizontal, cpu);
 #endif
@@ -84,5 +112,25 @@ UnresizeImpl *create_unresize_impl(bool horizontal, int src_dim, int dst_dim, do
 	return ret;
 }
 
+UnresizeImpl *create_unresize_impl(bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu)
+{
+	if (dst_dim == src_dim)
+		throw ZimgIllegalArgument("input dimensions must differ from output");
+	if (dst_dim > src_dim)
+		throw ZimgIllegalArgument("input dimension must be greater than output");
+
+	return create_unresize_impl(create_bilinear_context(dst_dim, src_dim, shift), horizontal, cpu);
+}
+
+UnresizeImpl *create_unresize_impl(const resize::Filter &filter, bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu)
+{
+	if (dst_dim == src_dim)
+		throw ZimgIllegalArgument("input dimensions must differ from output");
+	if (dst_dim > src_dim)
+		throw ZimgIllegalArgument("input dimension must be greater than output");
+
+	return create_unresize_impl(create_filter_context(filter, dst_dim, src_dim, shift), horizontal, cpu);
+}
+
 } // namespace unresize
 } // namespace zimg
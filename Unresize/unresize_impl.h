@@ -29,8 +29,7 @@ inline FORCE_INLINE void filter_scanline_h_forward(const BilinearContext &ctx, c
 {
 	const float *c = ctx.lu_c.data();
 	const float *l = ctx.lu_l.data();
-
-	float z = j_begin ? policy.load(&src[i][j_begin - 1]) : 0;
+	int q = ctx.lu_bandwidth;
 
 	// Matrix-vector product, and forward substitution loop.
 	for (int j = j_begin; j < j_end; ++j) {
@@ -44,7 +43,13 @@ inline FORCE_INLINE void filter_scanline_h_forward(const BilinearContext &ctx, c
 			accum += coeff * x;
 		}
 
-		z = (accum - c[j] * z) * l[j];
+		float z = accum;
+		for (int k = 0; k < q; ++k) {
+			if (c[j * q + k])
+				z -= c[j * q + k] * policy.load(&tmp[j - 1 - k]);
+		}
+
+		z = z * l[j];
 		policy.store(&tmp[j], z);
 	}
 }
@@ -54,30 +59,33 @@ inline FORCE_INLINE void filter_scanline_h_back(const BilinearContext &ctx, cons
 												int i, int j_begin, int j_end, Policy policy)
 {
 	const float *u = ctx.lu_u.data();
-
-	int dst_width = dst.descriptor()->width;
-	float w = j_begin < dst_width ? policy.load(&dst[i][j_begin]) : 0;
+	int q = ctx.lu_bandwidth;
 
 	// Backward substitution.
 	for (int j = j_begin; j > j_end; --j) {
-		w = policy.load(&tmp[j - 1]) - u[j - 1] * w;
+		float w = policy.load(&tmp[j - 1]);
+
+		for (int k = 0; k < q; ++k) {
+			if (u[(j - 1) * q + k])
+				w -= u[(j - 1) * q + k] * policy.load(&dst[i][j + k]);
+		}
+
 		policy.store(&dst[i][j - 1], w);
 	}
 }
 
 template <class T, class Policy>
 inline FORCE_INLINE void filter_scanline_v_forward(const BilinearContext &ctx, const ImageTile<const T> &src, const ImageTile<T> &dst,
-												   int i, int j_begin, int j_end, Policy policy)
+												   int i, int src_offset, int j_begin, int j_end, Policy policy)
 {
-	const float *c = ctx.lu_c.data();
+	const float *c = ctx.lu_c.data() + i * ctx.lu_bandwidth;
 	const float *l = ctx.lu_l.data();
+	int q = ctx.lu_bandwidth;
 
 	const float *row = ctx.matrix_coefficients.data() + i * ctx.matrix_row_stride;
-	int top = ctx.matrix_row_offsets[i];
+	int top = ctx.matrix_row_offsets[i] - src_offset;
 
 	for (int j = j_begin; j < j_end; ++j) {
-		float z = i ? policy.load(&dst[i - 1][j]) : 0;
-
 		float accum = 0;
 		for (int k = 0; k < ctx.matrix_row_size; ++k) {
 			float coeff = row[k];
@@ -85,7 +93,13 @@ inline FORCE_INLINE void filter_scanline_v_forward(const BilinearContext &ctx, c
 			accum += coeff * x;
 		}
 
-		z = (accum - c[i] * z) * l[i];
+		float z = accum;
+		for (int k = 0; k < q; ++k) {
+			if (c[k])
+				z -= c[k] * policy.load(&dst[i - 1 - k][j]);
+		}
+
+		z = z * l[i];
 		policy.store(&dst[i][j], z);
 	}
 }
@@ -93,13 +107,17 @@ inline FORCE_INLINE void filter_scanline_v_forward(const BilinearContext &ctx, c
 template <class T, class Policy>
 inline FORCE_INLINE void filter_scanline_v_back(const BilinearContext &ctx, const ImageTile<T> &dst, int i, int j_begin, int j_end, Policy policy)
 {
-	const float *u = ctx.lu_u.data();
-	int dst_height = dst.descriptor()->height;
+	const float *u = ctx.lu_u.data() + (i - 1) * ctx.lu_bandwidth;
+	int q = ctx.lu_bandwidth;
 
 	for (ptrdiff_t j = j_begin; j < j_end; ++j) {
-		float w = i < dst_height ? policy.load(&dst[i][j]) : 0;
+		float w = policy.load(&dst[i - 1][j]);
+
+		for (int k = 0; k < q; ++k) {
+			if (u[k])
+				w -= u[k] * policy.load(&dst[i + k][j]);
+		}
 
-		w = policy.load(&dst[i - 1][j]) - u[i - 1] * w;
 		policy.store(&dst[i - 1][j], w);
 	}
 }
@@ -130,6 +148,55 @@ public:
 	virtual void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, void *tmp) const = 0;
 
 	virtual void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, void *tmp) const = 0;
+
+	/**
+	 * Get the range of input indices required to compute a range of output indices.
+	 *
+	 * @param dst_begin first output index
+	 * @param dst_end one past last output index
+	 * @param src_begin receives first input index
+	 * @param src_end receives one past last input index
+	 */
+	void dependent_interval(int dst_begin, int dst_end, int *src_begin, int *src_end) const;
+
+	/**
+	 * Get the number of off-diagonals in each triangular factor.
+	 *
+	 * @return bandwidth, 1 for bilinear
+	 */
+	int bandwidth() const { return m_context.lu_bandwidth; }
+
+	/**
+	 * Apply the matrix product and forward substitution to the rows [i_begin, i_end) of a vertical unresize.
+	 * The destination spans the entire plane, and must hold the result of the preceding rows.
+	 *
+	 * @param src input tile, whose first row is row src_offset of the input plane
+	 * @param dst output plane
+	 * @param src_offset index of first input row
+	 * @param i_begin first output row
+	 * @param i_end one past last output row
+	 */
+	virtual void forward_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int src_offset, int i_begin, int i_end) const;
+
+	/**
+	 * @see UnresizeImpl::forward_f16
+	 */
+	virtual void forward_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int src_offset, int i_begin, int i_end) const;
+
+	/**
+	 * Apply the back substitution to the rows [i_begin, i_end) of a vertical unresize.
+	 * The rows following i_end must have been processed.
+	 *
+	 * @param dst output plane
+	 * @param i_begin first output row
+	 * @param i_end one past last output row
+	 */
+	virtual void back_f16(const ImageTile<uint16_t> &dst, int i_begin, int i_end) const;
+
+	/**
+	 * @see UnresizeImpl::back_f16
+	 */
+	virtual void back_f32(const ImageTile<float> &dst, int i_begin, int i_end) const;
 };
 
 /**
@@ -139,6 +206,23 @@ public:
  */
 UnresizeImpl *create_unresize_impl(bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu);
 
+/**
+ * Create and allocate a execution kernel for a resampling filter.
+ *
+ * @see Unresize::Unresize
+ */
+UnresizeImpl *create_unresize_impl(const resize::Filter &filter, bool horizontal, int src_dim, int dst_dim, double shift, CPUClass cpu);
+
+/**
+ * Create an execution kernel for the given coefficients.
+ *
+ * @param context coefficients
+ * @param horizontal whether the kernel operates horizontally
+ * @param cpu create kernel optimized for given cpu
+ * @return concrete kernel
+ */
+UnresizeImpl *create_unresize_impl(const BilinearContext &context, bool horizontal, CPUClass cpu);
+
 } // namespace unresize
 } // namespace zimg
 
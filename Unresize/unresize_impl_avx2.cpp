@@ -66,7 +66,7 @@ inline FORCE_INLINE void transpose8_ps(__m256 &row0, __m256 &row1, __m256 &row2,
 	row7 = _mm256_permute2f128_ps(tt3, tt7, 0x31);
 }
 
-template <bool DoLoop, class T, class Policy>
+template <bool DoLoop, bool Banded, class T, class Policy>
 void filter_plane_h_avx2(const BilinearContext &ctx, const ImageTile<const T> &src, const ImageTile<T> &dst, T *tmp, Policy policy)
 {
 	const float *matrix_data = ctx.matrix_coefficients.data();
@@ -80,6 +80,7 @@ void filter_plane_h_avx2(const BilinearContext &ctx, const ImageTile<const T> &s
 	const float *pc = ctx.lu_c.data();
 	const float *pl = ctx.lu_l.data();
 	const float *pu = ctx.lu_u.data();
+	int q = ctx.lu_bandwidth;
 
 	for (int i = 0; i < floor_n(dst_height, 8); i += 8) {
 		const T *src_ptr0 = src[i + 0];
@@ -162,10 +163,19 @@ void filter_plane_h_avx2(const BilinearContext &ctx, const ImageTile<const T> &s
 			accum1 = _mm256_add_ps(accum1, accum3);
 
 			__m256 f = _mm256_add_ps(accum0, accum1);
-			__m256 c = _mm256_broadcast_ss(&pc[j]);
 			__m256 l = _mm256_broadcast_ss(&pl[j]);
 
-			z = _mm256_fnmadd_ps(c, z, f);
+			if (Banded) {
+				z = f;
+				for (int k = 0; k < q; ++k) {
+					if (pc[j * q + k])
+						z = _mm256_fnmadd_ps(_mm256_broadcast_ss(&pc[j * q + k]), policy.load_8(&tmp[(j - 1 - k) * 8]), z);
+				}
+			} else {
+				__m256 c = _mm256_broadcast_ss(&pc[j]);
+
+				z = _mm256_fnmadd_ps(c, z, f);
+			}
 			z = _mm256_mul_ps(z, l);
 
 			policy.store_8(&tmp[j * 8], z);
@@ -181,11 +191,54 @@ void filter_plane_h_avx2(const BilinearContext &ctx, const ImageTile<const T> &s
 				for (int k = 0; k < ctx.matrix_row_size; ++k) {
 					accum += matrix_row[k] * policy.load(&src[i + ii][left + k]);
 				}
-				policy.store(&tmp[j * 8 + ii], (accum - pc[j] * policy.load(&tmp[(j - 1) * 8 + ii])) * pl[j]);
+				for (int k = 0; k < q; ++k) {
+					if (pc[j * q + k])
+						accum -= pc[j * q + k] * policy.load(&tmp[(j - 1 - k) * 8 + ii]);
+				}
+				policy.store(&tmp[j * 8 + ii], accum * pl[j]);
 			}
 		}
 
 		// Backward substitution and output loop.
+		if (Banded) {
+			for (int j = dst_width; j > 0; --j) {
+				__m256 w = policy.load_8(&tmp[(j - 1) * 8]);
+
+				for (int k = 0; k < q; ++k) {
+					if (pu[(j - 1) * q + k])
+						w = _mm256_fnmadd_ps(_mm256_broadcast_ss(&pu[(j - 1) * q + k]), policy.load_8(&tmp[(j + k) * 8]), w);
+				}
+				policy.store_8(&tmp[(j - 1) * 8], w);
+			}
+			for (int j = 0; j < floor_n(dst_width, 8); j += 8) {
+				__m256 w0 = policy.load_8(&tmp[(j + 0) * 8]);
+				__m256 w1 = policy.load_8(&tmp[(j + 1) * 8]);
+				__m256 w2 = policy.load_8(&tmp[(j + 2) * 8]);
+				__m256 w3 = policy.load_8(&tmp[(j + 3) * 8]);
+				__m256 w4 = policy.load_8(&tmp[(j + 4) * 8]);
+				__m256 w5 = policy.load_8(&tmp[(j + 5) * 8]);
+				__m256 w6 = policy.load_8(&tmp[(j + 6) * 8]);
+				__m256 w7 = policy.load_8(&tmp[(j + 7) * 8]);
+
+				transpose8_ps(w0, w1, w2, w3, w4, w5, w6, w7);
+
+				policy.store_8(&dst_ptr0[j], w0);
+				policy.store_8(&dst_ptr1[j], w1);
+				policy.store_8(&dst_ptr2[j], w2);
+				policy.store_8(&dst_ptr3[j], w3);
+				policy.store_8(&dst_ptr4[j], w4);
+				policy.store_8(&dst_ptr5[j], w5);
+				policy.store_8(&dst_ptr6[j], w6);
+				policy.store_8(&dst_ptr7[j], w7);
+			}
+			for (int j = floor_n(dst_width, 8); j < dst_width; ++j) {
+				for (int ii = 0; ii < 8; ++ii) {
+					policy.store(&dst[i + ii][j], policy.load(&tmp[j * 8 + ii]));
+				}
+			}
+			continue;
+		}
+
 		__m256 w = _mm256_setzero_ps();
 		for (int j = dst_width; j > floor_n(dst_width, 8); --j) {
 			float w_buf[8];
@@ -262,22 +315,63 @@ void filter_plane_h_avx2(const BilinearContext &ctx, const ImageTile<const T> &s
 }
 
 template <class T, class Policy>
-void filter_plane_v_avx2(const BilinearContext &ctx, const ImageTile<const T> &src, const ImageTile<T> &dst, Policy policy)
+void filter_line_v_forward_banded_avx2(const BilinearContext &ctx, const ImageTile<T> &dst, int i, int width, Policy policy)
+{
+	const float *c = ctx.lu_c.data() + i * ctx.lu_bandwidth;
+	__m256 l = _mm256_broadcast_ss(&ctx.lu_l[i]);
+	int q = ctx.lu_bandwidth;
+
+	T *dst_ptr = dst[i];
+
+	for (int j = 0; j < width; j += 8) {
+		__m256 z = policy.load_8(&dst_ptr[j]);
+
+		for (int k = 0; k < q; ++k) {
+			if (c[k])
+				z = _mm256_fnmadd_ps(_mm256_broadcast_ss(&c[k]), policy.load_8(&dst[i - 1 - k][j]), z);
+		}
+
+		z = _mm256_mul_ps(z, l);
+		policy.store_8(&dst_ptr[j], z);
+	}
+}
+
+template <class T, class Policy>
+void filter_line_v_back_banded_avx2(const BilinearContext &ctx, const ImageTile<T> &dst, int i, int width, Policy policy)
+{
+	const float *u = ctx.lu_u.data() + (i - 1) * ctx.lu_bandwidth;
+	int q = ctx.lu_bandwidth;
+
+	T *dst_ptr = dst[i - 1];
+
+	for (int j = 0; j < width; j += 8) {
+		__m256 w = policy.load_8(&dst_ptr[j]);
+
+		for (int k = 0; k < q; ++k) {
+			if (u[k])
+				w = _mm256_fnmadd_ps(_mm256_broadcast_ss(&u[k]), policy.load_8(&dst[i + k][j]), w);
+		}
+
+		policy.store_8(&dst_ptr[j], w);
+	}
+}
+
+template <class T, class Policy>
+void filter_plane_v_forward_avx2(const BilinearContext &ctx, const ImageTile<const T> &src, const ImageTile<T> &dst,
+                                 int src_offset, int i_begin, int i_end, Policy policy)
 {
 	const float *matrix_data = ctx.matrix_coefficients.data();
 	const int *matrix_left = ctx.matrix_row_offsets.data();
 	int matrix_stride = ctx.matrix_row_stride;
 
 	int dst_width = dst.descriptor()->width;
-	int dst_height = dst.descriptor()->height;
 
 	const float *pc = ctx.lu_c.data();
 	const float *pl = ctx.lu_l.data();
-	const float *pu = ctx.lu_u.data();
 
-	for (int i = 0; i < dst_height; ++i) {
+	for (int i = i_begin; i < i_end; ++i) {
 		const float *matrix_row = &matrix_data[i * matrix_stride];
-		int top = matrix_left[i];
+		int top = matrix_left[i] - src_offset;
 
 		T *dst_ptr = dst[i];
 
@@ -403,37 +497,52 @@ void filter_plane_v_avx2(const BilinearContext &ctx, const ImageTile<const T> &s
 		}
 
 		// Forward substitution.
-		__m256 c = _mm256_broadcast_ss(&pc[i]);
-		__m256 l = _mm256_broadcast_ss(&pl[i]);
+		if (ctx.lu_bandwidth == 1) {
+			__m256 c = _mm256_broadcast_ss(&pc[i]);
+			__m256 l = _mm256_broadcast_ss(&pl[i]);
 
-		const T *dst_prev = i ? dst[i - 1] : nullptr;
+			const T *dst_prev = pc[i] ? dst[i - 1] : nullptr;
 
-		for (int j = 0; j < floor_n(dst_width, 8); j += 8) {
-			__m256 z = i ? policy.load_8(&dst_prev[j]) : _mm256_setzero_ps();
-			__m256 f = policy.load_8(&dst_ptr[j]);
+			for (int j = 0; j < floor_n(dst_width, 8); j += 8) {
+				__m256 z = dst_prev ? policy.load_8(&dst_prev[j]) : _mm256_setzero_ps();
+				__m256 f = policy.load_8(&dst_ptr[j]);
 
-			z = _mm256_fnmadd_ps(c, z, f);
-			z = _mm256_mul_ps(z, l);
+				z = _mm256_fnmadd_ps(c, z, f);
+				z = _mm256_mul_ps(z, l);
 
-			policy.store_8(&dst_ptr[j], z);
+				policy.store_8(&dst_ptr[j], z);
+			}
+		} else {
+			filter_line_v_forward_banded_avx2(ctx, dst, i, floor_n(dst_width, 8), policy);
 		}
-		
-		filter_scanline_v_forward(ctx, src, dst, i, floor_n(dst_width, 8), dst_width, policy);
+
+		filter_scanline_v_forward(ctx, src, dst, i, src_offset, floor_n(dst_width, 8), dst_width, policy);
 	}
+}
+
+template <class T, class Policy>
+void filter_plane_v_back_avx2(const BilinearContext &ctx, const ImageTile<T> &dst, int i_begin, int i_end, Policy policy)
+{
+	int dst_width = dst.descriptor()->width;
+
+	const float *pu = ctx.lu_u.data();
 
-	// Back substitution.
-	for (int i = dst_height; i > 0; --i) {
-		__m256 u = _mm256_broadcast_ss(pu + i - 1);
+	for (int i = i_end; i > i_begin; --i) {
+		if (ctx.lu_bandwidth == 1) {
+			__m256 u = _mm256_broadcast_ss(pu + i - 1);
 
-		const T *dst_prev = i < dst_height ? dst[i] : nullptr;
-		T *dst_ptr = dst[i - 1];
+			const T *dst_prev = pu[i - 1] ? dst[i] : nullptr;
+			T *dst_ptr = dst[i - 1];
 
-		for (int j = 0; j < floor_n(dst_width, 8); j += 8) {
-			__m256 w = i < dst_height ? policy.load_8(&dst_prev[j]) : _mm256_setzero_ps();
-			__m256 z = policy.load_8(&dst_ptr[j]);
+			for (int j = 0; j < floor_n(dst_width, 8); j += 8) {
+				__m256 w = dst_prev ? policy.load_8(&dst_prev[j]) : _mm256_setzero_ps();
+				__m256 z = policy.load_8(&dst_ptr[j]);
 
-			w = _mm256_fnmadd_ps(u, w, z);
-			policy.store_8(&dst_ptr[j], w);
+				w = _mm256_fnmadd_ps(u, w, z);
+				policy.store_8(&dst_ptr[j], w);
+			}
+		} else {
+			filter_line_v_back_banded_avx2(ctx, dst, i, floor_n(dst_width, 8), policy);
 		}
 		filter_scanline_v_back(ctx, dst, i, floor_n(dst_width, 8), dst_width, policy);
 	}
@@ -446,18 +555,32 @@ public:
 
 	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, void *tmp) const override
 	{
-		if (m_context.matrix_row_size > 8)
-			filter_plane_h_avx2<true>(m_context, src, dst, (uint16_t *)tmp, VectorPolicy_F16{});
-		else
-			filter_plane_h_avx2<false>(m_context, src, dst, (uint16_t *)tmp, VectorPolicy_F16{});
+		if (m_context.lu_bandwidth != 1) {
+			if (m_context.matrix_row_size > 8)
+				filter_plane_h_avx2<true, true>(m_context, src, dst, (uint16_t *)tmp, VectorPolicy_F16{});
+			else
+				filter_plane_h_avx2<false, true>(m_context, src, dst, (uint16_t *)tmp, VectorPolicy_F16{});
+		} else {
+			if (m_context.matrix_row_size > 8)
+				filter_plane_h_avx2<true, false>(m_context, src, dst, (uint16_t *)tmp, VectorPolicy_F16{});
+			else
+				filter_plane_h_avx2<false, false>(m_context, src, dst, (uint16_t *)tmp, VectorPolicy_F16{});
+		}
 	}
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, void *tmp) const override
 	{
-		if (m_context.matrix_row_size > 8)
-			filter_plane_h_avx2<true>(m_context, src, dst, (float *)tmp, VectorPolicy_F32{});
-		else
-			filter_plane_h_avx2<false>(m_context, src, dst, (float *)tmp, VectorPolicy_F32{});
+		if (m_context.lu_bandwidth != 1) {
+			if (m_context.matrix_row_size > 8)
+				filter_plane_h_avx2<true, true>(m_context, src, dst, (float *)tmp, VectorPolicy_F32{});
+			else
+				filter_plane_h_avx2<false, true>(m_context, src, dst, (float *)tmp, VectorPolicy_F32{});
+		} else {
+			if (m_context.matrix_row_size > 8)
+				filter_plane_h_avx2<true, false>(m_context, src, dst, (float *)tmp, VectorPolicy_F32{});
+			else
+				filter_plane_h_avx2<false, false>(m_context, src, dst, (float *)tmp, VectorPolicy_F32{});
+		}
 	}
 };
 
@@ -468,12 +591,34 @@ public:
 
 	void process_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, void *tmp) const override
 	{
-		filter_plane_v_avx2(m_context, src, dst, VectorPolicy_F16{});
+		forward_f16(src, dst, 0, 0, dst.descriptor()->height);
+		back_f16(dst, 0, dst.descriptor()->height);
 	}
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, void *tmp) const override
 	{
-		filter_plane_v_avx2(m_context, src, dst, VectorPolicy_F32{});
+		forward_f32(src, dst, 0, 0, dst.descriptor()->height);
+		back_f32(dst, 0, dst.descriptor()->height);
+	}
+
+	void forward_f16(const ImageTile<const uint16_t> &src, const ImageTile<uint16_t> &dst, int src_offset, int i_begin, int i_end) const override
+	{
+		filter_plane_v_forward_avx2(m_context, src, dst, src_offset, i_begin, i_end, VectorPolicy_F16{});
+	}
+
+	void forward_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int src_offset, int i_begin, int i_end) const override
+	{
+		filter_plane_v_forward_avx2(m_context, src, dst, src_offset, i_begin, i_end, VectorPolicy_F32{});
+	}
+
+	void back_f16(const ImageTile<uint16_t> &dst, int i_begin, int i_end) const override
+	{
+		filter_plane_v_back_avx2(m_context, dst, i_begin, i_end, VectorPolicy_F16{});
+	}
+
+	void back_f32(const ImageTile<float> &dst, int i_begin, int i_end) const override
+	{
+		filter_plane_v_back_avx2(m_context, dst, i_begin, i_end, VectorPolicy_F32{});
 	}
 };
 
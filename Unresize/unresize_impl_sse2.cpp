@@ -32,7 +32,7 @@ inline FORCE_INLINE void transpose4_ps(__m128 &x0, __m128 &x1, __m128 &x2, __m12
 	x3 = _mm_castpd_ps(o3);
 }
 
-template <bool DoLoop, class T>
+template <bool DoLoop, bool Banded, class T>
 void filter_plane_h_sse2(const BilinearContext &ctx, const ImageTile<const T> &src, const ImageTile<T> &dst, float *tmp)
 {
 	const float *matrix_data = ctx.matrix_coefficients.data();
@@ -46,6 +46,7 @@ void filter_plane_h_sse2(const BilinearContext &ctx, const ImageTile<const T> &s
 	const float *pc = ctx.lu_c.data();
 	const float *pl = ctx.lu_l.data();
 	const float *pu = ctx.lu_u.data();
+	int q = ctx.lu_bandwidth;
 
 	for (int i = 0; i < floor_n(dst_height, 4); i += 4) {
 		const float *src_ptr0 = src[i + 0];
@@ -98,11 +99,20 @@ void filter_plane_h_sse2(const BilinearContext &ctx, const ImageTile<const T> &s
 
 			// Forward substitution.
 			__m128 f = _mm_add_ps(accum0, accum1);
-			__m128 c = _mm_set_ps1(pc[j]);
 			__m128 l = _mm_set_ps1(pl[j]);
 
-			z = _mm_mul_ps(c, z);
-			z = _mm_sub_ps(f, z);
+			if (Banded) {
+				z = f;
+				for (int k = 0; k < q; ++k) {
+					if (pc[j * q + k])
+						z = _mm_sub_ps(z, _mm_mul_ps(_mm_set_ps1(pc[j * q + k]), _mm_load_ps(&tmp[(j - 1 - k) * 4])));
+				}
+			} else {
+				__m128 c = _mm_set_ps1(pc[j]);
+
+				z = _mm_mul_ps(c, z);
+				z = _mm_sub_ps(f, z);
+			}
 			z = _mm_mul_ps(z, l);
 
 			_mm_store_ps(&tmp[j * 4], z);
@@ -118,11 +128,46 @@ void filter_plane_h_sse2(const BilinearContext &ctx, const ImageTile<const T> &s
 				for (int k = 0; k < ctx.matrix_row_size; ++k) {
 					accum += matrix_row[k] * src[i + ii][left + k];
 				}
-				tmp[j * 4 + ii] = (accum - pc[j] * tmp[(j - 1) * 4 + ii]) * pl[j];
+				for (int k = 0; k < q; ++k) {
+					if (pc[j * q + k])
+						accum -= pc[j * q + k] * tmp[(j - 1 - k) * 4 + ii];
+				}
+				tmp[j * 4 + ii] = accum * pl[j];
 			}
 		}
 
 		// Backward substitution and output loop.
+		if (Banded) {
+			for (int j = dst_width; j > 0; --j) {
+				__m128 w = _mm_load_ps(&tmp[(j - 1) * 4]);
+
+				for (int k = 0; k < q; ++k) {
+					if (pu[(j - 1) * q + k])
+						w = _mm_sub_ps(w, _mm_mul_ps(_mm_set_ps1(pu[(j - 1) * q + k]), _mm_load_ps(&tmp[(j + k) * 4])));
+				}
+				_mm_store_ps(&tmp[(j - 1) * 4], w);
+			}
+			for (int j = 0; j < floor_n(dst_width, 4); j += 4) {
+				__m128 w0 = _mm_load_ps(&tmp[(j + 0) * 4]);
+				__m128 w1 = _mm_load_ps(&tmp[(j + 1) * 4]);
+				__m128 w2 = _mm_load_ps(&tmp[(j + 2) * 4]);
+				__m128 w3 = _mm_load_ps(&tmp[(j + 3) * 4]);
+
+				transpose4_ps(w0, w1, w2, w3);
+
+				_mm_store_ps(&dst_ptr0[j], w0);
+				_mm_store_ps(&dst_ptr1[j], w1);
+				_mm_store_ps(&dst_ptr2[j], w2);
+				_mm_store_ps(&dst_ptr3[j], w3);
+			}
+			for (int j = floor_n(dst_width, 4); j < dst_width; ++j) {
+				for (int ii = 0; ii < 4; ++ii) {
+					dst[i + ii][j] = tmp[j * 4 + ii];
+				}
+			}
+			continue;
+		}
+
 		__m128 w = _mm_setzero_ps();
 		for (int j = dst_width; j > floor_n(dst_width, 4); --j) {
 			float w_buf[4];
@@ -178,22 +223,61 @@ void filter_plane_h_sse2(const BilinearContext &ctx, const ImageTile<const T> &s
 	}
 }
 
-void filter_plane_v_sse2(const BilinearContext &ctx, const ImageTile<const float> &src, const ImageTile<float> &dst)
+void filter_line_v_forward_banded_sse2(const BilinearContext &ctx, const ImageTile<float> &dst, int i, int width)
+{
+	const float *c = ctx.lu_c.data() + i * ctx.lu_bandwidth;
+	__m128 l = _mm_set_ps1(ctx.lu_l[i]);
+	int q = ctx.lu_bandwidth;
+
+	float *dst_ptr = dst[i];
+
+	for (int j = 0; j < width; j += 4) {
+		__m128 z = _mm_load_ps(&dst_ptr[j]);
+
+		for (int k = 0; k < q; ++k) {
+			if (c[k])
+				z = _mm_sub_ps(z, _mm_mul_ps(_mm_set_ps1(c[k]), _mm_load_ps(&dst[i - 1 - k][j])));
+		}
+
+		z = _mm_mul_ps(z, l);
+		_mm_store_ps(&dst_ptr[j], z);
+	}
+}
+
+void filter_line_v_back_banded_sse2(const BilinearContext &ctx, const ImageTile<float> &dst, int i, int width)
+{
+	const float *u = ctx.lu_u.data() + (i - 1) * ctx.lu_bandwidth;
+	int q = ctx.lu_bandwidth;
+
+	float *dst_ptr = dst[i - 1];
+
+	for (int j = 0; j < width; j += 4) {
+		__m128 w = _mm_load_ps(&dst_ptr[j]);
+
+		for (int k = 0; k < q; ++k) {
+			if (u[k])
+				w = _mm_sub_ps(w, _mm_mul_ps(_mm_set_ps1(u[k]), _mm_load_ps(&dst[i + k][j])));
+		}
+
+		_mm_store_ps(&dst_ptr[j], w);
+	}
+}
+
+void filter_plane_v_forward_sse2(const BilinearContext &ctx, const ImageTile<const float> &src, const ImageTile<float> &dst,
+                                 int src_offset, int i_begin, int i_end)
 {
 	const float *matrix_data = ctx.matrix_coefficients.data();
 	const int *matrix_left = ctx.matrix_row_offsets.data();
 	int matrix_stride = ctx.matrix_row_stride;
 
 	int dst_width = dst.descriptor()->width;
-	int dst_height = dst.descriptor()->height;
 
 	const float *pc = ctx.lu_c.data();
 	const float *pl = ctx.lu_l.data();
-	const float *pu = ctx.lu_u.data();
 
-	for (int i = 0; i < dst_height; ++i) {
+	for (int i = i_begin; i < i_end; ++i) {
 		const float *matrix_row = &matrix_data[i * matrix_stride];
-		int top = matrix_left[i];
+		int top = matrix_left[i] - src_offset;
 
 		float *dst_ptr = dst[i];
 
@@ -276,39 +360,53 @@ void filter_plane_v_sse2(const BilinearContext &ctx, const ImageTile<const float
 		}
 
 		// Forward substitution.
-		__m128 c = _mm_set_ps1(pc[i]);
-		__m128 l = _mm_set_ps1(pl[i]);
+		if (ctx.lu_bandwidth == 1) {
+			__m128 c = _mm_set_ps1(pc[i]);
+			__m128 l = _mm_set_ps1(pl[i]);
 
-		const float *dst_prev = i ? dst[i - 1] : nullptr;
+			const float *dst_prev = pc[i] ? dst[i - 1] : nullptr;
 
-		for (int j = 0; j < floor_n(dst_width, 4); j += 4) {
-			__m128 z = i ? _mm_load_ps(&dst_prev[j]) : _mm_setzero_ps();
-			__m128 f = _mm_load_ps(&dst_ptr[j]);
+			for (int j = 0; j < floor_n(dst_width, 4); j += 4) {
+				__m128 z = dst_prev ? _mm_load_ps(&dst_prev[j]) : _mm_setzero_ps();
+				__m128 f = _mm_load_ps(&dst_ptr[j]);
 
-			z = _mm_mul_ps(c, z);
-			z = _mm_sub_ps(f, z);
-			z = _mm_mul_ps(z, l);
+				z = _mm_mul_ps(c, z);
+				z = _mm_sub_ps(f, z);
+				z = _mm_mul_ps(z, l);
 
-			_mm_store_ps(&dst_ptr[j], z);
+				_mm_store_ps(&dst_ptr[j], z);
+			}
+		} else {
+			filter_line_v_forward_banded_sse2(ctx, dst, i, floor_n(dst_width, 4));
 		}
-		filter_scanline_v_forward(ctx, src, dst, i, floor_n(dst_width, 4), dst_width, ScalarPolicy_F32{});
+		filter_scanline_v_forward(ctx, src, dst, i, src_offset, floor_n(dst_width, 4), dst_width, ScalarPolicy_F32{});
 	}
+}
+
+void filter_plane_v_back_sse2(const BilinearContext &ctx, const ImageTile<float> &dst, int i_begin, int i_end)
+{
+	int dst_width = dst.descriptor()->width;
+
+	const float *pu = ctx.lu_u.data();
 
-	// Back substitution.
-	for (int i = dst_height; i > 0; --i) {
-		__m128 u = _mm_set_ps1(pu[i - 1]);
+	for (int i = i_end; i > i_begin; --i) {
+		if (ctx.lu_bandwidth == 1) {
+			__m128 u = _mm_set_ps1(pu[i - 1]);
 
-		const float *dst_prev = i < dst_width ? dst[i] : nullptr;
-		float *dst_ptr = dst[i - 1];
+			const float *dst_prev = pu[i - 1] ? dst[i] : nullptr;
+			float *dst_ptr = dst[i - 1];
 
-		for (int j = 0; j < floor_n(dst_width, 4); j += 4) {
-			__m128 w = i < dst_height ? _mm_load_ps(&dst_prev[j]) : _mm_setzero_ps();
-			__m128 z = _mm_load_ps(&dst_ptr[j]);
-			
-			w = _mm_mul_ps(u, w);
-			w = _mm_sub_ps(z, w);
+			for (int j = 0; j < floor_n(dst_width, 4); j += 4) {
+				__m128 w = dst_prev ? _mm_load_ps(&dst_prev[j]) : _mm_setzero_ps();
+				__m128 z = _mm_load_ps(&dst_ptr[j]);
 
-			_mm_store_ps(&dst_ptr[j], w);
+				w = _mm_mul_ps(u, w);
+				w = _mm_sub_ps(z, w);
+
+				_mm_store_ps(&dst_ptr[j], w);
+			}
+		} else {
+			filter_line_v_back_banded_sse2(ctx, dst, i, floor_n(dst_width, 4));
 		}
 		filter_scanline_v_back(ctx, dst, i, floor_n(dst_width, 4), dst_width, ScalarPolicy_F32{});
 	}
@@ -326,10 +424,17 @@ public:
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, void *tmp) const override
 	{
-		if (m_context.matrix_row_size > 4)
-			filter_plane_h_sse2<true>(m_context, src, dst, (float *)tmp);
-		else
-			filter_plane_h_sse2<false>(m_context, src, dst, (float *)tmp);
+		if (m_context.lu_bandwidth != 1) {
+			if (m_context.matrix_row_size > 4)
+				filter_plane_h_sse2<true, true>(m_context, src, dst, (float *)tmp);
+			else
+				filter_plane_h_sse2<false, true>(m_context, src, dst, (float *)tmp);
+		} else {
+			if (m_context.matrix_row_size > 4)
+				filter_plane_h_sse2<true, false>(m_context, src, dst, (float *)tmp);
+			else
+				filter_plane_h_sse2<false, false>(m_context, src, dst, (float *)tmp);
+		}
 	}
 };
 
@@ -345,7 +450,18 @@ public:
 
 	void process_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, void *tmp) const override
 	{
-		filter_plane_v_sse2(m_context, src, dst);
+		filter_plane_v_forward_sse2(m_context, src, dst, 0, 0, dst.descriptor()->height);
+		filter_plane_v_back_sse2(m_context, dst, 0, dst.descriptor()->height);
+	}
+
+	void forward_f32(const ImageTile<const float> &src, const ImageTile<float> &dst, int src_offset, int i_begin, int i_end) const override
+	{
+		filter_plane_v_forward_sse2(m_context, src, dst, src_offset, i_begin, i_end);
+	}
+
+	void back_f32(const ImageTile<float> &dst, int i_begin, int i_end) const override
+	{
+		filter_plane_v_back_sse2(m_context, dst, i_begin, i_end);
 	}
 };
 
@@ -12,6 +12,18 @@
   #error zAPI v1 or greater required
 #endif
 
+#ifdef _MSC_VER
+  #include <intrin.h>
+  #define vs_try_lock(p) (_InterlockedCompareExchange((volatile long *)(p), 1, 0) == 0)
+  #define vs_unlock(p) _InterlockedExchange((volatile long *)(p), 0)
+#else
+  #define vs_try_lock(p) __sync_bool_compare_and_swap((p), 0, 1)
+  #define vs_unlock(p) __sync_lock_release((p))
+#endif
+
+/* Maximum number of threads that can hold a scratch buffer from the same instance at once. */
+#define VS_SCRATCH_SLOTS 64
+
 typedef enum chroma_location {
 	CHROMA_LOC_MPEG1,
 	CHROMA_LOC_MPEG2
@@ -27,6 +39,14 @@ static int translate_dither(const char *dither)
 		return ZIMG_DITHER_RANDOM;
 	else if (!strcmp(dither, "error_diffusion"))
 		return ZIMG_DITHER_ERROR_DIFFUSION;
+	else if (!strcmp(dither, "blue_noise"))
+		return ZIMG_DITHER_BLUE_NOISE;
+	else if (!strcmp(dither, "sierra_lite"))
+		return ZIMG_DITHER_SIERRA_LITE;
+	else if (!strcmp(dither, "error_diffusion_row"))
+		return ZIMG_DITHER_ERROR_DIFFUSION_ROW;
+	else if (!strcmp(dither, "error_diffusion_serpentine"))
+		return ZIMG_DITHER_ERROR_DIFFUSION_SERPENTINE;
 	else
 		return ZIMG_DITHER_NONE;
 }
@@ -85,10 +105,74 @@ static double chroma_adjust_v(const char *loc_in, const char *loc_out, int subsa
 }
 
 
+/**
+ * Grow-only temporary buffers of a filter instance. Each thread processing a frame holds one slot,
+ * so once every slot has grown to the largest size requested, no allocation is done per frame.
+ */
+typedef struct vs_scratch_pool {
+	struct {
+		volatile long busy;
+		size_t size;
+		void *ptr;
+	} slots[VS_SCRATCH_SLOTS];
+} vs_scratch_pool;
+
+/* Take a buffer of [size] bytes. The slot index, or -1 for a private buffer, is stored in [slot]. */
+static void *vs_scratch_acquire(vs_scratch_pool *pool, size_t size, int *slot)
+{
+	void *ptr = 0;
+	int i;
+
+	for (i = 0; i < VS_SCRATCH_SLOTS; ++i) {
+		if (!vs_try_lock(&pool->slots[i].busy))
+			continue;
+
+		if (pool->slots[i].size < size) {
+			VS_ALIGNED_FREE(pool->slots[i].ptr);
+			pool->slots[i].ptr = 0;
+			pool->slots[i].size = 0;
+
+			VS_ALIGNED_MALLOC(&pool->slots[i].ptr, size, 32);
+			if (!pool->slots[i].ptr) {
+				vs_unlock(&pool->slots[i].busy);
+				return 0;
+			}
+			pool->slots[i].size = size;
+		}
+
+		*slot = i;
+		return pool->slots[i].ptr;
+	}
+
+	/* More threads than slots. */
+	VS_ALIGNED_MALLOC(&ptr, size, 32);
+	*slot = -1;
+	return ptr;
+}
+
+static void vs_scratch_release(vs_scratch_pool *pool, void *ptr, int slot)
+{
+	if (slot < 0)
+		VS_ALIGNED_FREE(ptr);
+	else
+		vs_unlock(&pool->slots[slot].busy);
+}
+
+static void vs_scratch_free(vs_scratch_pool *pool)
+{
+	int i;
+
+	for (i = 0; i < VS_SCRATCH_SLOTS; ++i) {
+		VS_ALIGNED_FREE(pool->slots[i].ptr);
+	}
+}
+
+
 typedef struct vs_colorspace_data {
 	zimg_colorspace_context *colorspace_ctx;
 	VSNodeRef *node;
 	VSVideoInfo vi;
+	vs_scratch_pool scratch;
 } vs_colorspace_data;
 
 static void VS_CC vs_colorspace_init(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
@@ -124,6 +208,7 @@ static const VSFrameRef * VS_CC vs_colorspace_get_frame(int n, int activationRea
 
 		size_t tmp_size;
 		void *tmp = 0;
+		int tmp_slot = -1;
 
 		dst_frame = vsapi->newVideoFrame(data->vi.format, width, height, src_frame, core);
 		
@@ -135,7 +220,7 @@ static const VSFrameRef * VS_CC vs_colorspace_get_frame(int n, int activationRea
 		}
 
 		tmp_size = _zimg_colorspace_plane_tmp_size(data->colorspace_ctx, pixel_type);
-		VS_ALIGNED_MALLOC(&tmp, tmp_size, 32);
+		tmp = vs_scratch_acquire(&data->scratch, tmp_size, &tmp_slot);
 		if (!tmp) {
 			strcpy(fail_str, "error allocating temporary buffer");
 			err = 1;
@@ -149,7 +234,8 @@ static const VSFrameRef * VS_CC vs_colorspace_get_frame(int n, int activationRea
 	fail:
 		vsapi->freeFrame(src_frame);
 		vsapi->freeFrame(dst_frame);
-		VS_ALIGNED_FREE(tmp);
+		if (tmp)
+			vs_scratch_release(&data->scratch, tmp, tmp_slot);
 	}
 
 	if (err)
@@ -162,6 +248,7 @@ static void VS_CC vs_colorspace_free(void *instanceData, VSCore *core, const VSA
 	vs_colorspace_data *data = instanceData;
 	zimg_colorspace_delete(data->colorspace_ctx);
 	vsapi->freeNode(data->node);
+	vs_scratch_free(&data->scratch);
 	free(data);
 }
 
@@ -230,7 +317,7 @@ static void VS_CC vs_colorspace_create(const VSMap *in, VSMap *out, void *userDa
 		goto fail;
 	}
 
-	data = malloc(sizeof(vs_colorspace_data));
+	data = calloc(1, sizeof(vs_colorspace_data));
 	if (!data) {
 		strcpy(fail_str, "error allocating vs_colorspace_data");
 		goto fail;
@@ -257,6 +344,7 @@ typedef struct vs_depth_data {
 	VSVideoInfo vi;
 	int tv_in;
 	int tv_out;
+	vs_scratch_pool scratch;
 } vs_depth_data;
 
 static void VS_CC vs_depth_init(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
@@ -289,9 +377,10 @@ static const VSFrameRef * VS_CC vs_depth_get_frame(int n, int activationReason,
 		int yuv = src_format->colorFamily == cmYUV || src_format->colorFamily == cmYCoCg;
 
 		void *tmp = 0;
+		int tmp_slot = -1;
 		size_t tmp_size = _zimg_depth_plane_tmp_size(data->depth_ctx, vsapi->getFrameWidth(src_frame, 0), src_pixel, dst_pixel);
 
-		VS_ALIGNED_MALLOC(&tmp, tmp_size, 32);
+		tmp = vs_scratch_acquire(&data->scratch, tmp_size, &tmp_slot);
 		if (!tmp) {
 			strcpy(fail_str, "error allocating temporary buffer");
 			err = 1;
@@ -299,21 +388,22 @@ static const VSFrameRef * VS_CC vs_depth_get_frame(int n, int activationReason,
 		}
 
 		for (p = 0; p < data->vi.format->numPlanes; ++p) {
-			_zimg_depth_plane_process(data->depth_ctx,
-			                          vsapi->getReadPtr(src_frame, p),
-			                          vsapi->getWritePtr(dst_frame, p),
-			                          tmp,
-			                          vsapi->getFrameWidth(src_frame, p),
-			                          vsapi->getFrameHeight(src_frame, p),
-			                          vsapi->getStride(src_frame, p),
-			                          vsapi->getStride(dst_frame, p),
-			                          src_pixel,
-			                          dst_pixel,
-			                          src_format->bitsPerSample,
-			                          dst_format->bitsPerSample,
-			                          data->tv_in,
-			                          data->tv_out,
-			                          p > 0 && yuv);
+			_zimg_depth_plane_process_seeded(data->depth_ctx,
+			                                 vsapi->getReadPtr(src_frame, p),
+			                                 vsapi->getWritePtr(dst_frame, p),
+			                                 tmp,
+			                                 vsapi->getFrameWidth(src_frame, p),
+			                                 vsapi->getFrameHeight(src_frame, p),
+			                                 vsapi->getStride(src_frame, p),
+			                                 vsapi->getStride(dst_frame, p),
+			                                 src_pixel,
+			                                 dst_pixel,
+			                                 src_format->bitsPerSample,
+			                                 dst_format->bitsPerSample,
+			                                 data->tv_in,
+			                                 data->tv_out,
+			                                 p > 0 && yuv,
+			                                 ((unsigned)n << 2) | p);
 			if (err) {
 				zimg_get_last_error(fail_str, sizeof(fail_str));
 				goto fail;
@@ -324,7 +414,8 @@ static const VSFrameRef * VS_CC vs_depth_get_frame(int n, int activationReason,
 	fail:
 		vsapi->freeFrame(src_frame);
 		vsapi->freeFrame(dst_frame);
-		VS_ALIGNED_FREE(tmp);
+		if (tmp)
+			vs_scratch_release(&data->scratch, tmp, tmp_slot);
 	}
 
 	if (err)
@@ -337,6 +428,7 @@ static void VS_CC vs_depth_free(void *instanceData, VSCore *core, const VSAPI *v
 	vs_depth_data *data = instanceData;
 	zimg_depth_delete(data->depth_ctx);
 	vsapi->freeNode(data->node);
+	vs_scratch_free(&data->scratch);
 	free(data);
 }
 
@@ -419,7 +511,7 @@ static void VS_CC vs_depth_create(const VSMap *in, VSMap *out, void *userData, V
 		goto fail;
 	}
 
-	data = malloc(sizeof(vs_depth_data));
+	data = calloc(1, sizeof(vs_depth_data));
 	if (!data) {
 		strcpy(fail_str, "error allocating vs_depth_data");
 		goto fail;
@@ -456,6 +548,7 @@ typedef struct vs_resize_data {
 
 	VSNodeRef *node;
 	VSVideoInfo vi;
+	vs_scratch_pool scratch;
 } vs_resize_data;
 
 static void VS_CC vs_resize_init(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
@@ -484,6 +577,7 @@ static const VSFrameRef * VS_CC vs_resize_get_frame(int n, int activationReason,
 		int pixel_type = translate_pixel(format);
 
 		void *tmp = 0;
+		int tmp_slot = -1;
 		size_t tmp_size = 0;
 
 		for (p = 0; p < format->numPlanes; ++p) {
@@ -515,7 +609,7 @@ static const VSFrameRef * VS_CC vs_resize_get_frame(int n, int activationReason,
 			tmp_size = tmp_size > local_sz ? tmp_size : local_sz;
 		}
 
-		VS_ALIGNED_MALLOC(&tmp, tmp_size, 32);
+		tmp = vs_scratch_acquire(&data->scratch, tmp_size, &tmp_slot);
 		if (!tmp) {
 			strcpy(fail_str, "error allocating temporary buffer");
 			err = 1;
@@ -563,7 +657,8 @@ static const VSFrameRef * VS_CC vs_resize_get_frame(int n, int activationReason,
 	fail:
 		vsapi->freeFrame(src_frame);
 		vsapi->freeFrame(dst_frame);
-		VS_ALIGNED_FREE(tmp);
+		if (tmp)
+			vs_scratch_release(&data->scratch, tmp, tmp_slot);
 	}
 
 	if (err)
@@ -579,6 +674,7 @@ static void VS_CC vs_resize_free(void *instanceData, VSCore *core, const VSAPI *
 	zimg_resize_delete(data->resize_ctx_y_2);
 	zimg_resize_delete(data->resize_ctx_uv_1);
 	zimg_resize_delete(data->resize_ctx_uv_2);
+	vs_scratch_free(&data->scratch);
 	free(data);
 }
 
@@ -793,7 +889,7 @@ static void VS_CC vs_resize_create(const VSMap *in, VSMap *out, void *userData,
 		use_y_as_uv = 1;
 	}
 
-	data = malloc(sizeof(vs_resize_data));
+	data = calloc(1, sizeof(vs_resize_data));
 	if (!data) {
 		strcpy(fail_str, "error allocaing vs_resize_data");
 		goto fail;
@@ -843,7 +939,7 @@ static void VS_CC vs_resize_create(const VSMap *in, VSMap *out, void *userData,
 
 	if (!use_y_as_uv && !skip_h_uv && !skip_v_uv) {
 		data->tmp_width_uv = hfirst_uv ? width >> subsample_w : node_vi->width >> node_vi->format->subSamplingW;
-		data->tmp_height_uv = hfirst_uv ? node_vi->width >> node_vi->format->subSamplingH : height >> subsample_h;
+		data->tmp_height_uv = hfirst_uv ? node_vi->height >> node_vi->format->subSamplingH : height >> subsample_h;
 	} else {
 		data->tmp_width_uv = 0;
 		data->tmp_height_uv = 0;
@@ -863,74 +959,1117 @@ fail:
 	return;
 }
 
-static void VS_CC vs_set_cpu(const VSMap *in, VSMap *out, void *userData, VSCore *core, const VSAPI *vsapi)
+typedef struct vs_unresize_data {
+	zimg_unresize_context *unresize_ctx_y_1;
+	zimg_unresize_context *unresize_ctx_y_2;
+	zimg_unresize_context *unresize_ctx_uv_1;
+	zimg_unresize_context *unresize_ctx_uv_2;
+
+	int use_y_as_uv;
+	int tmp_width_y;
+	int tmp_width_uv;
+	int tmp_height_y;
+	int tmp_height_uv;
+
+	VSNodeRef *node;
+	VSVideoInfo vi;
+	vs_scratch_pool scratch;
+} vs_unresize_data;
+
+static int vs_unresize_plane(zimg_unresize_context *ctx, const void *src, void *dst, void *tmp,
+                             int src_width, int src_height, int dst_width, int dst_height, int src_stride, int dst_stride, int pixel_type, int depth)
 {
-	const char *cpu = vsapi->propGetData(in, "cpu", 0, 0);
+	zimg_image_tile_t src_tile = { 0 };
+	zimg_image_tile_t dst_tile = { 0 };
+
+	src_tile.buffer = (void *)src;
+	src_tile.stride = src_stride;
+	src_tile.pixel_type = pixel_type;
+	src_tile.plane_width = src_width;
+	src_tile.plane_height = src_height;
+	src_tile.depth = depth;
+
+	dst_tile.buffer = dst;
+	dst_tile.stride = dst_stride;
+	dst_tile.pixel_type = pixel_type;
+	dst_tile.plane_width = dst_width;
+	dst_tile.plane_height = dst_height;
+	dst_tile.depth = depth;
+
+	return zimg_unresize_process(ctx, &src_tile, &dst_tile, tmp);
+}
 
-	if (!strcmp(cpu, "none"))
-		zimg_set_cpu(ZIMG_CPU_NONE);
-	else if (!strcmp(cpu, "auto"))
-		zimg_set_cpu(ZIMG_CPU_AUTO);
-#if defined(__i386) || defined(_M_IX86) || defined(_M_X64) || defined(__x86_64__)
-	else if (!strcmp(cpu, "mmx"))
-		zimg_set_cpu(ZIMG_CPU_X86_MMX);
-	else if (!strcmp(cpu, "sse"))
-		zimg_set_cpu(ZIMG_CPU_X86_SSE);
-	else if (!strcmp(cpu, "sse2"))
-		zimg_set_cpu(ZIMG_CPU_X86_SSE2);
-	else if (!strcmp(cpu, "sse3"))
-		zimg_set_cpu(ZIMG_CPU_X86_SSE3);
-	else if (!strcmp(cpu, "ssse3"))
-		zimg_set_cpu(ZIMG_CPU_X86_SSSE3);
-	else if (!strcmp(cpu, "sse41"))
-		zimg_set_cpu(ZIMG_CPU_X86_SSE41);
-	else if (!strcmp(cpu, "sse42"))
-		zimg_set_cpu(ZIMG_CPU_X86_SSE42);
-	else if (!strcmp(cpu, "avx"))
-		zimg_set_cpu(ZIMG_CPU_X86_AVX);
-	else if (!strcmp(cpu, "f16c"))
-		zimg_set_cpu(ZIMG_CPU_X86_F16C);
-	else if (!strcmp(cpu, "avx2"))
-		zimg_set_cpu(ZIMG_CPU_X86_AVX2);
-#endif
-	else
-		zimg_set_cpu(ZIMG_CPU_NONE);
+static void VS_CC vs_unresize_init(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
+{
+	const vs_unresize_data *data = *instanceData;
+	vsapi->setVideoInfo(&data->vi, 1, node);
 }
 
-VS_EXTERNAL_API(void) VapourSynthPluginInit(VSConfigPlugin configFunc, VSRegisterFunction registerFunc, VSPlugin *plugin)
+static const VSFrameRef * VS_CC vs_unresize_get_frame(int n, int activationReason, void **instanceData, void **frameData, VSFrameContext *frameCtx, VSCore *core, const VSAPI *vsapi)
 {
-	configFunc("the.weather.channel", "z", "batman", VAPOURSYNTH_API_VERSION, 1, plugin);
+	vs_unresize_data *data = *instanceData;
+	VSFrameRef *ret = 0;
+	char fail_str[1024] = { 0 };
+	int err = 0;
+	int p;
 
-	registerFunc("Colorspace", "clip:clip;"
-	                           "matrix_in:int;"
-	                           "transfer_in:int;"
-	                           "primaries_in:int;"
-	                           "matrix_out:int:opt;"
-	                           "transfer_out:int:opt;"
-	                           "primaries_out:int:opt", vs_colorspace_create, 0, plugin);
-	registerFunc("Depth", "clip:clip;"
-	                      "dither:data:opt;"
-	                      "sample:int:opt;"
-	                      "depth:int:opt;"
-	                      "fullrange_in:int:opt;"
-	                      "fullrange_out:int:opt", vs_depth_create, 0, plugin);
-	registerFunc("Resize", "clip:clip;"
-	                       "width:int;"
-	                       "height:int;"
-	                       "filter:data:opt;"
-	                       "filter_param_a:float:opt;"
-	                       "filter_param_b:float:opt;"
-	                       "shift_w:float:opt;"
-	                       "shift_h:float:opt;"
-	                       "subwidth:float:opt;"
-	                       "subheight:float:opt;"
-	                       "filter_uv:data:opt;"
-	                       "filter_param_a_uv:float:opt;"
-	                       "filter_param_b_uv:float:opt;"
-	                       "subsample_w:int:opt;"
-	                       "subsample_h:int:opt;"
-	                       "chroma_loc_in:data:opt;"
-	                       "chroma_loc_out:data:opt;", vs_resize_create, 0, plugin);
+	zimg_clear_last_error();
+
+	if (activationReason == arInitial) {
+		vsapi->requestFrameFilter(n, data->node, frameCtx);
+	} else if (activationReason == arAllFramesReady) {
+		const VSFrameRef *src_frame = vsapi->getFrameFilter(n, data->node, frameCtx);
+		VSFrameRef *dst_frame = vsapi->newVideoFrame(data->vi.format, data->vi.width, data->vi.height, src_frame, core);
+		VSFrameRef *tmp_frame = 0;
+
+		const VSFormat *format = data->vi.format;
+		int pixel_type = translate_pixel(format);
+
+		void *tmp = 0;
+		int tmp_slot = -1;
+		size_t tmp_size = 0;
+
+		for (p = 0; p < format->numPlanes; ++p) {
+			int uv = p == 1 || p == 2;
+
+			zimg_unresize_context *unresize_1 = (uv && !data->use_y_as_uv) ? data->unresize_ctx_uv_1 : data->unresize_ctx_y_1;
+			zimg_unresize_context *unresize_2 = (uv && !data->use_y_as_uv) ? data->unresize_ctx_uv_2 : data->unresize_ctx_y_2;
+
+			size_t sz1 = unresize_1 ? zimg_unresize_tmp_size(unresize_1, pixel_type) : 0;
+			size_t sz2 = unresize_2 ? zimg_unresize_tmp_size(unresize_2, pixel_type) : 0;
+
+			tmp_size = tmp_size > sz1 ? tmp_size : sz1;
+			tmp_size = tmp_size > sz2 ? tmp_size : sz2;
+		}
+
+		if (tmp_size) {
+			tmp = vs_scratch_acquire(&data->scratch, tmp_size, &tmp_slot);
+			if (!tmp) {
+				strcpy(fail_str, "error allocating temporary buffer");
+				err = 1;
+				goto fail;
+			}
+		}
+
+		for (p = 0; p < format->numPlanes; ++p) {
+			int uv = p == 1 || p == 2;
+
+			zimg_unresize_context *unresize_1 = (uv && !data->use_y_as_uv) ? data->unresize_ctx_uv_1 : data->unresize_ctx_y_1;
+			zimg_unresize_context *unresize_2 = (uv && !data->use_y_as_uv) ? data->unresize_ctx_uv_2 : data->unresize_ctx_y_2;
+
+			int src_width = vsapi->getFrameWidth(src_frame, p);
+			int src_height = vsapi->getFrameHeight(src_frame, p);
+			int src_stride = vsapi->getStride(src_frame, p);
+
+			int dst_width = vsapi->getFrameWidth(dst_frame, p);
+			int dst_height = vsapi->getFrameHeight(dst_frame, p);
+			int dst_stride = vsapi->getStride(dst_frame, p);
+
+			const void *src_p = vsapi->getReadPtr(src_frame, p);
+			void *dst_p = vsapi->getWritePtr(dst_frame, p);
+
+			if (unresize_1 && unresize_2) {
+				int tmp_width = (uv && !data->use_y_as_uv) ? data->tmp_width_uv : data->tmp_width_y;
+				int tmp_height = (uv && !data->use_y_as_uv) ? data->tmp_height_uv : data->tmp_height_y;
+
+				const VSFormat *tmp_format = vsapi->registerFormat(cmGray, format->sampleType, format->bitsPerSample, 0, 0, core);
+				void *tmp_p;
+				int tmp_stride;
+
+				tmp_frame = vsapi->newVideoFrame(tmp_format, tmp_width, tmp_height, 0, core);
+				tmp_p = vsapi->getWritePtr(tmp_frame, 0);
+				tmp_stride = vsapi->getStride(tmp_frame, 0);
+
+				err = vs_unresize_plane(unresize_1, src_p, tmp_p, tmp, src_width, src_height, tmp_width, tmp_height, src_stride, tmp_stride, pixel_type, format->bitsPerSample);
+				if (!err)
+					err = vs_unresize_plane(unresize_2, tmp_p, dst_p, tmp, tmp_width, tmp_height, dst_width, dst_height, tmp_stride, dst_stride, pixel_type, format->bitsPerSample);
+
+				vsapi->freeFrame(tmp_frame);
+				tmp_frame = 0;
+			} else if (unresize_1) {
+				err = vs_unresize_plane(unresize_1, src_p, dst_p, tmp, src_width, src_height, dst_width, dst_height, src_stride, dst_stride, pixel_type, format->bitsPerSample);
+			} else {
+				vs_bitblt(dst_p, dst_stride, src_p, src_stride, dst_width * format->bytesPerSample, dst_height);
+			}
+
+			if (err) {
+				zimg_get_last_error(fail_str, sizeof(fail_str));
+				goto fail;
+			}
+		}
+		ret = dst_frame;
+		dst_frame = 0;
+	fail:
+		vsapi->freeFrame(src_frame);
+		vsapi->freeFrame(dst_frame);
+		if (tmp)
+			vs_scratch_release(&data->scratch, tmp, tmp_slot);
+	}
+
+	if (err)
+		vsapi->setFilterError(fail_str, frameCtx);
+	return ret;
+}
+
+static void VS_CC vs_unresize_free(void *instanceData, VSCore *core, const VSAPI *vsapi)
+{
+	vs_unresize_data *data = instanceData;
+	vsapi->freeNode(data->node);
+	zimg_unresize_delete(data->unresize_ctx_y_1);
+	zimg_unresize_delete(data->unresize_ctx_y_2);
+	zimg_unresize_delete(data->unresize_ctx_uv_1);
+	zimg_unresize_delete(data->unresize_ctx_uv_2);
+	vs_scratch_free(&data->scratch);
+	free(data);
+}
+
+static int vs_unresize_create_pair(int filter_type, double filter_param_a, double filter_param_b,
+                                   int src_width, int src_height, int width, int height, double shift_w, double shift_h,
+                                   zimg_unresize_context **ctx_1, zimg_unresize_context **ctx_2, int *tmp_width, int *tmp_height)
+{
+	zimg_unresize_context *ctx_h = 0;
+	zimg_unresize_context *ctx_v = 0;
+	int hfirst;
+
+	if (src_width != width && !(ctx_h = zimg_unresize_create(filter_type, 1, src_width, width, shift_w, filter_param_a, filter_param_b)))
+		return 1;
+	if (src_height != height && !(ctx_v = zimg_unresize_create(filter_type, 0, src_height, height, shift_h, filter_param_a, filter_param_b))) {
+		zimg_unresize_delete(ctx_h);
+		return 1;
+	}
+
+	hfirst = zimg_unresize_horizontal_first((double)width / src_width, (double)height / src_height);
+
+	if (ctx_h && ctx_v) {
+		*ctx_1 = hfirst ? ctx_h : ctx_v;
+		*ctx_2 = hfirst ? ctx_v : ctx_h;
+		*tmp_width = hfirst ? width : src_width;
+		*tmp_height = hfirst ? src_height : height;
+	} else {
+		*ctx_1 = ctx_h ? ctx_h : ctx_v;
+		*ctx_2 = 0;
+		*tmp_width = 0;
+		*tmp_height = 0;
+	}
+
+	return 0;
+}
+
+static void VS_CC vs_unresize_create(const VSMap *in, VSMap *out, void *userData, VSCore *core, const VSAPI *vsapi)
+{
+	vs_unresize_data *data = 0;
+	char fail_str[1024] = { 0 };
+	int err;
+
+	VSNodeRef *node = 0;
+	const VSVideoInfo *node_vi;
+	const VSFormat *node_fmt;
+
+	int width;
+	int height;
+	const char *filter;
+	double filter_param_a;
+	double filter_param_b;
+	double shift_w;
+	double shift_h;
+
+	node = vsapi->propGetNode(in, "clip", 0, 0);
+	node_vi = vsapi->getVideoInfo(node);
+	node_fmt = node_vi->format;
+
+	if (!isConstantFormat(node_vi)) {
+		strcpy(fail_str, "clip must have constant format");
+		goto fail;
+	}
+	if (node_fmt->sampleType != stFloat && node_fmt->bytesPerSample != 2) {
+		strcpy(fail_str, "clip must be WORD, HALF or FLOAT");
+		goto fail;
+	}
+
+	width = (int)vsapi->propGetInt(in, "width", 0, 0);
+	height = (int)vsapi->propGetInt(in, "height", 0, 0);
+
+	filter = vsapi->propGetData(in, "filter", 0, &err);
+	if (err)
+		filter = "bilinear";
+
+	filter_param_a = vsapi->propGetFloat(in, "filter_param_a", 0, &err);
+	if (err)
+		filter_param_a = NAN;
+
+	filter_param_b = vsapi->propGetFloat(in, "filter_param_b", 0, &err);
+	if (err)
+		filter_param_b = NAN;
+
+	shift_w = vsapi->propGetFloat(in, "shift_w", 0, &err);
+	if (err)
+		shift_w = 0.0;
+
+	shift_h = vsapi->propGetFloat(in, "shift_h", 0, &err);
+	if (err)
+		shift_h = 0.0;
+
+	if (width <= 0 || height <= 0 || width > node_vi->width || height > node_vi->height) {
+		strcpy(fail_str, "width and height must be positive and not greater than the input");
+		goto fail;
+	}
+	if (width % (1 << node_fmt->subSamplingW) || height % (1 << node_fmt->subSamplingH)) {
+		strcpy(fail_str, "width and height must be divisible by the subsampling");
+		goto fail;
+	}
+
+	data = calloc(1, sizeof(vs_unresize_data));
+	if (!data) {
+		strcpy(fail_str, "error allocaing vs_unresize_data");
+		goto fail;
+	}
+
+	if (vs_unresize_create_pair(translate_filter(filter), filter_param_a, filter_param_b,
+	                            node_vi->width, node_vi->height, width, height, shift_w, shift_h,
+	                            &data->unresize_ctx_y_1, &data->unresize_ctx_y_2, &data->tmp_width_y, &data->tmp_height_y)) {
+		zimg_get_last_error(fail_str, sizeof(fail_str));
+		goto fail;
+	}
+
+	if (node_fmt->subSamplingW || node_fmt->subSamplingH) {
+		if (vs_unresize_create_pair(translate_filter(filter), filter_param_a, filter_param_b,
+		                            node_vi->width >> node_fmt->subSamplingW, node_vi->height >> node_fmt->subSamplingH,
+		                            width >> node_fmt->subSamplingW, height >> node_fmt->subSamplingH,
+		                            shift_w / (double)(1 << node_fmt->subSamplingW), shift_h / (double)(1 << node_fmt->subSamplingH),
+		                            &data->unresize_ctx_uv_1, &data->unresize_ctx_uv_2, &data->tmp_width_uv, &data->tmp_height_uv)) {
+			zimg_get_last_error(fail_str, sizeof(fail_str));
+			goto fail;
+		}
+		data->use_y_as_uv = 0;
+	} else {
+		data->use_y_as_uv = 1;
+	}
+
+	data->node = node;
+	data->vi = *node_vi;
+	data->vi.width = width;
+	data->vi.height = height;
+
+	vsapi->createFilter(in, out, "unresize", vs_unresize_init, vs_unresize_get_frame, vs_unresize_free, fmParallel, 0, data, core);
+	return;
+fail:
+	vsapi->setError(out, fail_str);
+	vsapi->freeNode(node);
+	if (data) {
+		zimg_unresize_delete(data->unresize_ctx_y_1);
+		zimg_unresize_delete(data->unresize_ctx_y_2);
+		zimg_unresize_delete(data->unresize_ctx_uv_1);
+		zimg_unresize_delete(data->unresize_ctx_uv_2);
+	}
+	free(data);
+	return;
+}
+
+typedef enum colorspace_stage {
+	COLORSPACE_STAGE_NONE,
+	COLORSPACE_STAGE_INPUT,
+	COLORSPACE_STAGE_OUTPUT
+} colorspace_stage;
+
+/**
+ * Conversion of depth, size and colorspace in a single node. All planes are processed in FLOAT.
+ * Index 0 of the per-plane arrays describes luma or RGB, and index 1 the chroma planes.
+ *
+ * This saves the intermediate VapourSynth frames of a chain of filters, not memory bandwidth.
+ * Unless the input is already FLOAT and needs no conversion at the input, each frame is first
+ * copied to full-size FLOAT planes in scratch memory, and a resize in both directions writes
+ * a full-size FLOAT intermediate between its passes. Only the last pass is fused with the
+ * output colorspace and depth conversions tile by tile.
+ */
+typedef struct vs_format_data {
+	zimg_depth_context *depth_ctx_in;
+	zimg_depth_context *depth_ctx_out;
+	zimg_colorspace_context *colorspace_ctx;
+	zimg_resize_context *resize_ctx_1[2];
+	zimg_resize_context *resize_ctx_2[2];
+
+	colorspace_stage colorspace_stage;
+	int load_input;
+	int store_planes;
+
+	int src_width[2];
+	int src_height[2];
+	int dst_width[2];
+	int dst_height[2];
+	int tmp_width[2];
+	int tmp_height[2];
+
+	int tv_in;
+	int tv_out;
+
+	size_t tmp_size;
+	size_t scratch_size;
+
+	VSNodeRef *node;
+	VSVideoInfo vi;
+	vs_scratch_pool scratch;
+} vs_format_data;
+
+/* Buffers carved from the scratch memory of a frame. */
+typedef struct vs_format_buffers {
+	float *src[3];
+	float *mid[3];
+	float *dst[3];
+	float *tile[3];
+	void *dst_tile;
+	void *tmp;
+} vs_format_buffers;
+
+static int vs_format_stride(int width)
+{
+	return (int)(((size_t)width * sizeof(float) + 63) & ~(size_t)63);
+}
+
+static void *vs_format_carve(void *base, size_t *offset, size_t size)
+{
+	void *ret = base ? (char *)base + *offset : 0;
+	*offset += (size + 63) & ~(size_t)63;
+	return ret;
+}
+
+/* Assign the buffers of a frame within [base], returning the total size. If [base] is NULL, only the size is computed. */
+static size_t vs_format_layout(const vs_format_data *data, void *base, vs_format_buffers *buf)
+{
+	size_t offset = 0;
+	int p;
+
+	for (p = 0; p < data->vi.format->numPlanes; ++p) {
+		int c = p ? 1 : 0;
+
+		buf->src[p] = 0;
+		buf->mid[p] = 0;
+		buf->dst[p] = 0;
+
+		if (data->load_input)
+			buf->src[p] = vs_format_carve(base, &offset, (size_t)vs_format_stride(data->src_width[c]) * data->src_height[c]);
+		if (data->resize_ctx_2[c])
+			buf->mid[p] = vs_format_carve(base, &offset, (size_t)vs_format_stride(data->tmp_width[c]) * data->tmp_height[c]);
+		if (data->store_planes)
+			buf->dst[p] = vs_format_carve(base, &offset, (size_t)vs_format_stride(data->dst_width[c]) * data->dst_height[c]);
+
+		buf->tile[p] = vs_format_carve(base, &offset, ZIMG_TILE_WIDTH * ZIMG_TILE_HEIGHT * sizeof(float));
+	}
+
+	buf->dst_tile = vs_format_carve(base, &offset, ZIMG_TILE_WIDTH * ZIMG_TILE_HEIGHT * sizeof(float));
+	buf->tmp = vs_format_carve(base, &offset, data->tmp_size);
+
+	return offset;
+}
+
+static int vs_format_create_pair(int filter_type, double filter_param_a, double filter_param_b,
+                                 int src_width, int src_height, int width, int height, double shift_w, double shift_h,
+                                 zimg_resize_context **ctx_1, zimg_resize_context **ctx_2, int *tmp_width, int *tmp_height)
+{
+	zimg_resize_context *ctx_h = 0;
+	zimg_resize_context *ctx_v = 0;
+	int hfirst;
+
+	if ((src_width != width || shift_w != 0.0) &&
+	    !(ctx_h = zimg_resize_create(filter_type, 1, src_width, width, shift_w, src_width, filter_param_a, filter_param_b)))
+		return 1;
+	if ((src_height != height || shift_h != 0.0) &&
+	    !(ctx_v = zimg_resize_create(filter_type, 0, src_height, height, shift_h, src_height, filter_param_a, filter_param_b))) {
+		zimg_resize_delete(ctx_h);
+		return 1;
+	}
+
+	hfirst = zimg_resize_horizontal_first((double)src_width / width, (double)src_height / height);
+
+	if (ctx_h && ctx_v) {
+		*ctx_1 = hfirst ? ctx_h : ctx_v;
+		*ctx_2 = hfirst ? ctx_v : ctx_h;
+		*tmp_width = hfirst ? width : src_width;
+		*tmp_height = hfirst ? src_height : height;
+	} else {
+		*ctx_1 = ctx_h ? ctx_h : ctx_v;
+		*ctx_2 = 0;
+		*tmp_width = 0;
+		*tmp_height = 0;
+	}
+
+	return 0;
+}
+
+/* Convert the input planes to FLOAT, applying the colorspace conversion by strips if it is done at the input size. */
+static void vs_format_load(const vs_format_data *data, const vs_format_buffers *buf, const VSFrameRef *frame, const VSAPI *vsapi,
+                           const float *src_p[3], int src_stride[3])
+{
+	const VSFormat *format = vsapi->getFrameFormat(frame);
+	int pixel_type = translate_pixel(format);
+	int yuv = format->colorFamily == cmYUV || format->colorFamily == cmYCoCg;
+	int p, i;
+
+	for (p = 0; p < format->numPlanes; ++p) {
+		if (data->load_input) {
+			src_p[p] = buf->src[p];
+			src_stride[p] = vs_format_stride(data->src_width[p ? 1 : 0]);
+		} else {
+			src_p[p] = (const float *)vsapi->getReadPtr(frame, p);
+			src_stride[p] = vsapi->getStride(frame, p);
+		}
+	}
+
+	if (!data->load_input)
+		return;
+
+	if (data->colorspace_stage != COLORSPACE_STAGE_INPUT) {
+		for (p = 0; p < format->numPlanes; ++p) {
+			int c = p ? 1 : 0;
+
+			_zimg_depth_plane_process(data->depth_ctx_in, vsapi->getReadPtr(frame, p), buf->src[p], buf->tmp,
+			                          data->src_width[c], data->src_height[c], vsapi->getStride(frame, p), src_stride[p],
+			                          pixel_type, ZIMG_PIXEL_FLOAT, format->bitsPerSample, 32, data->tv_in, 1, p > 0 && yuv);
+		}
+		return;
+	}
+
+	/* Each strip is converted while it is still in cache. */
+	for (i = 0; i < data->src_height[0]; i += ZIMG_TILE_HEIGHT) {
+		int height = VSMIN(data->src_height[0] - i, ZIMG_TILE_HEIGHT);
+		const void *strip_in[3];
+		void *strip[3];
+
+		for (p = 0; p < 3; ++p) {
+			strip[p] = (char *)buf->src[p] + (size_t)i * src_stride[p];
+			strip_in[p] = strip[p];
+
+			_zimg_depth_plane_process(data->depth_ctx_in, vsapi->getReadPtr(frame, p) + (size_t)i * vsapi->getStride(frame, p), strip[p], buf->tmp,
+			                          data->src_width[0], height, vsapi->getStride(frame, p), src_stride[p],
+			                          pixel_type, ZIMG_PIXEL_FLOAT, format->bitsPerSample, 32, data->tv_in, 1, p > 0 && yuv);
+		}
+
+		_zimg_colorspace_plane_process(data->colorspace_ctx, strip_in, strip, buf->tmp, data->src_width[0], height, src_stride, src_stride, ZIMG_PIXEL_FLOAT);
+	}
+}
+
+/* Produce the FLOAT tile at [i], [j] of an output plane, resizing [src] if [ctx] is not NULL. */
+static int vs_format_tile(zimg_resize_context *ctx, const float *src, int src_width, int src_height, int src_stride,
+                          float *tile, int dst_width, int dst_height, int i, int j, void *tmp)
+{
+	zimg_image_tile_t src_tile = { 0 };
+	zimg_image_tile_t dst_tile = { 0 };
+	int top, left, bottom, right;
+
+	if (!ctx) {
+		vs_bitblt(tile, ZIMG_TILE_WIDTH * sizeof(float), (const char *)src + (size_t)i * src_stride + j * sizeof(float), src_stride,
+		          VSMIN(dst_width - j, ZIMG_TILE_WIDTH) * sizeof(float), VSMIN(dst_height - i, ZIMG_TILE_HEIGHT));
+		return 0;
+	}
+
+	zimg_resize_dependent_rect(ctx, i, j, i + ZIMG_TILE_HEIGHT, j + ZIMG_TILE_WIDTH, &top, &left, &bottom, &right);
+
+	src_tile.pixel_type = ZIMG_PIXEL_FLOAT;
+	src_tile.plane_offset_i = top;
+	src_tile.plane_offset_j = left;
+
+	if (bottom > src_height || right + ZIMG_TILE_WIDTH > src_width) {
+		src_tile.buffer = tmp;
+		src_tile.stride = vs_format_stride(right - left + ZIMG_TILE_WIDTH);
+
+		memset(tmp, 0, (size_t)src_tile.stride * (bottom - top));
+		vs_bitblt(tmp, src_tile.stride, (const char *)src + (size_t)top * src_stride + left * sizeof(float), src_stride,
+		          VSMIN(right - left, src_width - left) * sizeof(float), VSMIN(bottom - top, src_height - top));
+	} else {
+		src_tile.buffer = (char *)src + (size_t)top * src_stride + left * sizeof(float);
+		src_tile.stride = src_stride;
+	}
+
+	dst_tile.buffer = tile;
+	dst_tile.stride = ZIMG_TILE_WIDTH * sizeof(float);
+	dst_tile.pixel_type = ZIMG_PIXEL_FLOAT;
+	dst_tile.plane_offset_i = i;
+	dst_tile.plane_offset_j = j;
+
+	return zimg_resize_process_tile(ctx, &src_tile, &dst_tile);
+}
+
+/* Convert the FLOAT tile at [i], [j] of plane [p] to the output format. */
+static int vs_format_store(const vs_format_data *data, const vs_format_buffers *buf, VSFrameRef *frame, const VSAPI *vsapi, int p, int i, int j, unsigned seed)
+{
+	const VSFormat *format = data->vi.format;
+	int c = p ? 1 : 0;
+	int pixel_size = format->bytesPerSample;
+	int tile_width = VSMIN(data->dst_width[c] - j, ZIMG_TILE_WIDTH);
+	int tile_height = VSMIN(data->dst_height[c] - i, ZIMG_TILE_HEIGHT);
+	int stride = vsapi->getStride(frame, p);
+	uint8_t *dst_p = vsapi->getWritePtr(frame, p) + (size_t)i * stride + j * pixel_size;
+
+	zimg_image_tile_t src_tile = { 0 };
+	zimg_image_tile_t dst_tile = { 0 };
+	int partial = tile_width < ZIMG_TILE_WIDTH || tile_height < ZIMG_TILE_HEIGHT;
+	int err;
+
+	if (data->store_planes) {
+		int dst_stride = vs_format_stride(data->dst_width[c]);
+
+		vs_bitblt((char *)buf->dst[p] + (size_t)i * dst_stride + j * sizeof(float), dst_stride, buf->tile[p], ZIMG_TILE_WIDTH * sizeof(float),
+		          tile_width * sizeof(float), tile_height);
+		return 0;
+	}
+
+	src_tile.buffer = buf->tile[p];
+	src_tile.stride = ZIMG_TILE_WIDTH * sizeof(float);
+	src_tile.pixel_type = ZIMG_PIXEL_FLOAT;
+	src_tile.chroma = p > 0 && (format->colorFamily == cmYUV || format->colorFamily == cmYCoCg);
+
+	dst_tile.buffer = partial ? buf->dst_tile : dst_p;
+	dst_tile.stride = partial ? ZIMG_TILE_WIDTH * pixel_size : stride;
+	dst_tile.pixel_type = translate_pixel(format);
+	dst_tile.plane_offset_i = i;
+	dst_tile.plane_offset_j = j;
+	dst_tile.depth = format->bitsPerSample;
+	dst_tile.range = data->tv_out;
+	dst_tile.chroma = src_tile.chroma;
+
+	if ((err = zimg_depth_process_seeded(data->depth_ctx_out, &src_tile, &dst_tile, buf->tmp, seed)))
+		return err;
+
+	if (partial)
+		vs_bitblt(dst_p, stride, buf->dst_tile, ZIMG_TILE_WIDTH * pixel_size, tile_width * pixel_size, tile_height);
+
+	return 0;
+}
+
+static void VS_CC vs_format_init(VSMap *in, VSMap *out, void **instanceData, VSNode *node, VSCore *core, const VSAPI *vsapi)
+{
+	const vs_format_data *data = *instanceData;
+	vsapi->setVideoInfo(&data->vi, 1, node);
+}
+
+static const VSFrameRef * VS_CC vs_format_get_frame(int n, int activationReason, void **instanceData, void **frameData, VSFrameContext *frameCtx, VSCore *core, const VSAPI *vsapi)
+{
+	vs_format_data *data = *instanceData;
+	VSFrameRef *ret = 0;
+	char fail_str[1024] = { 0 };
+	int err = 0;
+	int p;
+
+	zimg_clear_last_error();
+
+	if (activationReason == arInitial) {
+		vsapi->requestFrameFilter(n, data->node, frameCtx);
+	} else if (activationReason == arAllFramesReady) {
+		const VSFrameRef *src_frame = vsapi->getFrameFilter(n, data->node, frameCtx);
+		VSFrameRef *dst_frame = vsapi->newVideoFrame(data->vi.format, data->vi.width, data->vi.height, src_frame, core);
+		const VSFormat *format = data->vi.format;
+
+		vs_format_buffers buf;
+		const float *src_p[3];
+		int src_stride[3];
+
+		/* Source and resizing context of the pass producing the output tiles. */
+		const float *last_p[3];
+		int last_stride[3];
+		int last_width[3];
+		int last_height[3];
+		zimg_resize_context *last_ctx[3];
+
+		int i, j;
+
+		void *tmp = 0;
+		int tmp_slot = -1;
+
+		tmp = vs_scratch_acquire(&data->scratch, data->scratch_size, &tmp_slot);
+		if (!tmp) {
+			strcpy(fail_str, "error allocating temporary buffer");
+			err = 1;
+			goto fail;
+		}
+
+		vs_format_layout(data, tmp, &buf);
+		vs_format_load(data, &buf, src_frame, vsapi, src_p, src_stride);
+
+		for (p = 0; p < format->numPlanes; ++p) {
+			int c = p ? 1 : 0;
+
+			if (data->resize_ctx_2[c]) {
+				int mid_stride = vs_format_stride(data->tmp_width[c]);
+
+				_zimg_resize_plane_process(data->resize_ctx_1[c], src_p[p], buf.mid[p], buf.tmp,
+				                           data->src_width[c], data->src_height[c], data->tmp_width[c], data->tmp_height[c],
+				                           src_stride[p], mid_stride, ZIMG_PIXEL_FLOAT);
+
+				last_p[p] = buf.mid[p];
+				last_stride[p] = mid_stride;
+				last_width[p] = data->tmp_width[c];
+				last_height[p] = data->tmp_height[c];
+				last_ctx[p] = data->resize_ctx_2[c];
+			} else {
+				last_p[p] = src_p[p];
+				last_stride[p] = src_stride[p];
+				last_width[p] = data->src_width[c];
+				last_height[p] = data->src_height[c];
+				last_ctx[p] = data->resize_ctx_1[c];
+			}
+		}
+
+		if (data->colorspace_stage == COLORSPACE_STAGE_OUTPUT) {
+			/* The output is 4:4:4, so the tiles of all planes are converted together. */
+			for (i = 0; i < data->dst_height[0]; i += ZIMG_TILE_HEIGHT) {
+				for (j = 0; j < data->dst_width[0]; j += ZIMG_TILE_WIDTH) {
+					zimg_image_tile_t tiles[3] = { { 0 } };
+
+					for (p = 0; p < 3; ++p) {
+						if ((err = vs_format_tile(last_ctx[p], last_p[p], last_width[p], last_height[p], last_stride[p],
+						                          buf.tile[p], data->dst_width[0], data->dst_height[0], i, j, buf.tmp)))
+							goto fail_zimg;
+
+						tiles[p].buffer = buf.tile[p];
+						tiles[p].stride = ZIMG_TILE_WIDTH * sizeof(float);
+						tiles[p].pixel_type = ZIMG_PIXEL_FLOAT;
+					}
+
+					if ((err = zimg_colorspace_process_tile(data->colorspace_ctx, tiles, tiles, buf.tmp, ZIMG_PIXEL_FLOAT)))
+						goto fail_zimg;
+
+					for (p = 0; p < 3; ++p) {
+						if ((err = vs_format_store(data, &buf, dst_frame, vsapi, p, i, j, ((unsigned)n << 2) | p)))
+							goto fail_zimg;
+					}
+				}
+			}
+		} else {
+			for (p = 0; p < format->numPlanes; ++p) {
+				int c = p ? 1 : 0;
+
+				for (i = 0; i < data->dst_height[c]; i += ZIMG_TILE_HEIGHT) {
+					for (j = 0; j < data->dst_width[c]; j += ZIMG_TILE_WIDTH) {
+						if ((err = vs_format_tile(last_ctx[p], last_p[p], last_width[p], last_height[p], last_stride[p],
+						                          buf.tile[p], data->dst_width[c], data->dst_height[c], i, j, buf.tmp)))
+							goto fail_zimg;
+						if ((err = vs_format_store(data, &buf, dst_frame, vsapi, p, i, j, ((unsigned)n << 2) | p)))
+							goto fail_zimg;
+					}
+				}
+			}
+		}
+
+		/* Dithers that are not applied by tiles run on the complete FLOAT planes. */
+		if (data->store_planes) {
+			int yuv = format->colorFamily == cmYUV || format->colorFamily == cmYCoCg;
+
+			for (p = 0; p < format->numPlanes; ++p) {
+				int c = p ? 1 : 0;
+
+				_zimg_depth_plane_process_seeded(data->depth_ctx_out, buf.dst[p], vsapi->getWritePtr(dst_frame, p), buf.tmp,
+				                                 data->dst_width[c], data->dst_height[c], vs_format_stride(data->dst_width[c]), vsapi->getStride(dst_frame, p),
+				                                 ZIMG_PIXEL_FLOAT, translate_pixel(format), 32, format->bitsPerSample, data->tv_out, data->tv_out,
+				                                 p > 0 && yuv, ((unsigned)n << 2) | p);
+			}
+		}
+
+		ret = dst_frame;
+		dst_frame = 0;
+	fail_zimg:
+		if (err)
+			zimg_get_last_error(fail_str, sizeof(fail_str));
+	fail:
+		vsapi->freeFrame(src_frame);
+		vsapi->freeFrame(dst_frame);
+		if (tmp)
+			vs_scratch_release(&data->scratch, tmp, tmp_slot);
+	}
+
+	if (err)
+		vsapi->setFilterError(fail_str, frameCtx);
+	return ret;
+}
+
+static void VS_CC vs_format_free(void *instanceData, VSCore *core, const VSAPI *vsapi)
+{
+	vs_format_data *data = instanceData;
+	vsapi->freeNode(data->node);
+	zimg_depth_delete(data->depth_ctx_in);
+	zimg_depth_delete(data->depth_ctx_out);
+	zimg_colorspace_delete(data->colorspace_ctx);
+	zimg_resize_delete(data->resize_ctx_1[0]);
+	zimg_resize_delete(data->resize_ctx_2[0]);
+	zimg_resize_delete(data->resize_ctx_1[1]);
+	zimg_resize_delete(data->resize_ctx_2[1]);
+	vs_scratch_free(&data->scratch);
+	free(data);
+}
+
+static void VS_CC vs_format_create(const VSMap *in, VSMap *out, void *userData, VSCore *core, const VSAPI *vsapi)
+{
+	vs_format_data *data = 0;
+	vs_format_buffers buf;
+	char fail_str[1024] = { 0 };
+	int err;
+
+	VSNodeRef *node = 0;
+	const VSVideoInfo *node_vi;
+	const VSFormat *node_fmt;
+	VSVideoInfo out_vi;
+	const VSFormat *out_fmt;
+
+	int width;
+	int height;
+	int format_id;
+
+	int colorspace;
+	int matrix_in;
+	int transfer_in;
+	int primaries_in;
+	int matrix_out;
+	int transfer_out;
+	int primaries_out;
+
+	const char *filter;
+	double filter_param_a;
+	double filter_param_b;
+	const char *dither;
+	const char *chroma_loc_in;
+	const char *chroma_loc_out;
+
+	int pixel_in;
+	int pixel_out;
+	int in_444;
+	int out_444;
+	int c;
+
+	zimg_clear_last_error();
+
+	node = vsapi->propGetNode(in, "clip", 0, 0);
+	node_vi = vsapi->getVideoInfo(node);
+	node_fmt = node_vi->format;
+
+	if (!isConstantFormat(node_vi)) {
+		strcpy(fail_str, "clip must have constant format");
+		goto fail;
+	}
+
+	width = (int)vsapi->propGetInt(in, "width", 0, &err);
+	if (err)
+		width = node_vi->width;
+
+	height = (int)vsapi->propGetInt(in, "height", 0, &err);
+	if (err)
+		height = node_vi->height;
+
+	matrix_in = (int)vsapi->propGetInt(in, "matrix_in", 0, &err);
+	colorspace = !err;
+
+	transfer_in = (int)vsapi->propGetInt(in, "transfer_in", 0, &err);
+	if (err)
+		transfer_in = ZIMG_TRANSFER_709;
+
+	primaries_in = (int)vsapi->propGetInt(in, "primaries_in", 0, &err);
+	if (err)
+		primaries_in = ZIMG_PRIMARIES_709;
+
+	matrix_out = (int)vsapi->propGetInt(in, "matrix_out", 0, &err);
+	if (err)
+		matrix_out = matrix_in;
+
+	transfer_out = (int)vsapi->propGetInt(in, "transfer_out", 0, &err);
+	if (err)
+		transfer_out = transfer_in;
+
+	primaries_out = (int)vsapi->propGetInt(in, "primaries_out", 0, &err);
+	if (err)
+		primaries_out = primaries_in;
+
+	filter = vsapi->propGetData(in, "filter", 0, &err);
+	if (err)
+		filter = "bicubic";
+
+	filter_param_a = vsapi->propGetFloat(in, "filter_param_a", 0, &err);
+	if (err)
+		filter_param_a = NAN;
+
+	filter_param_b = vsapi->propGetFloat(in, "filter_param_b", 0, &err);
+	if (err)
+		filter_param_b = NAN;
+
+	dither = vsapi->propGetData(in, "dither", 0, &err);
+	if (err)
+		dither = "none";
+
+	chroma_loc_in = vsapi->propGetData(in, "chroma_loc_in", 0, &err);
+	if (err)
+		chroma_loc_in = "mpeg2";
+
+	chroma_loc_out = vsapi->propGetData(in, "chroma_loc_out", 0, &err);
+	if (err)
+		chroma_loc_out = "mpeg2";
+
+	format_id = (int)vsapi->propGetInt(in, "format", 0, &err);
+	if (!err) {
+		out_fmt = vsapi->getFormatPreset(format_id, core);
+	} else {
+		int family = node_fmt->colorFamily;
+
+		if (colorspace && matrix_out == ZIMG_MATRIX_RGB)
+			family = cmRGB;
+		else if (colorspace && matrix_in == ZIMG_MATRIX_RGB)
+			family = cmYUV;
+
+		out_fmt = vsapi->registerFormat(family, node_fmt->sampleType, node_fmt->bitsPerSample,
+		                                family == cmRGB ? 0 : node_fmt->subSamplingW, family == cmRGB ? 0 : node_fmt->subSamplingH, core);
+	}
+
+	if (!out_fmt) {
+		strcpy(fail_str, "invalid format");
+		goto fail;
+	}
+
+	pixel_in = translate_pixel(node_fmt);
+	pixel_out = translate_pixel(out_fmt);
+
+	if (pixel_in < 0 || pixel_out < 0) {
+		strcpy(fail_str, "VSFormat not supported");
+		goto fail;
+	}
+	if (node_fmt->numPlanes != out_fmt->numPlanes) {
+		strcpy(fail_str, "cannot convert between gray and color");
+		goto fail;
+	}
+	if (colorspace && ((node_fmt->colorFamily == cmRGB) != (matrix_in == ZIMG_MATRIX_RGB) || (out_fmt->colorFamily == cmRGB) != (matrix_out == ZIMG_MATRIX_RGB))) {
+		strcpy(fail_str, "matrix_in and matrix_out must agree with the color family");
+		goto fail;
+	}
+	if (!colorspace && (node_fmt->colorFamily == cmRGB) != (out_fmt->colorFamily == cmRGB)) {
+		strcpy(fail_str, "matrix_in is required to convert between RGB and YUV");
+		goto fail;
+	}
+	if (width <= 0 || height <= 0) {
+		strcpy(fail_str, "width and height must be positive");
+		goto fail;
+	}
+	if (width % (1 << out_fmt->subSamplingW) || height % (1 << out_fmt->subSamplingH)) {
+		strcpy(fail_str, "width and height must be divisible by the subsampling");
+		goto fail;
+	}
+
+	data = calloc(1, sizeof(vs_format_data));
+	if (!data) {
+		strcpy(fail_str, "error allocating vs_format_data");
+		goto fail;
+	}
+
+	in_444 = !node_fmt->subSamplingW && !node_fmt->subSamplingH;
+	out_444 = !out_fmt->subSamplingW && !out_fmt->subSamplingH;
+
+	/* Convert the colorspace at the smaller size where both are possible. */
+	if (!colorspace || (matrix_in == matrix_out && transfer_in == transfer_out && primaries_in == primaries_out))
+		data->colorspace_stage = COLORSPACE_STAGE_NONE;
+	else if (in_444 && (!out_444 || (double)node_vi->width * node_vi->height <= (double)width * height))
+		data->colorspace_stage = COLORSPACE_STAGE_INPUT;
+	else if (out_444)
+		data->colorspace_stage = COLORSPACE_STAGE_OUTPUT;
+	else {
+		strcpy(fail_str, "colorspace conversion requires a 4:4:4 input or output");
+		goto fail;
+	}
+
+	if (data->colorspace_stage != COLORSPACE_STAGE_NONE) {
+		if (node_fmt->numPlanes < 3) {
+			strcpy(fail_str, "colorspace conversion can not be performed on gray clips");
+			goto fail;
+		}
+
+		data->colorspace_ctx = zimg_colorspace_create(matrix_in, transfer_in, primaries_in, matrix_out, transfer_out, primaries_out);
+		if (!data->colorspace_ctx) {
+			zimg_get_last_error(fail_str, sizeof(fail_str));
+			goto fail;
+		}
+	}
+
+	data->src_width[0] = node_vi->width;
+	data->src_height[0] = node_vi->height;
+	data->src_width[1] = node_vi->width >> node_fmt->subSamplingW;
+	data->src_height[1] = node_vi->height >> node_fmt->subSamplingH;
+
+	data->dst_width[0] = width;
+	data->dst_height[0] = height;
+	data->dst_width[1] = width >> out_fmt->subSamplingW;
+	data->dst_height[1] = height >> out_fmt->subSamplingH;
+
+	if (vs_format_create_pair(translate_filter(filter), filter_param_a, filter_param_b,
+	                          data->src_width[0], data->src_height[0], data->dst_width[0], data->dst_height[0], 0.0, 0.0,
+	                          &data->resize_ctx_1[0], &data->resize_ctx_2[0], &data->tmp_width[0], &data->tmp_height[0])) {
+		zimg_get_last_error(fail_str, sizeof(fail_str));
+		goto fail;
+	}
+	if (out_fmt->numPlanes > 1 &&
+	    vs_format_create_pair(translate_filter(filter), filter_param_a, filter_param_b,
+	                          data->src_width[1], data->src_height[1], data->dst_width[1], data->dst_height[1],
+	                          chroma_adjust_h(chroma_loc_in, chroma_loc_out, node_fmt->subSamplingW, out_fmt->subSamplingW),
+	                          chroma_adjust_v(chroma_loc_in, chroma_loc_out, node_fmt->subSamplingH, out_fmt->subSamplingH),
+	                          &data->resize_ctx_1[1], &data->resize_ctx_2[1], &data->tmp_width[1], &data->tmp_height[1])) {
+		zimg_get_last_error(fail_str, sizeof(fail_str));
+		goto fail;
+	}
+
+	data->depth_ctx_in = zimg_depth_create(ZIMG_DITHER_NONE);
+	data->depth_ctx_out = zimg_depth_create(translate_dither(dither));
+	if (!data->depth_ctx_in || !data->depth_ctx_out) {
+		zimg_get_last_error(fail_str, sizeof(fail_str));
+		goto fail;
+	}
+
+	data->load_input = pixel_in != ZIMG_PIXEL_FLOAT || data->colorspace_stage == COLORSPACE_STAGE_INPUT;
+	data->store_planes = !zimg_depth_tile_supported(data->depth_ctx_out, ZIMG_PIXEL_FLOAT, pixel_out);
+
+	data->tv_in = !!vsapi->propGetInt(in, "fullrange_in", 0, &err);
+	if (err)
+		data->tv_in = node_fmt->colorFamily == cmRGB;
+
+	data->tv_out = !!vsapi->propGetInt(in, "fullrange_out", 0, &err);
+	if (err)
+		data->tv_out = out_fmt->colorFamily == cmRGB;
+
+	data->tmp_size = VSMAX(_zimg_depth_plane_tmp_size(data->depth_ctx_in, data->src_width[0], pixel_in, ZIMG_PIXEL_FLOAT),
+	                       _zimg_depth_plane_tmp_size(data->depth_ctx_out, data->dst_width[0], ZIMG_PIXEL_FLOAT, pixel_out));
+
+	if (data->colorspace_ctx)
+		data->tmp_size = VSMAX(data->tmp_size, _zimg_colorspace_plane_tmp_size(data->colorspace_ctx, ZIMG_PIXEL_FLOAT));
+
+	for (c = 0; c < (out_fmt->numPlanes > 1 ? 2 : 1); ++c) {
+		size_t sz = 0;
+
+		if (data->resize_ctx_2[c]) {
+			sz = VSMAX(_zimg_resize_plane_tmp_size(data->resize_ctx_1[c], data->src_width[c], data->src_height[c], data->tmp_width[c], data->tmp_height[c], ZIMG_PIXEL_FLOAT),
+			           _zimg_resize_plane_tmp_size(data->resize_ctx_2[c], data->tmp_width[c], data->tmp_height[c], data->dst_width[c], data->dst_height[c], ZIMG_PIXEL_FLOAT));
+		} else if (data->resize_ctx_1[c]) {
+			sz = _zimg_resize_plane_tmp_size(data->resize_ctx_1[c], data->src_width[c], data->src_height[c], data->dst_width[c], data->dst_height[c], ZIMG_PIXEL_FLOAT);
+		}
+
+		data->tmp_size = VSMAX(data->tmp_size, sz);
+	}
+
+	out_vi.format = out_fmt;
+	out_vi.fpsNum = node_vi->fpsNum;
+	out_vi.fpsDen = node_vi->fpsDen;
+	out_vi.width = width;
+	out_vi.height = height;
+	out_vi.numFrames = node_vi->numFrames;
+	out_vi.flags = 0;
+
+	data->node = node;
+	data->vi = out_vi;
+	data->scratch_size = vs_format_layout(data, 0, &buf);
+
+	vsapi->createFilter(in, out, "format", vs_format_init, vs_format_get_frame, vs_format_free, fmParallel, 0, data, core);
+	return;
+fail:
+	vsapi->setError(out, fail_str);
+	vsapi->freeNode(node);
+	if (data) {
+		zimg_depth_delete(data->depth_ctx_in);
+		zimg_depth_delete(data->depth_ctx_out);
+		zimg_colorspace_delete(data->colorspace_ctx);
+		zimg_resize_delete(data->resize_ctx_1[0]);
+		zimg_resize_delete(data->resize_ctx_2[0]);
+		zimg_resize_delete(data->resize_ctx_1[1]);
+		zimg_resize_delete(data->resize_ctx_2[1]);
+	}
+	free(data);
+	return;
+}
+
+static void VS_CC vs_set_cpu(const VSMap *in, VSMap *out, void *userData, VSCore *core, const VSAPI *vsapi)
+{
+	const char *cpu = vsapi->propGetData(in, "cpu", 0, 0);
+
+	if (!strcmp(cpu, "none"))
+		zimg_set_cpu(ZIMG_CPU_NONE);
+	else if (!strcmp(cpu, "auto"))
+		zimg_set_cpu(ZIMG_CPU_AUTO);
+#if defined(__i386) || defined(_M_IX86) || defined(_M_X64) || defined(__x86_64__)
+	else if (!strcmp(cpu, "mmx"))
+		zimg_set_cpu(ZIMG_CPU_X86_MMX);
+	else if (!strcmp(cpu, "sse"))
+		zimg_set_cpu(ZIMG_CPU_X86_SSE);
+	else if (!strcmp(cpu, "sse2"))
+		zimg_set_cpu(ZIMG_CPU_X86_SSE2);
+	else if (!strcmp(cpu, "sse3"))
+		zimg_set_cpu(ZIMG_CPU_X86_SSE3);
+	else if (!strcmp(cpu, "ssse3"))
+		zimg_set_cpu(ZIMG_CPU_X86_SSSE3);
+	else if (!strcmp(cpu, "sse41"))
+		zimg_set_cpu(ZIMG_CPU_X86_SSE41);
+	else if (!strcmp(cpu, "sse42"))
+		zimg_set_cpu(ZIMG_CPU_X86_SSE42);
+	else if (!strcmp(cpu, "avx"))
+		zimg_set_cpu(ZIMG_CPU_X86_AVX);
+	else if (!strcmp(cpu, "f16c"))
+		zimg_set_cpu(ZIMG_CPU_X86_F16C);
+	else if (!strcmp(cpu, "avx2"))
+		zimg_set_cpu(ZIMG_CPU_X86_AVX2);
+#endif
+	else
+		zimg_set_cpu(ZIMG_CPU_NONE);
+}
+
+VS_EXTERNAL_API(void) VapourSynthPluginInit(VSConfigPlugin configFunc, VSRegisterFunction registerFunc, VSPlugin *plugin)
+{
+	configFunc("the.weather.channel", "z", "batman", VAPOURSYNTH_API_VERSION, 1, plugin);
+
+	registerFunc("Colorspace", "clip:clip;"
+	                           "matrix_in:int;"
+	                           "transfer_in:int;"
+	                           "primaries_in:int;"
+	                           "matrix_out:int:opt;"
+	                           "transfer_out:int:opt;"
+	                           "primaries_out:int:opt", vs_colorspace_create, 0, plugin);
+	registerFunc("Depth", "clip:clip;"
+	                      "dither:data:opt;"
+	                      "sample:int:opt;"
+	                      "depth:int:opt;"
+	                      "fullrange_in:int:opt;"
+	                      "fullrange_out:int:opt", vs_depth_create, 0, plugin);
+	registerFunc("Resize", "clip:clip;"
+	                       "width:int;"
+	                       "height:int;"
+	                       "filter:data:opt;"
+	                       "filter_param_a:float:opt;"
+	                       "filter_param_b:float:opt;"
+	                       "shift_w:float:opt;"
+	                       "shift_h:float:opt;"
+	                       "subwidth:float:opt;"
+	                       "subheight:float:opt;"
+	                       "filter_uv:data:opt;"
+	                       "filter_param_a_uv:float:opt;"
+	                       "filter_param_b_uv:float:opt;"
+	                       "subsample_w:int:opt;"
+	                       "subsample_h:int:opt;"
+	                       "chroma_loc_in:data:opt;"
+	                       "chroma_loc_out:data:opt;", vs_resize_create, 0, plugin);
+
+	registerFunc("Unresize", "clip:clip;"
+	                         "width:int;"
+	                         "height:int;"
+	                         "filter:data:opt;"
+	                         "filter_param_a:float:opt;"
+	                         "filter_param_b:float:opt;"
+	                         "shift_w:float:opt;"
+	                         "shift_h:float:opt", vs_unresize_create, 0, plugin);
+
+	registerFunc("Format", "clip:clip;"
+	                       "width:int:opt;"
+	                       "height:int:opt;"
+	                       "format:int:opt;"
+	                       "matrix_in:int:opt;"
+	                       "transfer_in:int:opt;"
+	                       "primaries_in:int:opt;"
+	                       "matrix_out:int:opt;"
+	                       "transfer_out:int:opt;"
+	                       "primaries_out:int:opt;"
+	                       "filter:data:opt;"
+	                       "filter_param_a:float:opt;"
+	                       "filter_param_b:float:opt;"
+	                       "dither:data:opt;"
+	                       "fullrange_in:int:opt;"
+	                       "fullrange_out:int:opt;"
+	                       "chroma_loc_in:data:opt;"
+	                       "chroma_loc_out:data:opt", vs_format_create, 0, plugin);
 
 	registerFunc("SetCPU", "cpu:data", vs_set_cpu, 0, plugin);
 